@@ -0,0 +1,69 @@
+#include <stdio.h>
+#include <string.h>
+#include <sys/ioctl.h>
+#include <linux/i2c-dev.h>
+#include "button_matrix.h"
+
+// Writes 'len' bytes starting at register 'reg' (the PCA9555 auto-increments within a pair)
+static int write_regs(int fd, uint8_t addr, uint8_t reg, const uint8_t *vals, int len) {
+    uint8_t buf[3];
+    buf[0] = reg;
+    memcpy(buf + 1, vals, len);
+
+    struct i2c_msg msg = { .addr = addr, .flags = 0, .len = len + 1, .buf = buf };
+    struct i2c_rdwr_ioctl_data xfer = { &msg, 1 };
+    return ioctl(fd, I2C_RDWR, &xfer) == 1 ? 0 : -1;
+}
+
+int button_matrix_open(button_matrix_t *bm, int fd, const uint8_t *addrs, int count) {
+    memset(bm, 0, sizeof(*bm));
+    if (count < 1 || count > BUTTON_MATRIX_MAX) return -1;
+    bm->fd = fd;
+    bm->count = count;
+    bm->reg = PCA9555_INPUT_PORT_0;
+
+    for (int k = 0; k < count; k++) {
+        bm->addrs[k] = addrs[k];
+
+        // All 16 pins inputs (the power-on default, but don't rely on it)
+        const uint8_t all_inputs[2] = { 0xFF, 0xFF };
+        if (write_regs(fd, addrs[k], PCA9555_CONFIG_PORT_0, all_inputs, 2) < 0) {
+            fprintf(stderr, "PCA9555 at 0x%02X not responding\n", addrs[k]);
+            return -1;
+        }
+
+        // Pointer write, repeated start into the 2-byte read, same address
+        bm->msgs[2 * k]     = (struct i2c_msg){ .addr = addrs[k], .flags = 0, .len = 1, .buf = &bm->reg };
+        bm->msgs[2 * k + 1] = (struct i2c_msg){ .addr = addrs[k], .flags = I2C_M_RD, .len = 2, .buf = bm->inputs[k] };
+        bm->inputs[k][0] = bm->inputs[k][1] = 0xFF; // Released
+    }
+    return 0;
+}
+
+int button_matrix_read(button_matrix_t *bm, uint64_t *pressed) {
+    bm->reads++;
+    bm->failed = 0;
+
+    // One repeated-start transfer per expander: the Pi 5's controller (RP1, DesignWare)
+    // rejects a target address change inside one I2C_RDWR with EINVAL
+    for (int k = 0; k < bm->count; k++) {
+        struct i2c_rdwr_ioctl_data xfer = { &bm->msgs[2 * k], 2 };
+        if (ioctl(bm->fd, I2C_RDWR, &xfer) != 2) {
+            bm->failed |= 1u << k;
+            bm->read_errors++;
+        }
+    }
+    if (bm->failed == (1u << bm->count) - 1) return -1;
+
+    button_matrix_pressed(bm, pressed);
+    return 0;
+}
+
+void button_matrix_pressed(const button_matrix_t *bm, uint64_t *pressed) {
+    // Four expanders per word, inverted because the buttons pull the inputs low
+    memset(pressed, 0, BUTTON_MATRIX_WORDS * sizeof(uint64_t));
+    for (int k = 0; k < bm->count; k++) {
+        uint64_t levels = (uint64_t)bm->inputs[k][0] | ((uint64_t)bm->inputs[k][1] << 8);
+        pressed[k / 4] |= (~levels & 0xFFFF) << (16 * (k % 4));
+    }
+}
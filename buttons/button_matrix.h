@@ -0,0 +1,56 @@
+#ifndef BUTTON_MATRIX_H
+#define BUTTON_MATRIX_H
+
+#include <stdint.h>
+#include <linux/i2c.h>
+#include "pca9555.h"
+
+// --- BUTTON MATRIX ---
+// Several PCA9555 expanders on one I2C bus, their INT lines wire-ORed onto one GPIO.
+// Any of them can pull INT low, and reading an expander's inputs releases its part,
+// so every interrupt reads all of them: per expander one I2C_RDWR ioctl holding a
+// pointer write + repeated-start 2-byte read (built once at open). The transfers can't
+// be merged into one ioctl: the Pi 5's I2C controller refuses a target address change
+// inside a transfer. The result is one bitmap of all 16 x N inputs for a single
+// debounce_update(), which finds the changes with XOR.
+//
+// Input numbering: expander k (in the order given to button_matrix_open()) owns
+// inputs 16k..16k+15, Port 0 first. Bit i of word i / 64 = input i pressed.
+
+#define BUTTON_MATRIX_MAX   8   // PCA9555 addresses 0x20-0x27
+#define BUTTON_MATRIX_WORDS ((BUTTON_MATRIX_MAX * 16 + 63) / 64)
+
+typedef struct {
+    int fd;                                 // /dev/i2c-N, no I2C_SLAVE needed
+    int count;
+    uint8_t addrs[BUTTON_MATRIX_MAX];
+    uint8_t inputs[BUTTON_MATRIX_MAX][2];   // Port 0/1 of each expander from the last read
+    uint8_t failed;                         // Bit k: expander k didn't answer the last read
+
+    // Built once: write pointer, read 2 bytes, for every expander (msgs[2k], msgs[2k + 1])
+    uint8_t reg;
+    struct i2c_msg msgs[2 * BUTTON_MATRIX_MAX];
+
+    uint64_t reads;         // button_matrix_read() calls
+    uint64_t read_errors;   // Expander reads that failed
+} button_matrix_t;
+
+// Configures every expander's pins as inputs and builds the read transfers.
+// Returns -1 (with the address printed) if an expander doesn't answer.
+int button_matrix_open(button_matrix_t *bm, int fd, const uint8_t *addrs, int count);
+
+// Reads all expanders, one ioctl each, and fills 'pressed' (BUTTON_MATRIX_WORDS words,
+// active-low inputs reported as 1 = pressed). One missing panel doesn't silence the
+// rest: the ones that fail keep their previous state and are flagged in bm->failed.
+// Returns -1 only if all fail.
+int button_matrix_read(button_matrix_t *bm, uint64_t *pressed);
+
+// Builds the 'pressed' bitmap from bm->inputs (done by button_matrix_read()).
+void button_matrix_pressed(const button_matrix_t *bm, uint64_t *pressed);
+
+// Number of inputs (16 per expander)
+static inline int button_matrix_inputs(const button_matrix_t *bm) {
+    return bm->count * 16;
+}
+
+#endif
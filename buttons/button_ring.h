@@ -0,0 +1,102 @@
+#ifndef BUTTON_RING_H
+#define BUTTON_RING_H
+
+#include <stdint.h>
+#include <stdatomic.h>
+#include <errno.h>
+#include <time.h>
+#include <semaphore.h>
+
+// --- BUTTON EVENT RING ---
+// Single-producer / single-consumer queue between the GPIO alert thread (producer:
+// reads the PCA9555s and pushes what it saw) and a consumer thread that decodes the
+// state changes and runs the actions. No locks: each side owns one index and
+// publishes it with release/acquire ordering. A full ring drops the new record and
+// counts it in 'overflows' instead of ever blocking the alert thread.
+// The semaphore only wakes the consumer; the data itself never goes through a lock.
+
+#define BUTTON_RING_SIZE 256 // Records, power of two
+
+#define BUTTON_RING_WORDS 2 // 128 inputs (8 PCA9555), same layout as DEBOUNCE_WORDS
+
+typedef struct {
+    uint64_t timestamp_ns;  // Time of the interrupt edge
+    uint64_t pressed[BUTTON_RING_WORDS]; // Inputs read, bit i = input i pressed (16 per PCA9555)
+} button_record_t;
+
+typedef struct {
+    button_record_t records[BUTTON_RING_SIZE];
+    _Atomic uint32_t head;      // Next slot to write (producer)
+    _Atomic uint32_t tail;      // Next slot to read (consumer)
+    _Atomic uint64_t overflows; // Records dropped because the ring was full
+    sem_t ready;                // Posted once per pushed record
+} button_ring_t;
+
+#define BUTTON_RING_FOREVER UINT64_MAX // Same value as DEBOUNCE_NONE
+
+static inline void button_ring_init(button_ring_t *ring) {
+    atomic_init(&ring->head, 0);
+    atomic_init(&ring->tail, 0);
+    atomic_init(&ring->overflows, 0);
+    sem_init(&ring->ready, 0, 0);
+}
+
+// Producer side. Returns 0, or -1 if the ring was full (record dropped).
+static inline int button_ring_push(button_ring_t *ring, const button_record_t *rec) {
+    uint32_t head = atomic_load_explicit(&ring->head, memory_order_relaxed);
+    uint32_t tail = atomic_load_explicit(&ring->tail, memory_order_acquire);
+
+    if (head - tail == BUTTON_RING_SIZE) {
+        atomic_fetch_add_explicit(&ring->overflows, 1, memory_order_relaxed);
+        return -1;
+    }
+    ring->records[head % BUTTON_RING_SIZE] = *rec;
+    atomic_store_explicit(&ring->head, head + 1, memory_order_release);
+    return 0;
+}
+
+// Consumer side. Returns 1 with the oldest record in 'rec', or 0 if the ring is empty.
+static inline int button_ring_pop(button_ring_t *ring, button_record_t *rec) {
+    uint32_t tail = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+    uint32_t head = atomic_load_explicit(&ring->head, memory_order_acquire);
+
+    if (tail == head) return 0;
+    *rec = ring->records[tail % BUTTON_RING_SIZE];
+    atomic_store_explicit(&ring->tail, tail + 1, memory_order_release);
+    return 1;
+}
+
+// Producer side: wakes the consumer after a successful push.
+static inline void button_ring_notify(button_ring_t *ring) {
+    sem_post(&ring->ready);
+}
+
+// Consumer side: waits for a notify, or until 'deadline_ns' (CLOCK_MONOTONIC;
+// BUTTON_RING_FOREVER = no timeout). Returns 1 if woken, 0 on timeout.
+static inline int button_ring_wait(button_ring_t *ring, uint64_t deadline_ns) {
+    if (deadline_ns == BUTTON_RING_FOREVER) {
+        while (sem_wait(&ring->ready) < 0 && errno == EINTR);
+        return 1;
+    }
+
+    // sem_timedwait() takes CLOCK_REALTIME: convert the time left
+    struct timespec mono, abs;
+    clock_gettime(CLOCK_MONOTONIC, &mono);
+    uint64_t now = (uint64_t)mono.tv_sec * 1000000000ULL + (uint64_t)mono.tv_nsec;
+    if (deadline_ns <= now) return sem_trywait(&ring->ready) == 0;
+
+    clock_gettime(CLOCK_REALTIME, &abs);
+    uint64_t until = (uint64_t)abs.tv_sec * 1000000000ULL + (uint64_t)abs.tv_nsec + (deadline_ns - now);
+    abs.tv_sec = (time_t)(until / 1000000000ULL);
+    abs.tv_nsec = (long)(until % 1000000000ULL);
+
+    int ret;
+    while ((ret = sem_timedwait(&ring->ready, &abs)) < 0 && errno == EINTR);
+    return ret == 0;
+}
+
+static inline uint64_t button_ring_overflows(button_ring_t *ring) {
+    return atomic_load_explicit(&ring->overflows, memory_order_relaxed);
+}
+
+#endif
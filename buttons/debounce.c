@@ -0,0 +1,151 @@
+#include <string.h>
+#include "debounce.h"
+
+static inline int get_bit(const uint64_t *bits, int i) {
+    return (bits[i / 64] >> (i % 64)) & 1;
+}
+
+static uint64_t pin_deadline(const debouncer_t *db, const debounce_pin_t *p) {
+    if (p->raw != p->stable) {
+        return p->raw_since + (p->raw ? db->cfg.press_stable_ns : db->cfg.release_stable_ns);
+    }
+    if (p->stable && db->cfg.long_press_ns) {
+        if (!p->long_sent) return p->pressed_at + db->cfg.long_press_ns;
+        if (db->cfg.repeat_ns) return p->next_repeat;
+    }
+    return DEBOUNCE_NONE;
+}
+
+// Keeps the pin's 'active' bit in sync with whether it has a deadline
+static void update_active(debouncer_t *db, int i) {
+    uint64_t bit = 1ULL << (i % 64);
+    if (pin_deadline(db, &db->pins[i]) != DEBOUNCE_NONE) {
+        db->active[i / 64] |= bit;
+    } else {
+        db->active[i / 64] &= ~bit;
+    }
+}
+
+void debounce_init(debouncer_t *db, const debounce_cfg_t *cfg, int num_pins,
+                   const uint64_t *pressed, uint64_t now_ns) {
+    memset(db, 0, sizeof(*db));
+    db->cfg = *cfg;
+    db->num_pins = num_pins > DEBOUNCE_MAX_PINS ? DEBOUNCE_MAX_PINS : num_pins;
+
+    for (int i = 0; i < db->num_pins; i++) {
+        debounce_pin_t *p = &db->pins[i];
+        p->raw = p->stable = get_bit(pressed, i);
+        p->raw_since = now_ns;
+        p->pressed_at = now_ns;
+        // Held at startup: no long press for a press we didn't see
+        p->long_sent = p->stable;
+        if (p->raw) db->raw[i / 64] |= 1ULL << (i % 64);
+    }
+}
+
+static int emit(button_event_t *out, int n, int max, int pin, button_event_type_t type, uint64_t ts) {
+    if (n < max) {
+        out[n].pin = pin;
+        out[n].type = type;
+        out[n].timestamp_ns = ts;
+        return n + 1;
+    }
+    return n;
+}
+
+// Handles everything due for pin 'i' up to 'now_ns'
+static int settle_pin(debouncer_t *db, int i, uint64_t now_ns, button_event_t *out, int n, int max) {
+    debounce_pin_t *p = &db->pins[i];
+    uint64_t due;
+
+    // A pin can have several things due at once (e.g. press and long press after a stall)
+    while ((due = pin_deadline(db, p)) <= now_ns) {
+        if (p->raw != p->stable) {
+            p->stable = p->raw;
+            if (p->stable) {
+                p->pressed_at = p->raw_since;
+                p->long_sent = 0;
+                n = emit(out, n, max, i, BUTTON_PRESS, p->raw_since);
+            } else {
+                n = emit(out, n, max, i, BUTTON_RELEASE, p->raw_since);
+            }
+        } else if (!p->long_sent) {
+            p->long_sent = 1;
+            p->next_repeat = due + db->cfg.repeat_ns;
+            n = emit(out, n, max, i, BUTTON_LONG_PRESS, due);
+        } else {
+            p->next_repeat = due + db->cfg.repeat_ns;
+            n = emit(out, n, max, i, BUTTON_REPEAT, due);
+        }
+    }
+    update_active(db, i);
+    return n;
+}
+
+int debounce_tick(debouncer_t *db, uint64_t now_ns, button_event_t *out, int max) {
+    int n = 0;
+
+    for (int w = 0; w < DEBOUNCE_WORDS; w++) {
+        uint64_t bits = db->active[w];
+        while (bits) {
+            int i = w * 64 + __builtin_ctzll(bits);
+            bits &= bits - 1;
+            n = settle_pin(db, i, now_ns, out, n, max);
+        }
+    }
+    return n;
+}
+
+int debounce_update(debouncer_t *db, const uint64_t *pressed, uint64_t ts_ns,
+                    button_event_t *out, int max) {
+    // Settle everything that was due before this sample, with the old levels
+    int n = debounce_tick(db, ts_ns, out, max);
+
+    for (int w = 0; w < DEBOUNCE_WORDS; w++) {
+        int base = w * 64;
+        if (base >= db->num_pins) break;
+        uint64_t valid = (db->num_pins - base >= 64) ? ~0ULL : (1ULL << (db->num_pins - base)) - 1;
+        uint64_t sample = pressed[w] & valid;
+
+        // Only the pins that changed since the last sample
+        uint64_t changed = sample ^ db->raw[w];
+        db->raw[w] = sample;
+        while (changed) {
+            int i = base + __builtin_ctzll(changed);
+            changed &= changed - 1;
+
+            // Restarts the stable timer; back to the debounced level cancels the change
+            debounce_pin_t *p = &db->pins[i];
+            p->raw = get_bit(pressed, i);
+            p->raw_since = ts_ns;
+            // Zero stable time: the change counts right away
+            n = settle_pin(db, i, ts_ns, out, n, max);
+        }
+    }
+    return n;
+}
+
+uint64_t debounce_next_deadline(const debouncer_t *db) {
+    uint64_t next = DEBOUNCE_NONE;
+
+    for (int w = 0; w < DEBOUNCE_WORDS; w++) {
+        uint64_t bits = db->active[w];
+        while (bits) {
+            int i = w * 64 + __builtin_ctzll(bits);
+            bits &= bits - 1;
+            uint64_t due = pin_deadline(db, &db->pins[i]);
+            if (due < next) next = due;
+        }
+    }
+    return next;
+}
+
+const char *button_event_name(button_event_type_t type) {
+    switch (type) {
+        case BUTTON_PRESS: return "press";
+        case BUTTON_RELEASE: return "release";
+        case BUTTON_LONG_PRESS: return "long press";
+        case BUTTON_REPEAT: return "repeat";
+    }
+    return "?";
+}
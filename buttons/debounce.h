@@ -0,0 +1,83 @@
+#ifndef DEBOUNCE_H
+#define DEBOUNCE_H
+
+#include <stdint.h>
+
+// --- PER-BUTTON DEBOUNCE ---
+// One small state machine per button, driven only by timestamps: nothing sleeps
+// and no interrupt is thrown away. A button's raw level has to stay unchanged for
+// the configured stable time before the change counts, and each button keeps its
+// own timer, so bouncing on one key never hides a press on another.
+//
+// Feed every port read to debounce_update(). Pending changes, long presses and
+// repeats are due at debounce_next_deadline(): wait for the next read at most until
+// then, and call debounce_tick() when the wait times out.
+//
+// Samples are bitmaps (bit i of word i / 64 = pin i pressed). Changed pins are found
+// by XOR against the previous sample, and only pins with something pending are
+// visited on a tick, so the cost follows the activity, not the number of buttons.
+
+#define DEBOUNCE_MAX_PINS 128   // 8 PCA9555 x 16 inputs
+#define DEBOUNCE_WORDS ((DEBOUNCE_MAX_PINS + 63) / 64)
+#define DEBOUNCE_NONE UINT64_MAX    // No deadline pending
+
+typedef enum {
+    BUTTON_PRESS,
+    BUTTON_RELEASE,
+    BUTTON_LONG_PRESS,  // Still held long_press_ns after the press
+    BUTTON_REPEAT,      // Every repeat_ns after the long press while held
+} button_event_type_t;
+
+typedef struct {
+    int pin;                    // Bit number in the sample (16 per PCA9555: 0-7 port 0, 8-15 port 1)
+    button_event_type_t type;
+    uint64_t timestamp_ns;      // Press/release: first edge of the new level. Long/repeat: when due.
+} button_event_t;
+
+typedef struct {
+    uint64_t press_stable_ns;   // 0 = act on the first edge (lowest latency)
+    uint64_t release_stable_ns;
+    uint64_t long_press_ns;     // 0 = no long press / repeat events
+    uint64_t repeat_ns;         // 0 = no repeat events
+} debounce_cfg_t;
+
+// Defaults: presses count on the first edge, bounces are absorbed by the release time
+#define DEBOUNCE_DEFAULT_CFG { 0, 20000000ULL, 800000000ULL, 200000000ULL }
+
+typedef struct {
+    uint8_t raw;                // Level seen in the last sample (1 = pressed)
+    uint8_t stable;             // Debounced level
+    uint8_t long_sent;
+    uint64_t raw_since;         // Time 'raw' was first seen
+    uint64_t pressed_at;        // Time of the debounced press
+    uint64_t next_repeat;
+} debounce_pin_t;
+
+typedef struct {
+    debounce_cfg_t cfg;
+    int num_pins;
+    uint64_t raw[DEBOUNCE_WORDS];       // Last sample
+    uint64_t active[DEBOUNCE_WORDS];    // Pins with a deadline pending
+    debounce_pin_t pins[DEBOUNCE_MAX_PINS];
+} debouncer_t;
+
+// 'pressed' is the initial state (DEBOUNCE_WORDS words), taken as already stable.
+void debounce_init(debouncer_t *db, const debounce_cfg_t *cfg, int num_pins,
+                   const uint64_t *pressed, uint64_t now_ns);
+
+// Feeds a sample ('pressed', DEBOUNCE_WORDS words) taken at 'ts_ns'. Writes up to
+// 'max' events to 'out' (in pin order, oldest first per pin) and returns how many.
+// Events due before 'ts_ns' come first.
+int debounce_update(debouncer_t *db, const uint64_t *pressed, uint64_t ts_ns,
+                    button_event_t *out, int max);
+
+// Advances time to 'now_ns' without a new sample. Returns the number of events written.
+int debounce_tick(debouncer_t *db, uint64_t now_ns, button_event_t *out, int max);
+
+// Earliest time something is due, or DEBOUNCE_NONE.
+uint64_t debounce_next_deadline(const debouncer_t *db);
+
+// "press", "release", "long press", "repeat"
+const char *button_event_name(button_event_type_t type);
+
+#endif
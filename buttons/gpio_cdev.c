@@ -0,0 +1,90 @@
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include "gpio_cdev.h"
+
+#define GPIO_CDEV_MAX_CHIPS 16
+
+int gpio_cdev_find_chip(const char *label) {
+    char path[32];
+
+    for (int i = 0; i < GPIO_CDEV_MAX_CHIPS; i++) {
+        snprintf(path, sizeof(path), "/dev/gpiochip%d", i);
+        int fd = open(path, O_RDWR);
+        if (fd < 0) continue;
+
+        struct gpiochip_info info;
+        memset(&info, 0, sizeof(info));
+        int match = ioctl(fd, GPIO_GET_CHIPINFO_IOCTL, &info) == 0 &&
+                    strncmp(info.label, label, sizeof(info.label)) == 0;
+        close(fd);
+        if (match) return i;
+    }
+    return -1;
+}
+
+int gpio_cdev_open_chip(const char *label) {
+    char path[32];
+
+    int chip = gpio_cdev_find_chip(label);
+    if (chip < 0) {
+        fprintf(stderr, "No GPIO chip labelled '%s' found\n", label);
+        return -1;
+    }
+    snprintf(path, sizeof(path), "/dev/gpiochip%d", chip);
+    return open(path, O_RDWR);
+}
+
+int gpio_cdev_request_edges(int chip_fd, const unsigned int *offsets, int num_lines,
+                            uint64_t flags, const char *consumer) {
+    struct gpio_v2_line_request req;
+
+    if (num_lines < 1 || num_lines > GPIO_V2_LINES_MAX) return -1;
+
+    memset(&req, 0, sizeof(req));
+    for (int i = 0; i < num_lines; i++) req.offsets[i] = offsets[i];
+    req.num_lines = num_lines;
+    strncpy(req.consumer, consumer, sizeof(req.consumer) - 1);
+    req.config.flags = flags | GPIO_V2_LINE_FLAG_INPUT;
+    req.event_buffer_size = GPIO_CDEV_EVENT_BUFFER;
+
+    if (ioctl(chip_fd, GPIO_V2_GET_LINE_IOCTL, &req) < 0) {
+        fprintf(stderr, "Failed to request GPIO line %u: %s\n", offsets[0], strerror(errno));
+        return -1;
+    }
+    return req.fd;
+}
+
+int gpio_cdev_read_events(int line_fd, gpio_cdev_event_t *events, int max) {
+    struct gpio_v2_line_event buf[GPIO_CDEV_MAX_READ];
+
+    if (max > GPIO_CDEV_MAX_READ) max = GPIO_CDEV_MAX_READ;
+
+    ssize_t n;
+    do {
+        n = read(line_fd, buf, max * sizeof(buf[0]));
+    } while (n < 0 && errno == EINTR);
+    if (n < 0) return -1;
+
+    // The kernel only returns whole events
+    int count = (int)(n / sizeof(buf[0]));
+    for (int i = 0; i < count; i++) {
+        events[i].timestamp_ns = buf[i].timestamp_ns;
+        events[i].offset = buf[i].offset;
+        events[i].rising = (buf[i].id == GPIO_V2_LINE_EVENT_RISING_EDGE);
+        events[i].seqno = buf[i].seqno;
+    }
+    return count;
+}
+
+int64_t gpio_cdev_get_values(int line_fd, int num_lines) {
+    struct gpio_v2_line_values vals;
+
+    vals.mask = num_lines >= 64 ? ~0ULL : (1ULL << num_lines) - 1;
+    vals.bits = 0;
+    if (ioctl(line_fd, GPIO_V2_LINE_GET_VALUES_IOCTL, &vals) < 0) return -1;
+    return (int64_t)vals.bits;
+}
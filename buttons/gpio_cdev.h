@@ -0,0 +1,50 @@
+#ifndef GPIO_CDEV_H
+#define GPIO_CDEV_H
+
+#include <stdint.h>
+#include <linux/gpio.h>
+
+// --- GPIO CHARACTER DEVICE INPUT ---
+// Edge events through the GPIO v2 uAPI (/dev/gpiochipN), replacing /sys/class/gpio:
+// no export step, no sleep while nodes appear, and every event carries the kernel
+// timestamp of the edge. The kernel queues edges per request, and one read()
+// returns all of them at once, so bursts are not lost between reads.
+
+// Label of the header GPIO controller on the Pi 5. Its /dev/gpiochipN number
+// changed between kernels (4 on older ones, 0 on newer), so look it up by label.
+#define GPIO_CDEV_PI5_LABEL "pinctrl-rp1"
+
+#define GPIO_CDEV_EVENT_BUFFER 64   // Edges the kernel keeps per request until we read them
+#define GPIO_CDEV_MAX_READ     16   // Events fetched per gpio_cdev_read_events() call
+
+typedef struct {
+    uint64_t timestamp_ns;  // Kernel time of the edge (CLOCK_MONOTONIC)
+    unsigned int offset;    // Line number on the chip (e.g. 17)
+    int rising;             // 1 = rising edge, 0 = falling edge
+    uint32_t seqno;         // Running count across the request: a gap means lost events
+} gpio_cdev_event_t;
+
+// Opens the gpiochip whose label is 'label' (e.g. GPIO_CDEV_PI5_LABEL).
+// Returns the chip fd, or -1 if no chip has that label.
+int gpio_cdev_open_chip(const char *label);
+
+// Number N of the /dev/gpiochipN labelled 'label' (what lgGpiochipOpen() takes),
+// or -1 if there is none. Prints nothing.
+int gpio_cdev_find_chip(const char *label);
+
+// Requests 'num_lines' lines of an open chip as inputs with edge detection.
+// 'flags' are GPIO_V2_LINE_FLAG_* values (EDGE_FALLING, EDGE_RISING, BIAS_PULL_UP, ...);
+// INPUT is added automatically. Returns the line request fd (the chip fd can be
+// closed afterwards), or -1 with the reason printed.
+int gpio_cdev_request_edges(int chip_fd, const unsigned int *offsets, int num_lines,
+                            uint64_t flags, const char *consumer);
+
+// Blocks until at least one edge is queued, then returns up to 'max' of them
+// (at most GPIO_CDEV_MAX_READ) from a single read(). Returns the count, or -1.
+int gpio_cdev_read_events(int line_fd, gpio_cdev_event_t *events, int max);
+
+// Current levels of the requested lines (fewer than 64): bit i of the result is
+// line i of the request. Returns -1 on error.
+int64_t gpio_cdev_get_values(int line_fd, int num_lines);
+
+#endif
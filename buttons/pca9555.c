@@ -0,0 +1,24 @@
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <linux/i2c.h>
+#include <linux/i2c-dev.h>
+#include "pca9555.h"
+
+int pca9555_read_inputs(int fd, uint8_t addr, uint8_t *data) {
+    uint8_t reg = PCA9555_INPUT_PORT_0;
+    struct i2c_msg msgs[2] = {
+        { .addr = addr, .flags = 0,        .len = 1, .buf = &reg },
+        { .addr = addr, .flags = I2C_M_RD, .len = 2, .buf = data },  // Auto-increments to Port 1
+    };
+    struct i2c_rdwr_ioctl_data xfer = { msgs, 2 };
+
+    // Returns the number of messages transferred
+    return ioctl(fd, I2C_RDWR, &xfer) == 2 ? 0 : -1;
+}
+
+int pca9555_read_inputs_split(int fd, uint8_t *data) {
+    uint8_t reg = PCA9555_INPUT_PORT_0;
+    if (write(fd, &reg, 1) != 1) return -1;
+    if (read(fd, data, 2) != 2) return -1;
+    return 0;
+}
@@ -0,0 +1,26 @@
+#ifndef PCA9555_H
+#define PCA9555_H
+
+#include <stdint.h>
+
+// --- PCA9555 INPUT READS (i2c-dev) ---
+// Both input ports in one I2C_RDWR ioctl: [S] addr+W, 0x00, [Sr] addr+R, port0, port1 [P].
+// The repeated start keeps the register pointer write and the read in one bus
+// transaction (no STOP in between) and costs one syscall instead of write() + read().
+
+// PCA9555 Command Bytes (from Datasheet Table 4)
+#define PCA9555_INPUT_PORT_0  0x00
+#define PCA9555_INPUT_PORT_1  0x01
+#define PCA9555_CONFIG_PORT_0 0x06
+#define PCA9555_CONFIG_PORT_1 0x07
+
+// Reads Input Port 0 and 1 of the expander at 'addr' into data[0], data[1].
+// Both ports are read, which clears the interrupt either of them raised.
+// Returns 0, or -1 with errno set.
+int pca9555_read_inputs(int fd, uint8_t addr, uint8_t *data);
+
+// The old way: write() the pointer, then read() 2 bytes (two transactions, STOP in
+// between). Needs I2C_SLAVE set on 'fd'. Kept for latency comparisons.
+int pca9555_read_inputs_split(int fd, uint8_t *data);
+
+#endif
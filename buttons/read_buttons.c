@@ -1,172 +1,196 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <unistd.h>
-#include <fcntl.h>
 #include <string.h>
+#include <time.h>
 #include <poll.h>
-#include <sys/ioctl.h>
-#include <linux/i2c-dev.h>
+#include "gpio_cdev.h"
+#include "debounce.h"
+#include "../lib/panel_hw.h"
+#include "../lib/button_panel.h"
 
 // --- CONFIGURATION ---
-#define I2C_DEVICE "/dev/i2c-1"
-#define I2C_ADDR 0x27
+// I2C bus and GPIO chip: see lib/panel_hw.h
+// One entry per PCA9555, all INT lines wired together onto GPIO_INT_PIN.
+// Expander k owns buttons 16k..16k+15.
+static const uint8_t EXPANDERS[] = { 0x27 };
+#define NUM_EXPANDERS (int)(sizeof(EXPANDERS) / sizeof(EXPANDERS[0]))
 
-// PCA9555 Command Bytes (from Datasheet Table 4)
-#define CMD_INPUT_PORT_0  0x00
-#define CMD_INPUT_PORT_1  0x01
-#define CMD_CONFIG_PORT_0 0x06
-#define CMD_CONFIG_PORT_1 0x07
+// --measure: report interrupt-to-data latency every MEASURE_EVERY interrupts,
+// alternating between the combined read and the old split write()+read()
+#define MEASURE_EVERY 100
 
 // GPIO Configuration for Interrupt
-// Using GPIO 17 (Physical Pin 11) for the INT line
-#define GPIO_INT_PIN "17" 
-#define GPIO_PATH "/sys/class/gpio/gpio" GPIO_INT_PIN "/"
-
-// Helper to write to sysfs files
-int write_sysfs(const char *path, const char *filename, const char *value) {
-    char full_path[128];
-    snprintf(full_path, sizeof(full_path), "%s%s", path, filename);
-    
-    int fd = open(full_path, O_WRONLY);
-    if (fd < 0) return -1;
-    
-    write(fd, value, strlen(value));
-    close(fd);
-    return 0;
+// Using GPIO 17 (Physical Pin 11) for the INT line, through the GPIO character device
+#define GPIO_INT_PIN BUTTON_PANEL_INT_PIN
+
+// Helper: Current time in ns (same clock as the kernel event timestamps)
+long long current_timestamp_ns() {
+    struct timespec te;
+    clock_gettime(CLOCK_MONOTONIC, &te);
+    return te.tv_sec * 1000000000LL + te.tv_nsec;
 }
 
-// Setup GPIO for Interrupts (Falling Edge)
-int setup_gpio_interrupt() {
-    // 1. Export the GPIO pin
-    int fd = open("/sys/class/gpio/export", O_WRONLY);
-    if (fd != -1) {
-        write(fd, GPIO_INT_PIN, strlen(GPIO_INT_PIN));
-        close(fd);
-        
-        // Wait 500ms for the OS to create the filesystem nodes
-        // Without this, the next step fails because the directory doesn't exist yet.
-        usleep(500000); 
-    }
+// Interrupt-to-data latency of one read method
+typedef struct {
+    const char *name;
+    unsigned long count;
+    long long sum_ns, min_ns, max_ns;
+} latency_stats_t;
+
+void latency_add(latency_stats_t *st, long long ns) {
+    if (st->count == 0 || ns < st->min_ns) st->min_ns = ns;
+    if (ns > st->max_ns) st->max_ns = ns;
+    st->sum_ns += ns;
+    st->count++;
+}
 
-    // 2. Set Direction to Input
-    if (write_sysfs(GPIO_PATH, "direction", "in") < 0) {
-        perror("Failed to set GPIO direction");
-        return -1;
-    }
+void latency_print(const latency_stats_t *st) {
+    if (st->count == 0) return;
+    printf("[MEASURE] %-8s %5lu reads  avg %7.1f us  min %7.1f us  max %7.1f us\n",
+           st->name, st->count, st->sum_ns / 1000.0 / st->count,
+           st->min_ns / 1000.0, st->max_ns / 1000.0);
+}
 
-    // 3. Set Edge Detection to Falling (PCA9555 INT goes LOW on active)
-    if (write_sysfs(GPIO_PATH, "edge", "falling") < 0) {
-        perror("Failed to set GPIO edge");
-        return -1;
+void handle_event(const button_event_t *ev) {
+    int expander = ev->pin / 16;
+    int port = (ev->pin / 8) % 2;
+    int bit = ev->pin % 8;
+    long long latency_us = (current_timestamp_ns() - (long long)ev->timestamp_ns) / 1000;
+
+    if (ev->type == BUTTON_PRESS && expander == 0 && port == 0) {
+        switch(bit) {
+            case 0: printf("[Group 1] Sequence A triggered"); break;
+            case 1: printf("[Group 2] Data Logged"); break;
+            case 2: printf("[Group 3] Emergency Stop"); break;
+            default: printf("Button %d on Port 0 Pressed", bit); break;
+        }
+        printf(" (%lld us after the edge)\n", latency_us);
+    } else {
+        printf("[0x%02X] Button %d on Port %d: %s\n", EXPANDERS[expander], bit, port,
+               button_event_name(ev->type));
     }
+}
 
-    // 4. Open Value file for polling
-    char val_path[128];
-    snprintf(val_path, sizeof(val_path), "%svalue", GPIO_PATH);
-    int val_fd = open(val_path, O_RDONLY);
-    if (val_fd < 0) {
-        perror("Failed to open GPIO value file");
-        return -1;
-    }
-    return val_fd;
+// Setup GPIO for Interrupts (Falling Edge)
+int setup_gpio_interrupt(int chip_fd) {
+    // Input, falling edge (PCA9555 INT goes LOW on active), pull-up so the line
+    // doesn't float if the PCA9555 isn't connected. Ready as soon as this returns.
+    unsigned int pin = GPIO_INT_PIN;
+    return gpio_cdev_request_edges(chip_fd, &pin, 1,
+                                   GPIO_V2_LINE_FLAG_EDGE_FALLING | GPIO_V2_LINE_FLAG_BIAS_PULL_UP,
+                                   "read_buttons");
 }
 
-int main() {
-    int i2c_fd, gpio_fd;
+int main(int argc, char **argv) {
+    panel_hw_t hw;
+    int gpio_fd;
+    int measure = (argc > 1 && strcmp(argv[1], "--measure") == 0);
+    latency_stats_t stats[2] = { { "combined" }, { "split" } };
     
-    // --- STEP 1: I2C SETUP ---
-    if ((i2c_fd = open(I2C_DEVICE, O_RDWR)) < 0) {
-        perror("Failed to open I2C bus");
-        return 1;
-    }
-    if (ioctl(i2c_fd, I2C_SLAVE, I2C_ADDR) < 0) {
-        perror("Failed to acquire bus access");
+    // --- STEP 1: I2C + GPIO CHIP ---
+    int want = PANEL_HW_I2C | PANEL_HW_GPIO;
+    if (panel_hw_open(&hw, want, 0) != want) {
+        panel_hw_close(&hw);
         return 1;
     }
+    // Inputs on every expander; I2C_RDWR carries the addresses itself
+    button_panel_t panel;
+    if (button_panel_open(&panel, hw.i2c_fd, EXPANDERS, NUM_EXPANDERS) < 0) return 1;
 
     // --- STEP 2: GPIO INTERRUPT SETUP ---
-    gpio_fd = setup_gpio_interrupt();
+    gpio_fd = setup_gpio_interrupt(hw.gpio_fd);
     if (gpio_fd < 0) return 1;
 
     printf("PCA9555 Interrupt Monitor Started.\n");
-    printf("Monitoring GPIO %s for falling edge from PCA9555...\n", GPIO_INT_PIN);
+    printf("Monitoring GPIO %d for falling edge from %d PCA9555...\n", GPIO_INT_PIN, NUM_EXPANDERS);
+    if (measure) printf("Measuring interrupt-to-data latency (combined vs split reads).\n");
 
-    // Buffer for 2 bytes (Port 0 and Port 1)
-    unsigned char data[2];
-    unsigned char last_state[2] = {0xFF, 0xFF};
+    // Bit i = button i pressed, 16 per expander
+    uint64_t pressed[BUTTON_MATRIX_WORDS] = {0};
 
     // --- STEP 3: INITIAL READ (Crucial) ---
-    // We must read registers once to clear any existing interrupts on the PCA9555.
-    // We write the command byte 0x00 (Input Port 0) to set the internal pointer.
-    data[0] = CMD_INPUT_PORT_0;
-    if (write(i2c_fd, data, 1) != 1) perror("Init write failed");
-    
-    // Read 2 bytes: The PCA9555 auto-increments from Reg 0 to Reg 1.
-    // This reads both ports and clears interrupts for BOTH.
-    if (read(i2c_fd, data, 2) == 2) {
-        last_state[0] = data[0];
-        last_state[1] = data[1];
+    // We must read registers once to clear any existing interrupts on the PCA9555s.
+    // One combined transaction per expander: pointer 0x00 (Input Port 0),
+    // repeated start, 2 bytes. The PCA9555 auto-increments from Reg 0 to Reg 1, so
+    // this reads both ports and clears interrupts for BOTH.
+    if (button_panel_read(&panel, pressed) < 0) {
+        perror("Initial I2C read failed");
     }
 
-    struct pollfd pfd;
-    pfd.fd = gpio_fd;
-    pfd.events = POLLPRI; // Priority data (interrupt)
+    // Per-button debounce, driven by the edge timestamps (no sleeping)
+    debounce_cfg_t debounce_cfg = DEBOUNCE_DEFAULT_CFG;
+    debouncer_t debouncer;
+    debounce_init(&debouncer, &debounce_cfg, button_panel_inputs(&panel), pressed,
+                  current_timestamp_ns());
+    button_event_t button_events[2 * DEBOUNCE_MAX_PINS];
+
+    gpio_cdev_event_t events[GPIO_CDEV_MAX_READ];
+    uint32_t last_seqno = 0;
+    struct pollfd pfd = { gpio_fd, POLLIN, 0 };
 
     while (1) {
         // --- STEP 4: WAIT FOR INTERRUPT ---
-        // This blocks the CPU until the INT line goes LOW. No more 50ms sleep!
-        // Timeout is -1 (infinite).
-        int ret = poll(&pfd, 1, -1);
-
-        if (ret > 0) {
-            if (pfd.revents & POLLPRI) {
-                // Determine what happened: seek to start of GPIO value file and read it
-                lseek(gpio_fd, 0, SEEK_SET);
-                char gpio_val;
-                read(gpio_fd, &gpio_val, 1);
-
-                // --- STEP 5: READ PCA9555 ---
-                // We send Command 0x00 again to ensure we are reading from Input Port 0
-                unsigned char reg_ptr = CMD_INPUT_PORT_0;
-                write(i2c_fd, &reg_ptr, 1);
-
-                // Read 2 bytes (Port 0 and Port 1)
-                // DATASHEET NOTE: "The interrupt caused by Port 0 will not be cleared by a read of Port 1"
-                // Reading both ensures we clear the interrupt regardless of which pin triggered it.
-                if (read(i2c_fd, data, 2) != 2) {
-                    perror("Failed to read I2C");
-                    continue;
-                }
-
-                // --- STEP 6: LOGIC ---
-                // Check Port 0 (data[0])
-                for (int i = 0; i < 8; i++) {
-                    int isPressed = !((data[0] >> i) & 1);
-                    int wasPressed = !((last_state[0] >> i) & 1);
-
-                    if (isPressed && !wasPressed) {
-                        switch(i) {
-                            case 0: printf("[Group 1] Sequence A triggered\n"); break;
-                            case 1: printf("[Group 2] Data Logged\n"); break;
-                            case 2: printf("[Group 3] Emergency Stop\n"); break;
-                            default: printf("Button %d on Port 0 Pressed\n", i); break;
-                        }
-                    }
-                }
-                
-                // Update last state
-                last_state[0] = data[0];
-                last_state[1] = data[1];
-                
-                // Simple debounce: interrupts can fire rapidly. 
-                // Since the INT line stays LOW until we read, we might not need a huge sleep,
-                // but a tiny one helps ignore mechanical switch bounce.
-                usleep(20000); 
+        // Blocks until the INT line goes LOW, or until the debouncer has something due
+        // (a release becoming stable, a long press, a repeat).
+        int timeout_ms = -1;
+        uint64_t deadline = debounce_next_deadline(&debouncer);
+        if (deadline != DEBOUNCE_NONE) {
+            long long left = (long long)deadline - current_timestamp_ns();
+            timeout_ms = left > 0 ? (int)((left + 999999) / 1000000) : 0;
+        }
+        int ret = poll(&pfd, 1, timeout_ms);
+        if (ret == 0) {
+            int k = debounce_tick(&debouncer, current_timestamp_ns(), button_events, 2 * DEBOUNCE_MAX_PINS);
+            for (int i = 0; i < k; i++) handle_event(&button_events[i]);
+            continue;
+        }
+        if (ret < 0) continue;
+
+        // One read() returns every edge queued since the last one, each with the
+        // kernel timestamp of the edge.
+        int n = gpio_cdev_read_events(gpio_fd, events, GPIO_CDEV_MAX_READ);
+        if (n < 0) {
+            perror("Failed to read GPIO events");
+            break;
+        }
+        if (n == 0) continue;
+
+        // Gaps in the sequence numbers mean the kernel queue overflowed
+        if (last_seqno && events[0].seqno != last_seqno + 1) {
+            printf("(%u edges lost)\n", events[0].seqno - last_seqno - 1);
+        }
+        last_seqno = events[n - 1].seqno;
+
+        // --- STEP 5: READ PCA9555 ---
+        // One read covers all queued edges: the registers hold the current state.
+        // DATASHEET NOTE: "The interrupt caused by Port 0 will not be cleared by a read of Port 1"
+        // Reading both ensures we clear the interrupt regardless of which pin triggered it.
+        int split = measure && (last_seqno & 1);
+        int status = split ? button_panel_read_split(&panel, pressed)
+                           : button_panel_read(&panel, pressed);
+        if (status < 0) {
+            perror("Failed to read I2C");
+            continue;
+        }
+
+        if (measure) {
+            // From the kernel timestamp of the newest edge to data in hand
+            latency_add(&stats[split], current_timestamp_ns() - (long long)events[n - 1].timestamp_ns);
+            if ((stats[0].count + stats[1].count) % MEASURE_EVERY == 0) {
+                latency_print(&stats[0]);
+                latency_print(&stats[1]);
             }
         }
+
+        // --- STEP 6: LOGIC ---
+        // Each button settles on its own timer, stamped with the newest edge of the batch
+        int k = debounce_update(&debouncer, pressed, events[n - 1].timestamp_ns,
+                                button_events, 2 * DEBOUNCE_MAX_PINS);
+        for (int i = 0; i < k; i++) handle_event(&button_events[i]);
     }
 
-    close(i2c_fd);
     close(gpio_fd);
+    panel_hw_close(&hw);
     return 0;
 }
\ No newline at end of file
@@ -1,128 +1,161 @@
-#define _POSIX_C_SOURCE 199309L
+#define _POSIX_C_SOURCE 200112L
 
 #include <stdio.h>
 #include <stdlib.h>
 #include <unistd.h>
-#include <fcntl.h>
-#include <sys/ioctl.h>
-#include <linux/i2c-dev.h>
 #include <lgpio.h>
 #include <time.h>
+#include <pthread.h>
+#include "button_ring.h"
+#include "debounce.h"
+#include "../lib/panel_hw.h"
+#include "../lib/button_panel.h"
+#include "../common/rt_sched.h"
 
 // --- CONFIGURATION ---
-#define I2C_DEVICE "/dev/i2c-1"
-#define I2C_ADDR 0x23
+// I2C bus and GPIO chip (found by label): see lib/panel_hw.h
+// One entry per PCA9555, all INT lines wired together onto GPIO_INT_PIN.
+// Expander k owns buttons 16k..16k+15.
+static const uint8_t EXPANDERS[] = { 0x23 };
+#define NUM_EXPANDERS (int)(sizeof(EXPANDERS) / sizeof(EXPANDERS[0]))
 
-// Raspberry Pi 5 usually uses Chip 4 for the header pins. 
-// If this doesn't work, try 0.
-#define GPIO_CHIP 4
-#define GPIO_INT_PIN 17
+#define GPIO_INT_PIN BUTTON_PANEL_INT_PIN
 
-// PCA9555 Commands
-#define CMD_INPUT_PORT_0 0x00
+// Opened once, shared with the callback
+panel_hw_t hw;
+button_panel_t panel;               // Alert thread only, after startup
+uint64_t init_pressed[BUTTON_MATRIX_WORDS]; // Initial state, for the debouncer
 
-// Global file descriptor for I2C so the callback can use it
-int i2c_fd;
-// Track last state to detect edges
-unsigned char last_state[2] = {0xFF, 0xFF};
+// PANEL_RT settings (see common/rt_sched.h): the alert thread is "input"
+rt_cfg_t rt;
 
-// Helper for timing (Debounce)
-long long current_timestamp_ms() {
+// Alert thread -> consumer thread
+button_ring_t ring;
+volatile int running = 1;
+unsigned long i2c_errors = 0; // Failed reads on the alert thread (reported at exit)
+
+// Helper: Current time in ns (CLOCK_MONOTONIC, like the lgpio alert timestamps)
+uint64_t current_timestamp_ns() {
     struct timespec te; 
     clock_gettime(CLOCK_MONOTONIC, &te);
-    return te.tv_sec*1000LL + te.tv_nsec/1000000LL;
+    return (uint64_t)te.tv_sec * 1000000000ULL + (uint64_t)te.tv_nsec;
 }
-long long last_interrupt_time = 0;
 
 // --- INTERRUPT CALLBACK ---
-// This function runs automatically when the INT pin goes LOW
+// This function runs automatically when the INT pin goes LOW, on lgpio's alert thread.
+// It only reads the PCA9555 (which clears the interrupt) and queues what it read:
+// debouncing, decoding and actions run on the consumer thread, so they never delay the
+// next read. Every interrupt is read; none is dropped by a time window.
 void on_interrupt(int num_alerts, lgGpioAlert_p gpio_alerts, void *userdata) {
-    long long now = current_timestamp_ms();
-    
-    // 1. Debounce: Ignore interrupts that happen within 20ms of the last one
-    if (now - last_interrupt_time < 20) return;
-    last_interrupt_time = now;
-
-    // 2. Read PCA9555 to clear the interrupt
-    // Write Command Byte (Set pointer to Port 0)
-    unsigned char reg_ptr = CMD_INPUT_PORT_0;
-    if (write(i2c_fd, &reg_ptr, 1) != 1) {
-        perror("Failed to write register pointer");
-        return;
+    // lgpio creates the alert thread, so it gets its priority/CPU on the first alert
+    static int rt_applied = 0;
+    if (!rt_applied) {
+        rt_applied = 1;
+        rt_apply_self(&rt, RT_ROLE_INPUT, "alert thread");
     }
 
-    // Read 2 Bytes (Port 0 and Port 1)
-    unsigned char data[2];
-    if (read(i2c_fd, data, 2) != 2) {
-        perror("Failed to read I2C data");
+    // 1. Read every PCA9555 to clear the interrupt (any of them may have pulled INT low)
+    // One I2C_RDWR per expander: pointer to Port 0, repeated start, 2 bytes
+    button_record_t rec;
+    if (button_panel_read(&panel, rec.pressed) < 0) {
+        i2c_errors++;
         return;
     }
 
-    // 3. Logic: Compare new data with old data
-    for (int i = 0; i < 8; i++) {
-        // Check Port 0
-        int isPressed = !((data[0] >> i) & 1);
-        int wasPressed = !((last_state[0] >> i) & 1);
-
-        if (isPressed && !wasPressed) {
-            printf(">> [INTERRUPT] Button %d on Port 0 Pressed!\n", i);
-            
-            // Example Actions
-            if (i == 0) printf("   -> Sequence A Started\n");
-            if (i == 1) printf("   -> Data Logged\n");
-        }
+    // 2. Hand off, stamped with the kernel time of the newest edge in this batch
+    rec.timestamp_ns = gpio_alerts[num_alerts - 1].report.timestamp;
+    if (button_ring_push(&ring, &rec) == 0) button_ring_notify(&ring);
+}
+
+void handle_event(const button_event_t *ev) {
+    int expander = ev->pin / 16;
+    int port = (ev->pin / 8) % 2;
+    int bit = ev->pin % 8;
+
+    if (ev->type == BUTTON_PRESS && expander == 0 && port == 0) {
+        printf(">> [INTERRUPT] Button %d on Port 0 Pressed!\n", bit);
+
+        // Example Actions
+        if (bit == 0) printf("   -> Sequence A Started\n");
+        if (bit == 1) printf("   -> Data Logged\n");
+    } else {
+        printf(">> [0x%02X] Button %d on Port %d: %s\n", EXPANDERS[expander], bit, port,
+               button_event_name(ev->type));
     }
+}
 
-    // Update state
-    last_state[0] = data[0];
-    last_state[1] = data[1];
+// --- CONSUMER THREAD ---
+// Debounces the queued port states per button and runs the actions
+void *consumer_thread(void *arg) {
+    debounce_cfg_t cfg = DEBOUNCE_DEFAULT_CFG;
+    debouncer_t debouncer;
+    button_event_t events[2 * DEBOUNCE_MAX_PINS];
+    button_record_t rec;
+
+    debounce_init(&debouncer, &cfg, NUM_EXPANDERS * 16, init_pressed, current_timestamp_ns());
+
+    while (running) {
+        // Sleep until the next record, or until a release settles / a long press is due
+        if (!button_ring_wait(&ring, debounce_next_deadline(&debouncer))) {
+            int n = debounce_tick(&debouncer, current_timestamp_ns(), events, 2 * DEBOUNCE_MAX_PINS);
+            for (int i = 0; i < n; i++) handle_event(&events[i]);
+            continue;
+        }
+
+        while (button_ring_pop(&ring, &rec)) {
+            int n = debounce_update(&debouncer, rec.pressed, rec.timestamp_ns,
+                                    events, 2 * DEBOUNCE_MAX_PINS);
+            for (int i = 0; i < n; i++) handle_event(&events[i]);
+        }
+    }
+    return NULL;
 }
 
 int main() {
-    int hGpio;
     int status;
 
-    // --- STEP 1: OPEN I2C ---
-    if ((i2c_fd = open(I2C_DEVICE, O_RDWR)) < 0) {
-        perror("Failed to open I2C bus");
-        return 1;
-    }
-    if (ioctl(i2c_fd, I2C_SLAVE, I2C_ADDR) < 0) {
-        perror("Failed to acquire bus access");
+    // Priorities / CPUs / mlockall from PANEL_RT, before any thread exists
+    if (rt_config_load(&rt) < 0) return 1;
+
+    // --- STEP 1: OPEN I2C + GPIO CHIP ---
+    int want = PANEL_HW_I2C | PANEL_HW_GPIO;
+    if (panel_hw_open(&hw, want, 0) != want) {
+        panel_hw_close(&hw);
         return 1;
     }
+    // No I2C_SLAVE needed: every I2C_RDWR message carries the address
 
-    // --- STEP 2: INITIAL I2C READ ---
+    // --- STEP 2: CONFIGURE EXPANDERS + INITIAL READ ---
     // Read once to clear any stuck interrupts before we start monitoring
-    unsigned char ptr = CMD_INPUT_PORT_0;
-    write(i2c_fd, &ptr, 1);
-    unsigned char init_data[2];
-    if (read(i2c_fd, init_data, 2) == 2) {
-        last_state[0] = init_data[0];
-        last_state[1] = init_data[1];
-        printf("Initial State: Port0=0x%X, Port1=0x%X\n", init_data[0], init_data[1]);
+    if (button_panel_open(&panel, hw.i2c_fd, EXPANDERS, NUM_EXPANDERS) < 0) return 1;
+    if (button_panel_read(&panel, init_pressed) == 0) {
+        for (int k = 0; k < NUM_EXPANDERS; k++) {
+            const uint8_t *ports = button_panel_ports(&panel, k);
+            printf("Initial State 0x%02X: Port0=0x%X, Port1=0x%X\n", EXPANDERS[k], ports[0], ports[1]);
+        }
     }
 
-    // --- STEP 3: OPEN GPIO CHIP ---
-    hGpio = lgGpiochipOpen(GPIO_CHIP);
-    if (hGpio < 0) {
-        fprintf(stderr, "Error: Could not open GPIO chip %d. Try changing GPIO_CHIP to 0.\n", GPIO_CHIP);
+    // --- STEP 3: START CONSUMER ---
+    button_ring_init(&ring);
+    pthread_t consumer;
+    if (pthread_create(&consumer, NULL, consumer_thread, NULL) != 0) {
+        fprintf(stderr, "Error: Could not start the consumer thread.\n");
         return 1;
     }
 
     // --- STEP 4: CLAIM PIN AND SET INTERRUPT ---
     // Claim Pin 17 as Input, Active Low (Pull-Up not strictly needed if PCA9555 drives it, but safe)
     // LG_SET_PULL_UP ensures the line doesn't float if PCA isn't connected.
-    status = lgGpioClaimAlert(hGpio, 0, LG_FALLING_EDGE, GPIO_INT_PIN, -1);
+    status = lgGpioClaimAlert(hw.gpio, 0, LG_FALLING_EDGE, GPIO_INT_PIN, -1);
     if (status < 0) {
         fprintf(stderr, "Error claiming GPIO alert: %s\n", lguErrorText(status));
         return 1;
     }
 
     // Register the callback function
-    lgGpioSetAlertsFunc(hGpio, GPIO_INT_PIN, on_interrupt, NULL);
+    lgGpioSetAlertsFunc(hw.gpio, GPIO_INT_PIN, on_interrupt, NULL);
 
-    printf("Program Running. Waiting for interrupts on GPIO %d (Chip %d)...\n", GPIO_INT_PIN, GPIO_CHIP);
+    printf("Program Running. Waiting for interrupts on GPIO %d (Chip %d)...\n", GPIO_INT_PIN, hw.gpio_chip);
     printf("Press Enter to quit.\n");
 
     // --- STEP 5: KEEP ALIVE ---
@@ -130,9 +163,13 @@ int main() {
     // We just keep the main thread alive.
     while (getchar() != '\n');
 
-    // Cleanup
-    lgGpiochipClose(hGpio);
-    close(i2c_fd);
-    printf("Exiting...\n");
+    // Cleanup: stop the alerts first, the callback uses the I2C fd
+    lgGpioFree(hw.gpio, GPIO_INT_PIN);
+    running = 0;
+    button_ring_notify(&ring);
+    pthread_join(consumer, NULL);
+    panel_hw_close(&hw);
+    printf("Exiting... (%llu events dropped by a full queue, %lu I2C errors)\n",
+           (unsigned long long)button_ring_overflows(&ring), i2c_errors);
     return 0;
 }
\ No newline at end of file
@@ -1,152 +1,388 @@
-#define _POSIX_C_SOURCE 199309L
+#define _POSIX_C_SOURCE 200112L
 
 #include <stdio.h>
 #include <stdlib.h>
 #include <unistd.h>
 #include <lgpio.h>
 #include <time.h>
-#include <string.h> // For strerror
+#include <string.h>
+#include <pthread.h>
+#include <semaphore.h>
+#include <errno.h>
+#include <stdatomic.h>
+#include "button_ring.h"
+#include "debounce.h"
+#include "../lib/panel_hw.h"
+#include "../lib/button_panel.h"
+#include "../common/log_ring.h"
+#include "../common/rt_sched.h"
 
 // --- CONFIGURATION ---
-#define I2C_DEV_NUM 1
-#define I2C_ADDR 0x23        // Ensure this matches 'i2cdetect -y 1'
-#define GPIO_CHIP 4          // RPi 5 uses Chip 4
-#define GPIO_INT_PIN 17      // GPIO pin for interrupt
+// I2C bus, GPIO chip and the expander address (BUTTON_PANEL_ADDR, check
+// 'i2cdetect -y 1'): see lib/panel_hw.h and lib/button_panel.h
+#define GPIO_INT_PIN BUTTON_PANEL_INT_PIN  // GPIO pin for interrupt
 
-// PCA9555 Registers
-#define REG_INPUT_0 0x00
+// --measure: print interrupt-to-data latency every MEASURE_EVERY interrupts
+#define MEASURE_EVERY 100
 
-// Handles
-int hI2c;
-int hGpio;
+// Handles, opened once
+panel_hw_t hw;
+button_panel_t panel;   // Single expander, read under producer_lock
 
-// Debounce state
-unsigned char last_state[2] = {0xFF, 0xFF};
-long long last_interrupt_time = 0;
+// Initial port state, for the debouncer
+unsigned char init_state[2] = {0xFF, 0xFF};
 
-// Helper: Current time in ms
-long long current_timestamp_ms() {
+// Per-button debounce thresholds (applied on the consumer thread)
+#define PRESS_STABLE_MS   0     // 0 = act on the first edge
+#define RELEASE_STABLE_MS 50
+#define LONG_PRESS_MS     800
+#define REPEAT_MS         200
+
+// Adaptive polling: a burst of interrupts switches to reading the PCA9555 at a fixed
+// rate; once the inputs stop changing it goes back to waiting for the INT line.
+// While polling, INT stays low until the next poll reads it, so there is at most one
+// edge (and one alert wakeup) per poll interval however much the buttons bounce.
+#define BURST_IRQS        8     // Interrupts within BURST_WINDOW_MS that start polling (0 = never)
+#define BURST_WINDOW_MS   20
+#define POLL_INTERVAL_MS  2
+#define QUIET_MS          100   // No input change for this long: back to interrupts
+
+// PANEL_RT settings (see common/rt_sched.h): the alert and poller threads are "input"
+rt_cfg_t rt;
+
+// Alert thread / poller thread -> consumer thread
+button_ring_t ring;
+unsigned long read_errors = 0;  // Failed PCA9555 reads (alert and poller thread)
+
+// Reads + pushes happen on the alert thread or the poller thread: the lock keeps the
+// ring single-producer. Only contended around a mode switch.
+pthread_mutex_t producer_lock = PTHREAD_MUTEX_INITIALIZER;
+uint64_t last_push_ns = 0;      // Records stay in time order across both producers
+unsigned char last_data[2] = {0xFF, 0xFF};
+
+enum { MODE_INTERRUPT, MODE_POLL };
+_Atomic int input_mode = MODE_INTERRUPT;
+sem_t poll_start;               // Posted by the alert thread to wake the poller
+unsigned long irq_burst = 0;    // Alerts in the current burst window (alert thread only)
+uint64_t burst_start_ns = 0;
+unsigned long polls = 0, poll_switches = 0;
+
+// Helper: Current time in ns (CLOCK_MONOTONIC, like the lgpio alert timestamps)
+uint64_t current_timestamp_ns() {
     struct timespec te; 
     clock_gettime(CLOCK_MONOTONIC, &te);
-    return te.tv_sec*1000LL + te.tv_nsec/1000000LL;
+    return (uint64_t)te.tv_sec * 1000000000ULL + (uint64_t)te.tv_nsec;
 }
 
-// --- SAFE I2C READ FUNCTION ---
-// Replaces BlockRead with Split Write+Read to avoid ENOMSG (-42)
-int read_pca9555_inputs(unsigned char *buffer) {
-    int status;
-
-    // Step 1: Set the Register Pointer to Input Port 0
-    // Transaction: [START] [ADDR+W] [0x00] [STOP]
-    status = lgI2cWriteByte(hI2c, REG_INPUT_0);
-    if (status < 0) {
-        printf("[DEBUG] I2C Write Pointer Failed. Code: %d (%s)\n", status, lguErrorText(status));
-        return status;
-    }
+// Buttons are active low: bit i = pin i pressed (port 0 = bits 0-7, port 1 = 8-15).
+// Single expander, so everything lands in the first word of the bitmap.
+void pressed_bits(const unsigned char *data, uint64_t *pressed) {
+    pressed[0] = ~((uint64_t)data[0] | ((uint64_t)data[1] << 8)) & 0xFFFF;
+    for (int w = 1; w < BUTTON_RING_WORDS; w++) pressed[w] = 0;
+}
 
-    // Step 2: Read 2 Bytes from the current pointer
-    // Transaction: [START] [ADDR+R] [DATA0] [DATA1] [STOP]
-    status = lgI2cReadDevice(hI2c, (char*)buffer, 2);
-    if (status < 0) {
-        printf("[DEBUG] I2C Read Device Failed. Code: %d (%s)\n", status, lguErrorText(status));
-        return status;
+// --- COMBINED I2C READ ---
+// Pointer write and 2-byte read as one repeated-start transaction (one I2C_RDWR ioctl):
+// [START] [ADDR+W] [0x00] [RESTART] [ADDR+R] [DATA0] [DATA1] [STOP]
+int read_pca9555_inputs(unsigned char *buffer) {
+    uint64_t pressed[BUTTON_MATRIX_WORDS];
+    if (button_panel_read(&panel, pressed) < 0) {
+        LOG_WARN("[I2C] Combined Read Failed: errno %d\n", errno); // No strerror(): log_ring.h prints later
+        return -1;
     }
+    memcpy(buffer, button_panel_ports(&panel, 0), 2);
+    return 0; // Success
+}
 
-    // Check if we actually got 2 bytes
-    if (status != 2) {
-        printf("[DEBUG] Partial Read. Expected 2 bytes, got %d\n", status);
+// --- SPLIT I2C READ (old method, kept for --measure) ---
+// [START] [ADDR+W] [0x00] [STOP], then [START] [ADDR+R] [DATA0] [DATA1] [STOP]
+int read_pca9555_inputs_split(unsigned char *buffer) {
+    uint64_t pressed[BUTTON_MATRIX_WORDS];
+    if (button_panel_read_split(&panel, pressed) < 0) {
+        LOG_WARN("[I2C] Split Read Failed: errno %d\n", errno);
         return -1;
     }
-
+    memcpy(buffer, button_panel_ports(&panel, 0), 2);
     return 0; // Success
 }
 
+// --- LATENCY MEASUREMENT (--measure) ---
+// Alert timestamp to data in hand, per read method. Updated and printed on the
+// alert thread, only in measurement mode.
+typedef struct {
+    const char *name;
+    unsigned long count;
+    uint64_t sum_ns, min_ns, max_ns;
+} latency_stats_t;
+
+int measure = 0;
+latency_stats_t stats[2] = { { "combined" }, { "split" } };
+
+void latency_add(latency_stats_t *st, uint64_t ns) {
+    if (st->count == 0 || ns < st->min_ns) st->min_ns = ns;
+    if (ns > st->max_ns) st->max_ns = ns;
+    st->sum_ns += ns;
+    st->count++;
+}
+
+void latency_print(const latency_stats_t *st) {
+    if (st->count == 0) return;
+    LOG_INFO("[MEASURE] %-8s %5lu reads  avg %7.1f us  min %7.1f us  max %7.1f us\n",
+             st->name, st->count, st->sum_ns / 1000.0 / st->count,
+             st->min_ns / 1000.0, st->max_ns / 1000.0);
+}
+
+// Queues a sample for the consumer. Caller holds producer_lock.
+void push_sample(const unsigned char *data, uint64_t ts_ns) {
+    if (ts_ns < last_push_ns) ts_ns = last_push_ns;
+    last_push_ns = ts_ns;
+    last_data[0] = data[0];
+    last_data[1] = data[1];
+
+    button_record_t rec;
+    rec.timestamp_ns = ts_ns;
+    pressed_bits(data, rec.pressed);
+    if (button_ring_push(&ring, &rec) == 0) button_ring_notify(&ring);
+}
+
 // --- INTERRUPT CALLBACK ---
+// Runs on lgpio's alert thread. Only reads the PCA9555 and queues the result,
+// so a slow action or printf never delays the next read (messages go through the
+// log ring, formatted on the log writer thread). Every interrupt is read:
+// bounces are sorted out per button by the consumer.
 void on_interrupt(int num_alerts, lgGpioAlert_p gpio_alerts, void *userdata) {
-    long long now = current_timestamp_ms();
-    
-    // Debug print to confirm HW pin triggered
-    printf("\n[IRQ] Interrupt Triggered on GPIO %d at %lld ms\n", GPIO_INT_PIN, now);
+    unsigned char data[2];
+    uint64_t edge_ns = gpio_alerts[num_alerts - 1].report.timestamp;
 
-    // Debounce (50ms)
-    if (now - last_interrupt_time < 50) {
-        printf("[IRQ] Debounced (Ignored)\n");
+    // lgpio creates the alert thread, so it gets its priority/CPU on the first alert
+    static int rt_applied = 0;
+    if (!rt_applied) {
+        rt_applied = 1;
+        rt_apply_self(&rt, RT_ROLE_INPUT, "alert thread");
+    }
+
+    // The poller reads on its own schedule; the edge just says something changed
+    if (atomic_load_explicit(&input_mode, memory_order_relaxed) == MODE_POLL) return;
+
+    // Too many interrupts in a short window: hand over to the poller
+    if (BURST_IRQS > 0) {
+        if (edge_ns - burst_start_ns > BURST_WINDOW_MS * 1000000ULL) {
+            burst_start_ns = edge_ns;
+            irq_burst = 0;
+        }
+        if (++irq_burst >= BURST_IRQS) {
+            irq_burst = 0;
+            atomic_store_explicit(&input_mode, MODE_POLL, memory_order_relaxed);
+            sem_post(&poll_start);
+        }
+    }
+
+    pthread_mutex_lock(&producer_lock);
+
+    // --measure alternates the two methods so both see the same conditions
+    int split = measure && ((stats[0].count + stats[1].count) & 1);
+    if ((split ? read_pca9555_inputs_split(data) : read_pca9555_inputs(data)) != 0) {
+        read_errors++;
+        pthread_mutex_unlock(&producer_lock);
         return;
     }
-    last_interrupt_time = now;
 
-    unsigned char data[2];
-    
-    // Attempt to read using the split method
-    if (read_pca9555_inputs(data) == 0) {
-        printf("[IRQ] Read Success: Port0=0x%02X, Port1=0x%02X\n", data[0], data[1]);
+    if (measure) {
+        latency_add(&stats[split], current_timestamp_ns() - edge_ns);
+        if ((stats[0].count + stats[1].count) % MEASURE_EVERY == 0) {
+            latency_print(&stats[0]);
+            latency_print(&stats[1]);
+        }
+    }
+
+    // Stamped with the kernel time of the newest edge in this batch
+    push_sample(data, edge_ns);
+    pthread_mutex_unlock(&producer_lock);
+}
 
-        // Detect Changes
-        for (int i = 0; i < 8; i++) {
-            int isPressed = !((data[0] >> i) & 1);
-            int wasPressed = !((last_state[0] >> i) & 1);
+// --- POLLER THREAD ---
+// Sleeps on a semaphore while in interrupt mode (no CPU when idle). In poll mode it
+// reads every POLL_INTERVAL_MS on an absolute schedule and only queues changes.
+void *poller_thread(void *arg) {
+    rt_apply_self(&rt, RT_ROLE_INPUT, "poller thread");
+    while (1) {
+        while (sem_wait(&poll_start) < 0);
+        poll_switches++;
+        LOG_INFO("[MODE] Interrupt burst: polling every %d ms\n", POLL_INTERVAL_MS);
+
+        struct timespec next;
+        clock_gettime(CLOCK_MONOTONIC, &next);
+        uint64_t last_change_ns = current_timestamp_ns();
+
+        while (1) {
+            unsigned char data[2];
+            uint64_t now = current_timestamp_ns();
+
+            pthread_mutex_lock(&producer_lock);
+            polls++;
+            if (read_pca9555_inputs(data) != 0) {
+                read_errors++;
+            } else if (data[0] != last_data[0] || data[1] != last_data[1]) {
+                push_sample(data, now);
+                last_change_ns = now;
+            }
 
-            if (isPressed && !wasPressed) {
-                printf(">>> ACTION: Button %d Pressed! <<<\n", i);
+            if (now - last_change_ns >= QUIET_MS * 1000000ULL) {
+                // Back to interrupts. Switch first, then read once more under the lock:
+                // a change before this read is in it, one after it pulls INT low again.
+                atomic_store_explicit(&input_mode, MODE_INTERRUPT, memory_order_relaxed);
+                if (read_pca9555_inputs(data) == 0) {
+                    if (data[0] != last_data[0] || data[1] != last_data[1]) {
+                        push_sample(data, current_timestamp_ns());
+                    }
+                } else {
+                    read_errors++;
+                }
+                pthread_mutex_unlock(&producer_lock);
+                LOG_INFO("[MODE] Quiet: back to interrupts (%lu polls so far)\n", polls);
+                break;
             }
+            pthread_mutex_unlock(&producer_lock);
+
+            next.tv_nsec += POLL_INTERVAL_MS * 1000000L;
+            if (next.tv_nsec >= 1000000000L) {
+                next.tv_sec++;
+                next.tv_nsec -= 1000000000L;
+            }
+            while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &next, NULL) != 0);
         }
-        
-        // Update state
-        last_state[0] = data[0];
-        last_state[1] = data[1];
+    }
+    return NULL;
+}
+
+void handle_event(const button_event_t *ev) {
+    int port = ev->pin / 8;
+    int bit = ev->pin % 8;
+
+    if (ev->type == BUTTON_PRESS && port == 0) {
+        LOG_INFO(">>> ACTION: Button %d Pressed! <<<\n", bit);
     } else {
-        printf("[IRQ] ERROR: Failed to read PCA9555 state.\n");
+        LOG_INFO("[BTN] Button %d on Port %d: %s\n", bit, port, button_event_name(ev->type));
     }
 }
 
-int main() {
+// --- CONSUMER THREAD ---
+void *consumer_thread(void *arg) {
+    debounce_cfg_t cfg = {
+        PRESS_STABLE_MS * 1000000ULL, RELEASE_STABLE_MS * 1000000ULL,
+        LONG_PRESS_MS * 1000000ULL, REPEAT_MS * 1000000ULL
+    };
+    debouncer_t debouncer;
+    button_event_t events[2 * DEBOUNCE_MAX_PINS];
+    button_record_t rec;
+    unsigned long reported_errors = 0;
+    uint64_t reported_overflows = 0;
+    uint64_t init_pressed[BUTTON_RING_WORDS];
+
+    pressed_bits(init_state, init_pressed);
+    debounce_init(&debouncer, &cfg, 16, init_pressed, current_timestamp_ns());
+
+    while (1) {
+        // Sleep until the next record, or until a release settles / a long press is due
+        if (!button_ring_wait(&ring, debounce_next_deadline(&debouncer))) {
+            int n = debounce_tick(&debouncer, current_timestamp_ns(), events, 2 * DEBOUNCE_MAX_PINS);
+            for (int i = 0; i < n; i++) handle_event(&events[i]);
+            continue;
+        }
+
+        while (button_ring_pop(&ring, &rec)) {
+            LOG_DEBUG("\n[IRQ] Interrupt on GPIO %d at %llu ns: pressed=0x%04llX\n",
+                      GPIO_INT_PIN, (unsigned long long)rec.timestamp_ns,
+                      (unsigned long long)rec.pressed[0]);
+
+            // Counters from the alert thread, reported as they change
+            if (read_errors != reported_errors) {
+                LOG_WARN("[IRQ] ERROR: %lu failed PCA9555 reads so far\n", read_errors);
+                reported_errors = read_errors;
+            }
+            if (button_ring_overflows(&ring) != reported_overflows) {
+                reported_overflows = button_ring_overflows(&ring);
+                LOG_WARN("[IRQ] %llu events dropped (queue full)\n", (unsigned long long)reported_overflows);
+            }
+
+            int n = debounce_update(&debouncer, rec.pressed, rec.timestamp_ns,
+                                    events, 2 * DEBOUNCE_MAX_PINS);
+            for (int i = 0; i < n; i++) handle_event(&events[i]);
+        }
+    }
+    return NULL;
+}
+
+int main(int argc, char **argv) {
     int status;
 
+    measure = (argc > 1 && strcmp(argv[1], "--measure") == 0);
+
     printf("--- System Init ---\n");
 
-    // 1. Open I2C
-    hI2c = lgI2cOpen(I2C_DEV_NUM, I2C_ADDR, 0);
-    if (hI2c < 0) {
-        fprintf(stderr, "FATAL: Failed to open I2C bus %d. Error: %s\n", I2C_DEV_NUM, lguErrorText(hI2c));
+    // Priorities / CPUs / mlockall from PANEL_RT, before any thread exists
+    if (rt_config_load(&rt) < 0) return 1;
+
+    // Alert, poller and consumer threads log through per-thread rings
+    log_start(stdout);
+
+    // 1. Open I2C + GPIO (chip found by label)
+    int want = PANEL_HW_I2C | PANEL_HW_GPIO;
+    if (panel_hw_open(&hw, want, 0) != want) {
+        fprintf(stderr, "FATAL: Could not open the I2C bus / GPIO chip.\n");
+        panel_hw_close(&hw);
         return 1;
     }
-    printf("I2C Bus Opened. Handle: %d\n", hI2c);
+    printf("I2C Bus Opened. GPIO Chip %d Opened.\n", hw.gpio_chip);
 
-    // 2. Open GPIO
-    hGpio = lgGpiochipOpen(GPIO_CHIP);
-    if (hGpio < 0) {
-        fprintf(stderr, "FATAL: Failed to open GPIO Chip %d. Error: %s\n", GPIO_CHIP, lguErrorText(hGpio));
-        lgI2cClose(hI2c);
+    // 2. Expander inputs (NULL = BUTTON_PANEL_ADDR)
+    if (button_panel_open(&panel, hw.i2c_fd, NULL, 0) < 0) {
+        fprintf(stderr, "FATAL: Check I2C wiring/address.\n");
+        panel_hw_close(&hw);
         return 1;
     }
-    printf("GPIO Chip Opened. Handle: %d\n", hGpio);
 
     // 3. Configure Internal Pull-Up for Interrupt Pin
     printf("Configuring GPIO %d as Input with Pull-Up...\n", GPIO_INT_PIN);
-    lgGpioClaimInput(hGpio, LG_SET_PULL_UP, GPIO_INT_PIN);
+    lgGpioClaimInput(hw.gpio, LG_SET_PULL_UP, GPIO_INT_PIN);
 
     // 4. Initial State Check
     printf("Performing initial state read...\n");
     unsigned char init_data[2];
     if (read_pca9555_inputs(init_data) == 0) {
-        last_state[0] = init_data[0];
-        last_state[1] = init_data[1];
+        init_state[0] = last_data[0] = init_data[0];
+        init_state[1] = last_data[1] = init_data[1];
         printf("Initial State: 0x%02X 0x%02X\n", init_data[0], init_data[1]);
     } else {
         fprintf(stderr, "WARNING: Initial read failed. Check I2C wiring/address.\n");
     }
 
-    // 5. Attach Interrupt
+    // 5. Start the consumer before any interrupt can queue a record
+    button_ring_init(&ring);
+    pthread_t consumer;
+    if (pthread_create(&consumer, NULL, consumer_thread, NULL) != 0) {
+        fprintf(stderr, "FATAL: Could not start the consumer thread.\n");
+        return 1;
+    }
+    sem_init(&poll_start, 0, 0);
+    pthread_t poller;
+    if (pthread_create(&poller, NULL, poller_thread, NULL) != 0) {
+        fprintf(stderr, "FATAL: Could not start the poller thread.\n");
+        return 1;
+    }
+
+    // 6. Attach Interrupt
     printf("Attaching Interrupt (Falling Edge)...\n");
-    status = lgGpioClaimAlert(hGpio, 0, LG_FALLING_EDGE, GPIO_INT_PIN, -1);
+    status = lgGpioClaimAlert(hw.gpio, 0, LG_FALLING_EDGE, GPIO_INT_PIN, -1);
     if (status < 0) {
         fprintf(stderr, "FATAL: Claim Alert failed. Error: %s\n", lguErrorText(status));
         return 1;
     }
     
-    lgGpioSetAlertsFunc(hGpio, GPIO_INT_PIN, on_interrupt, NULL);
+    lgGpioSetAlertsFunc(hw.gpio, GPIO_INT_PIN, on_interrupt, NULL);
 
     printf("--- System Ready. Press Buttons. ---\n");
+    if (measure) printf("Measuring interrupt-to-data latency (combined vs split reads).\n");
 
     // Keep alive loop
     while (1) {
@@ -154,7 +390,6 @@ int main() {
         sleep(10); 
     }
 
-    lgGpiochipClose(hGpio);
-    lgI2cClose(hI2c);
+    panel_hw_close(&hw);
     return 0;
 }
\ No newline at end of file
@@ -11,7 +11,7 @@
  * - liblgpio-dev (The modern replacement for pigpio on Pi 5)
  * Install with: sudo apt-get install liblgpio-dev
  * * * Compilation:
- * gcc -o bin/buzzer_interactive_single_pins buzzer/buzzer_interactive_single_pins.c -llgpio
+ * gcc -pthread -o bin/buzzer_interactive_single_pins buzzer/buzzer_interactive_single_pins.c -Lbin -lpanel -llgpio
  * * * Execution:
  * sudo ./bin/buzzer_interactive_single_pins
  */
@@ -24,29 +24,23 @@
 #include <stdbool.h>
 #include <unistd.h> // For usleep, read
 #include <signal.h>
-#include <assert.h>
+#include <stdint.h>
 #include <termios.h> // For raw mode input
-#include <lgpio.h>
+#include "../lib/panel_hw.h"
+#include "../lib/tone.h"
 
-// --- GPIO Pin Definitions ---
-// Note: On Raspberry Pi 5, the 40-pin header is typically controlled 
-// by GPIO Chip 4. Use `gpiodetect` to verify if unsure.
-#define GPIO_CHIP   4
-
-#define PIN_CLOCK   18  // PWM Pin
-#define PIN_VOL_0   23
-#define PIN_VOL_1   24
-#define PIN_VOL_2   25
-#define PIN_VOL_3   22
+// --- Hardware ---
+// GPIO chip, buzzer pins and PWM channel are the same for every program:
+// see lib/panel_hw.h and lib/tone.h.
 
 // Constants
-#define PWM_DUTY_50 50.0 // Duty cycle in percentage for lgpio
 #define FREQ_STEP   50   // Hz step for arrows
 #define MIN_FREQ    100
 #define MAX_FREQ    2000
 
-// Global handle for the GPIO chip
-int hGpio = -1;
+// Hardware handles, opened once by setup_gpio(), and the buzzer on them
+panel_hw_t hw;
+tone_t tone;
 
 // Terminal settings storage
 struct termios orig_termios;
@@ -85,63 +79,45 @@ void enable_raw_mode() {
 }
 
 /**
- * Sets the 4-bit volume pins.
+ * Sets the 4-bit volume pins, all four in one lgGroupWrite.
  */
-void set_volume(bool vol_pin_3, bool vol_pin_2, bool vol_pin_1, bool vol_pin_0) {  
-    lgGpioWrite(hGpio, PIN_VOL_3, vol_pin_3);
-    lgGpioWrite(hGpio, PIN_VOL_2, vol_pin_2);
-    lgGpioWrite(hGpio, PIN_VOL_1, vol_pin_1);
-    lgGpioWrite(hGpio, PIN_VOL_0, vol_pin_0);
+void set_volume(bool vol_pin_3, bool vol_pin_2, bool vol_pin_1, bool vol_pin_0) {
+    uint64_t bits = (uint64_t)vol_pin_3 << 3 | vol_pin_2 << 2 | vol_pin_1 << 1 | vol_pin_0;
+    tone_set_volume_bits(&tone, bits);
 }
 
 /**
- * Stops the Clock/Tone signal.
+ * Stops the Clock/Tone signal (no-op if it is already stopped).
  */
 void stop_tone() {
-    lgTxPwm(hGpio, PIN_CLOCK, 0, 0, 0, 0); // 0 Frequency stops it
-    lgGpioWrite(hGpio, PIN_CLOCK, 0);      // Ensure low state
+    tone_stop(&tone);
 }
 
 /**
  * Starts the Clock/Tone signal at a specific frequency.
- * @param frequency_hz Frequency in Hertz
+ * The PWM is only restarted when the frequency actually changes.
+ * @param frequency_hz Frequency in Hertz (0 or less stops it)
  */
 void start_tone(int frequency_hz) {
-    if (frequency_hz <= 0) {
-        stop_tone();
-        return;
-    }
-    lgTxPwm(hGpio, PIN_CLOCK, frequency_hz, PWM_DUTY_50, 0, 0);
+    tone_start(&tone, frequency_hz);
 }
 
 /**
  * Initializes GPIO pins and library.
  */
 int setup_gpio() {
-    // Open the GPIO chip
-    // Try opening chip 4 (Standard Pi 5) if 10 fails, or pass via arg in real scenario
-    hGpio = lgGpiochipOpen(GPIO_CHIP);
-    
-    // Fallback logic could be added here, but sticking to define
-    if (hGpio < 0) {
-        fprintf(stderr, "Failed to open GPIO Chip %d. \n"
-                        "On Pi 5, header pins are usually on Chip 4.\n"
-                        "Check 'gpiodetect' output.\n", GPIO_CHIP);
+    // Open the GPIO chip (found by label, see lib/panel_hw.h)
+    if (!(panel_hw_open(&hw, PANEL_HW_GPIO, 0) & PANEL_HW_GPIO)) {
+        fprintf(stderr, "Check 'gpiodetect' output.\n");
         return -1;
     }
 
-    // Set pin modes to Output
-    int err = 0;
-    err |= lgGpioClaimOutput(hGpio, 0, PIN_CLOCK, 0);
-    err |= lgGpioClaimOutput(hGpio, 0, PIN_VOL_0, 0);
-    err |= lgGpioClaimOutput(hGpio, 0, PIN_VOL_1, 0);
-    err |= lgGpioClaimOutput(hGpio, 0, PIN_VOL_2, 0);
-    err |= lgGpioClaimOutput(hGpio, 0, PIN_VOL_3, 0);
-
-    if (err < 0) {
+    // Claim the clock and volume pins as outputs
+    if (tone_init(&tone, hw.gpio) != 0) {
         fprintf(stderr, "Failed to claim GPIO outputs. Ensure no other process is using them.\n");
         return -1;
     }
+    printf("GPIO chip %d, tone output: %s\n", hw.gpio_chip, buzzer_output_backend_name(&tone.out));
 
     // Initialize with 0 volume and no tone
     set_volume(0, 0, 0, 0);
@@ -236,13 +212,9 @@ int main(void) {
     stop_tone();
     set_volume(0, 0, 0, 0);
     
-    lgGpioFree(hGpio, PIN_CLOCK);
-    lgGpioFree(hGpio, PIN_VOL_0);
-    lgGpioFree(hGpio, PIN_VOL_1);
-    lgGpioFree(hGpio, PIN_VOL_2);
-    lgGpioFree(hGpio, PIN_VOL_3);
-
-    lgGpiochipClose(hGpio);
+    buzzer_output_print_stats(&tone.out, stdout);
+    tone_close(&tone);
+    panel_hw_close(&hw);
     
     return 0;
 }
\ No newline at end of file
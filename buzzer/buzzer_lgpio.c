@@ -11,40 +11,35 @@
  * - liblgpio-dev (The modern replacement for pigpio on Pi 5)
  * Install with: sudo apt-get install liblgpio-dev
  * * * Compilation:
- * gcc -o bin/buzzer_lgpio buzzer/buzzer_lgpio.c -llgpio
+ * gcc -pthread -o bin/buzzer_lgpio buzzer/buzzer_lgpio.c -Lbin -lpanel -llgpio
  * * * Execution:
  * sudo ./bin/buzzer_lgpio
+ * PANEL_RT="tone=60@2,mlock" sudo -E ./bin/buzzer_lgpio   (real-time tone timing, see common/rt_sched.h)
  */
 
-#define _DEFAULT_SOURCE // Required for usleep in modern glibc
 #define _POSIX_C_SOURCE 200809L 
 
 #include <stdio.h>
 #include <stdlib.h>
 #include <stdbool.h>
-#include <unistd.h> // For usleep
 #include <signal.h>
-#include <assert.h>
-#include <lgpio.h>  // Replaces pigpio
+#include <stdint.h>
+#include "../common/rt_sched.h"
+#include "../lib/panel_hw.h"
+#include "../lib/tone.h"
+#include "tone_sequencer.h"
 
-// --- GPIO Pin Definitions ---
-// Note: On Raspberry Pi 5, the 40-pin header is typically controlled 
-// by GPIO Chip 4. Use `gpiodetect` to verify if unsure.
-#define GPIO_CHIP   10 
-
-#define PIN_CLOCK   18  // PWM Pin
-#define PIN_VOL_0   23
-#define PIN_VOL_1   24
-#define PIN_VOL_2   25
-#define PIN_VOL_3   22
+// --- Hardware ---
+// GPIO chip, buzzer pins and PWM channel are the same for every program:
+// see lib/panel_hw.h and lib/tone.h.
 
 // Constants
-#define PWM_DUTY_50 50.0 // Duty cycle in percentage for lgpio
-#define MAX_VOLUME  8
+#define MAX_VOLUME  BUZZER_MAX_VOLUME
 #define MIN_VOLUME  0
 
-// Global handle for the GPIO chip
-int hGpio = -1;
+// Hardware handles, opened once by setup_gpio(), and the buzzer on them
+panel_hw_t hw;
+tone_t tone;
 
 // Global flag for clean exit on Ctrl+C
 volatile int keep_running = 1;
@@ -68,90 +63,44 @@ void set_volume(int volume) {
     if (temp_volume > MAX_VOLUME) temp_volume = MAX_VOLUME;
     if (temp_volume < MIN_VOLUME) temp_volume = MIN_VOLUME;
 
-    bool vol_pin_3 = 0;
-    bool vol_pin_2 = 0;
-    bool vol_pin_1 = 0;
-    bool vol_pin_0 = 0;
-
-    // Logic remains the same, just swapping gpioWrite for lgGpioWrite
-    // Note: lgGpioWrite takes the chip handle as the first argument
-    
-    if (temp_volume >= 4) {
-        temp_volume = temp_volume - 4;
-        vol_pin_3 = 1;
-    }
-    if (temp_volume >= 2) {
-        temp_volume = temp_volume - 2;
-        vol_pin_2 = 1;
-    }
-    assert(temp_volume >= 0 && temp_volume <= 2);
-    if (temp_volume == 2) {
-        vol_pin_1 = 1;
-    }
-    else {
-        if (temp_volume == 1) {
-            vol_pin_0 = 1;
-        }
-    }
-    lgGpioWrite(hGpio, PIN_VOL_3, vol_pin_3);
-    lgGpioWrite(hGpio, PIN_VOL_2, vol_pin_2);
-    lgGpioWrite(hGpio, PIN_VOL_1, vol_pin_1);
-    lgGpioWrite(hGpio, PIN_VOL_0, vol_pin_0);
+    // All four pins switch together: no intermediate volume codes between writes
+    tone_set_volume(&tone, temp_volume);
 
     printf("Volume set to: %d\n", volume);
 }
 
 /**
- * Stops the Clock/Tone signal.
+ * Stops the Clock/Tone signal (no-op if it is already stopped).
  */
 void stop_tone() {
-    lgTxPwm(hGpio, PIN_CLOCK, 0, 0, 0, 0); // 0 Frequency stops it
-    lgGpioWrite(hGpio, PIN_CLOCK, 0);      // Ensure low state
+    tone_stop(&tone);
 }
 
 /**
  * Starts the Clock/Tone signal at a specific frequency.
- * Uses lgTxPwm for software/hardware timed PWM.
- * @param frequency_hz Frequency in Hertz
+ * The PWM is only restarted when the frequency actually changes.
+ * @param frequency_hz Frequency in Hertz (0 or less stops it)
  */
 void start_tone(int frequency_hz) {
-    if (frequency_hz <= 0) {
-        // Stop PWM
-        stop_tone();
-        return;
-    }
-
-    // lgTxPwm(handle, gpio, freq, duty_cycle_percent, pulse_width, pulse_cycles)
-    // We use frequency and duty cycle mode.
-    lgTxPwm(hGpio, PIN_CLOCK, frequency_hz, PWM_DUTY_50, 0, 0);
+    tone_start(&tone, frequency_hz);
 }
 
 /**
  * Initializes GPIO pins and library.
  */
 int setup_gpio() {
-    // Open the GPIO chip
-    hGpio = lgGpiochipOpen(GPIO_CHIP);
-    if (hGpio < 0) {
-        fprintf(stderr, "Failed to open GPIO Chip %d. \n"
-                        "On Pi 5, header pins are usually on Chip 4.\n"
-                        "Check 'gpiodetect' output.\n", GPIO_CHIP);
+    // Open the GPIO chip (found by label, see lib/panel_hw.h)
+    if (!(panel_hw_open(&hw, PANEL_HW_GPIO, 0) & PANEL_HW_GPIO)) {
+        fprintf(stderr, "Check 'gpiodetect' output.\n");
         return -1;
     }
 
-    // Set pin modes to Output
-    int err = 0;
-    // We OR the errors to check if any failed
-    err |= lgGpioClaimOutput(hGpio, 0, PIN_CLOCK, 0);
-    err |= lgGpioClaimOutput(hGpio, 0, PIN_VOL_0, 0);
-    err |= lgGpioClaimOutput(hGpio, 0, PIN_VOL_1, 0);
-    err |= lgGpioClaimOutput(hGpio, 0, PIN_VOL_2, 0);
-    err |= lgGpioClaimOutput(hGpio, 0, PIN_VOL_3, 0);
-
-    if (err < 0) {
+    // Claim the clock and volume pins as outputs
+    if (tone_init(&tone, hw.gpio) != 0) {
         fprintf(stderr, "Failed to claim GPIO outputs. Ensure no other process is using them.\n");
         return -1;
     }
+    printf("GPIO chip %d, tone output: %s\n", hw.gpio_chip, buzzer_output_backend_name(&tone.out));
 
     // Initialize with MIN_VOLUME volume and no tone
     set_volume(MIN_VOLUME);
@@ -160,70 +109,78 @@ int setup_gpio() {
     return 0;
 }
 
+// --- Demo melodies: {frequency Hz, volume, duration ms} ---
+static const tone_step_t RAMP[] = {
+    {440, 0, 1000}, {440, 1, 1000}, {440, 2, 1000}, {440, 3, 1000}, {440, 4, 1000},
+    {440, 5, 1000}, {440, 6, 1000}, {440, 7, 1000}, {440, 8, 1000},
+    {440, 8, 1000}, // Hold the top for another second
+};
+
+static const tone_step_t SWEEP[] = { // C Major at max volume
+    {261, MAX_VOLUME, 500}, {293, MAX_VOLUME, 500}, {329, MAX_VOLUME, 500}, {349, MAX_VOLUME, 500},
+    {392, MAX_VOLUME, 500}, {440, MAX_VOLUME, 500}, {493, MAX_VOLUME, 500}, {523, MAX_VOLUME, 500},
+};
+
+static const tone_step_t SIREN[] = {
+    {880, MAX_VOLUME, 300}, {440, MAX_VOLUME / 2, 300},
+};
+
+/**
+ * Waits until the sequencer has played everything queued, or Ctrl+C.
+ */
+void wait_for_melody(tone_seq_t *seq) {
+    while (keep_running && tone_seq_wait(seq, 100) != 0);
+}
+
 int main(void) {
     signal(SIGINT, signal_handler);
 
+    rt_cfg_t rt;
+    if (rt_config_load(&rt) < 0) return 1;
+
     printf("Initializing GPIO (lgpio) for Raspberry Pi 5...\n");
     if (setup_gpio() != 0) {
         return 1;
     }
 
+    // The sequencer thread times the notes: it takes the "tone" role from PANEL_RT
+    tone_seq_t seq;
+    if (tone_seq_start(&seq, &tone.out) != 0) {
+        return 1;
+    }
+    rt_apply(&rt, RT_ROLE_TONE, seq.thread, "tone sequencer");
+
     printf("System Ready. Press Ctrl+C to exit.\n");
 
     // --- Demo Sequence ---
-    
+    // Played by the sequencer thread; this one only waits for each part to end
+
     // 1. Ramp up volume at 440Hz
     printf("Test 1: Ramping Volume Up at 440Hz\n");
-    start_tone(440);
-    
-    for (int v = MIN_VOLUME; v <= MAX_VOLUME; v++) {
-        if (!keep_running) break;
-        set_volume(v);
-        usleep(1000000); // 1 second
-    }
-
-    if (keep_running) {
-        usleep(1000000); // Wait 1 second
-    }
+    tone_seq_play(&seq, RAMP, sizeof(RAMP) / sizeof(RAMP[0]), 0);
+    wait_for_melody(&seq);
 
     // 2. Frequency Sweep
     printf("Test 2: Frequency Sweep at Max Volume\n");
-    set_volume(MAX_VOLUME); // Use max volume for melody
-    
-    int notes[] = {261, 293, 329, 349, 392, 440, 493, 523}; // C Major
-    for (int i = 0; i < 8; i++) {
-        if (!keep_running) break;
-        printf("Frequency: %d Hz\n", notes[i]);
-        start_tone(notes[i]);
-        usleep(500000); // 500ms
-    }
+    if (keep_running) tone_seq_play(&seq, SWEEP, sizeof(SWEEP) / sizeof(SWEEP[0]), 0);
+    wait_for_melody(&seq);
 
-    // 3. Siren Effect
+    // 3. Siren Effect, until Ctrl+C
     printf("Test 3: Siren Effect\n");
-    while (keep_running) {
-        set_volume(MAX_VOLUME);
-        start_tone(880);
-        usleep(300000); 
-        if (!keep_running) break;
-
-        set_volume(MAX_VOLUME / 2);
-        start_tone(440);
-        usleep(300000);
-    }
+    if (keep_running) tone_seq_play(&seq, SIREN, sizeof(SIREN) / sizeof(SIREN[0]), TONE_SEQ_LOOP);
+    wait_for_melody(&seq);
 
     // --- Cleanup ---
     printf("\nShutting down...\n");
+    tone_seq_print_stats(&seq, stdout);
+    tone_seq_stop(&seq);
     stop_tone();
     set_volume(MIN_VOLUME);
     
     // Free the GPIO pins
-    lgGpioFree(hGpio, PIN_CLOCK);
-    lgGpioFree(hGpio, PIN_VOL_0);
-    lgGpioFree(hGpio, PIN_VOL_1);
-    lgGpioFree(hGpio, PIN_VOL_2);
-    lgGpioFree(hGpio, PIN_VOL_3);
-
-    lgGpiochipClose(hGpio);
+    buzzer_output_print_stats(&tone.out, stdout);
+    tone_close(&tone);
+    panel_hw_close(&hw);
     printf("Done.\n");
 
     return 0;
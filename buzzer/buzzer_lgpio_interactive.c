@@ -11,7 +11,7 @@
  * - liblgpio-dev (The modern replacement for pigpio on Pi 5)
  * Install with: sudo apt-get install liblgpio-dev
  * * * Compilation:
- * gcc -o bin/buzzer_lgpio_interactive buzzer/buzzer_lgpio_interactive.c -llgpio
+ * gcc -pthread -o bin/buzzer_lgpio_interactive buzzer/buzzer_lgpio_interactive.c -Lbin -lpanel -llgpio
  * * * Execution:
  * sudo ./bin/buzzer_lgpio_interactive
  */
@@ -24,31 +24,25 @@
 #include <stdbool.h>
 #include <unistd.h> // For usleep, read
 #include <signal.h>
-#include <assert.h>
+#include <stdint.h>
 #include <termios.h> // For raw mode input
-#include <lgpio.h>  // Replaces pigpio
+#include "../lib/panel_hw.h"
+#include "../lib/tone.h"
 
-// --- GPIO Pin Definitions ---
-// Note: On Raspberry Pi 5, the 40-pin header is typically controlled 
-// by GPIO Chip 4. Use `gpiodetect` to verify if unsure.
-#define GPIO_CHIP   10 
-
-#define PIN_CLOCK   18  // PWM Pin
-#define PIN_VOL_0   23
-#define PIN_VOL_1   24
-#define PIN_VOL_2   25
-#define PIN_VOL_3   22
+// --- Hardware ---
+// GPIO chip, buzzer pins and PWM channel are the same for every program:
+// see lib/panel_hw.h and lib/tone.h.
 
 // Constants
-#define PWM_DUTY_50 50.0 // Duty cycle in percentage for lgpio
-#define MAX_VOLUME  8
+#define MAX_VOLUME  BUZZER_MAX_VOLUME
 #define MIN_VOLUME  0
 #define FREQ_STEP   50   // Hz step for arrows
 #define MIN_FREQ    100
 #define MAX_FREQ    2000
 
-// Global handle for the GPIO chip
-int hGpio = -1;
+// Hardware handles, opened once by setup_gpio(), and the buzzer on them
+panel_hw_t hw;
+tone_t tone;
 
 // Terminal settings storage
 struct termios orig_termios;
@@ -96,61 +90,25 @@ void set_volume(int volume) {
     if (temp_volume > MAX_VOLUME) temp_volume = MAX_VOLUME;
     if (temp_volume < MIN_VOLUME) temp_volume = MIN_VOLUME;
 
-    bool vol_pin_3 = 0;
-    bool vol_pin_2 = 0;
-    bool vol_pin_1 = 0;
-    bool vol_pin_0 = 0;
-
-    // Logic remains the same, just swapping gpioWrite for lgGpioWrite
-    // Note: lgGpioWrite takes the chip handle as the first argument
-    
-    if (temp_volume >= 4) {
-        temp_volume = temp_volume - 4;
-        vol_pin_3 = 1;
-    }
-    if (temp_volume >= 2) {
-        temp_volume = temp_volume - 2;
-        vol_pin_2 = 1;
-    }
-    assert(temp_volume >= 0 && temp_volume <= 2);
-    if (temp_volume == 2) {
-        vol_pin_1 = 1;
-    }
-    else {
-        if (temp_volume == 1) {
-            vol_pin_0 = 1;
-        }
-    }
-    lgGpioWrite(hGpio, PIN_VOL_3, vol_pin_3);
-    lgGpioWrite(hGpio, PIN_VOL_2, vol_pin_2);
-    lgGpioWrite(hGpio, PIN_VOL_1, vol_pin_1);
-    lgGpioWrite(hGpio, PIN_VOL_0, vol_pin_0);
+    // All four pins switch together: no intermediate volume codes between writes
+    tone_set_volume(&tone, temp_volume);
     // printf("Volume set to: %d\n", volume);
 }
 
 /**
- * Stops the Clock/Tone signal.
+ * Stops the Clock/Tone signal (no-op if it is already stopped).
  */
 void stop_tone() {
-    lgTxPwm(hGpio, PIN_CLOCK, 0, 0, 0, 0); // 0 Frequency stops it
-    lgGpioWrite(hGpio, PIN_CLOCK, 0);      // Ensure low state
+    tone_stop(&tone);
 }
 
 /**
  * Starts the Clock/Tone signal at a specific frequency.
- * Uses lgTxPwm for software/hardware timed PWM.
- * @param frequency_hz Frequency in Hertz
+ * The PWM is only restarted when the frequency actually changes.
+ * @param frequency_hz Frequency in Hertz (0 or less stops it)
  */
 void start_tone(int frequency_hz) {
-    if (frequency_hz <= 0) {
-        // Stop PWM
-        stop_tone();
-        return;
-    }
-
-    // lgTxPwm(handle, gpio, freq, duty_cycle_percent, pulse_width, pulse_cycles)
-    // We use frequency and duty cycle mode.
-    lgTxPwm(hGpio, PIN_CLOCK, frequency_hz, PWM_DUTY_50, 0, 0);
+    tone_start(&tone, frequency_hz);
 }
 
 
@@ -158,28 +116,18 @@ void start_tone(int frequency_hz) {
  * Initializes GPIO pins and library.
  */
 int setup_gpio() {
-    // Open the GPIO chip
-    hGpio = lgGpiochipOpen(GPIO_CHIP);
-    if (hGpio < 0) {
-        fprintf(stderr, "Failed to open GPIO Chip %d. \n"
-                        "On Pi 5, header pins are usually on Chip 4.\n"
-                        "Check 'gpiodetect' output.\n", GPIO_CHIP);
+    // Open the GPIO chip (found by label, see lib/panel_hw.h)
+    if (!(panel_hw_open(&hw, PANEL_HW_GPIO, 0) & PANEL_HW_GPIO)) {
+        fprintf(stderr, "Check 'gpiodetect' output.\n");
         return -1;
     }
 
-    // Set pin modes to Output
-    int err = 0;
-    // We OR the errors to check if any failed
-    err |= lgGpioClaimOutput(hGpio, 0, PIN_CLOCK, 0);
-    err |= lgGpioClaimOutput(hGpio, 0, PIN_VOL_0, 0);
-    err |= lgGpioClaimOutput(hGpio, 0, PIN_VOL_1, 0);
-    err |= lgGpioClaimOutput(hGpio, 0, PIN_VOL_2, 0);
-    err |= lgGpioClaimOutput(hGpio, 0, PIN_VOL_3, 0);
-
-    if (err < 0) {
+    // Claim the clock and volume pins as outputs
+    if (tone_init(&tone, hw.gpio) != 0) {
         fprintf(stderr, "Failed to claim GPIO outputs. Ensure no other process is using them.\n");
         return -1;
     }
+    printf("GPIO chip %d, tone output: %s\n", hw.gpio_chip, buzzer_output_backend_name(&tone.out));
 
     // Initialize with 0 volume and no tone
     set_volume(0);
@@ -262,13 +210,9 @@ int main(void) {
     set_volume(0);
     
     // Free the GPIO pins
-    lgGpioFree(hGpio, PIN_CLOCK);
-    lgGpioFree(hGpio, PIN_VOL_0);
-    lgGpioFree(hGpio, PIN_VOL_1);
-    lgGpioFree(hGpio, PIN_VOL_2);
-    lgGpioFree(hGpio, PIN_VOL_3);
-
-    lgGpiochipClose(hGpio);
+    buzzer_output_print_stats(&tone.out, stdout);
+    tone_close(&tone);
+    panel_hw_close(&hw);
     
     // The message "Terminal mode restored" will print automatically via atexit
     return 0;
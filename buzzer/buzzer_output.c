@@ -0,0 +1,94 @@
+#include <lgpio.h>
+#include "buzzer_output.h"
+
+const uint8_t BUZZER_VOLUME_MASKS[BUZZER_MAX_VOLUME + 1] = {
+    0x0, 0x1, 0x4, 0x5, 0x8, 0x9, 0xC, 0xD, 0xE
+};
+
+void buzzer_output_init(buzzer_output_t *out, int handle, int clock_pin, int vol_group, uint64_t vol_mask) {
+    out->handle = handle;
+    out->clock_pin = clock_pin;
+    out->vol_group = vol_group;
+    out->vol_mask = vol_mask;
+    out->backend = BUZZER_TONE_LGPIO;
+    out->tone_writes = out->tone_skipped = 0;
+    out->volume_writes = out->volume_skipped = 0;
+    buzzer_output_invalidate(out);
+}
+
+int buzzer_output_open_hw_pwm(buzzer_output_t *out, int chip, int channel) {
+    if (pwm_sysfs_open(&out->pwm, chip, channel) < 0) return -1;
+    out->backend = BUZZER_TONE_HW_PWM;
+    out->freq_hz = -1;
+    return 0;
+}
+
+void buzzer_output_close(buzzer_output_t *out) {
+    buzzer_output_tone(out, 0, 0);
+    if (out->backend == BUZZER_TONE_HW_PWM) pwm_sysfs_close(&out->pwm);
+}
+
+const char *buzzer_output_backend_name(const buzzer_output_t *out) {
+    return out->backend == BUZZER_TONE_HW_PWM ? "hardware PWM" : "lgTxPwm";
+}
+
+void buzzer_output_invalidate(buzzer_output_t *out) {
+    out->freq_hz = -1;
+    out->duty = -1;
+    out->vol_bits = -1;
+}
+
+int buzzer_output_tone(buzzer_output_t *out, int frequency_hz, float duty) {
+    if (frequency_hz < 0) frequency_hz = 0;
+
+    // A stopped tone is the same whatever the duty was
+    if (frequency_hz == out->freq_hz && (frequency_hz == 0 || duty == out->duty)) {
+        out->tone_skipped++;
+        return 0;
+    }
+
+    int err;
+    if (out->backend == BUZZER_TONE_HW_PWM) {
+        err = pwm_sysfs_set(&out->pwm, frequency_hz, duty);
+    } else if (frequency_hz == 0) {
+        err = lgTxPwm(out->handle, out->clock_pin, 0, 0, 0, 0); // 0 Frequency stops it
+        if (err >= 0) err = lgGpioWrite(out->handle, out->clock_pin, 0); // Ensure low state
+    } else {
+        // lgTxPwm(handle, gpio, freq, duty_cycle_percent, pulse_width, pulse_cycles)
+        err = lgTxPwm(out->handle, out->clock_pin, frequency_hz, duty, 0, 0);
+    }
+    out->tone_writes++;
+
+    if (err < 0) {
+        out->freq_hz = -1;
+        return err;
+    }
+    out->freq_hz = frequency_hz;
+    out->duty = duty;
+    return 0;
+}
+
+int buzzer_output_volume(buzzer_output_t *out, uint64_t bits) {
+    bits &= out->vol_mask;
+    if ((int64_t)bits == out->vol_bits) {
+        out->volume_skipped++;
+        return 0;
+    }
+
+    int err = lgGroupWrite(out->handle, out->vol_group, bits, out->vol_mask);
+    out->volume_writes++;
+    out->vol_bits = err < 0 ? -1 : (int64_t)bits;
+    return err < 0 ? err : 0;
+}
+
+int buzzer_output_level(buzzer_output_t *out, int level) {
+    if (level > BUZZER_MAX_VOLUME) level = BUZZER_MAX_VOLUME;
+    if (level < 0) level = 0;
+    return buzzer_output_volume(out, BUZZER_VOLUME_MASKS[level]);
+}
+
+void buzzer_output_print_stats(const buzzer_output_t *out, FILE *f) {
+    fprintf(f, "Buzzer output: tone %llu writes, %llu skipped; volume %llu writes, %llu skipped\n",
+            (unsigned long long)out->tone_writes, (unsigned long long)out->tone_skipped,
+            (unsigned long long)out->volume_writes, (unsigned long long)out->volume_skipped);
+}
@@ -0,0 +1,112 @@
+#ifndef BUZZER_OUTPUT_H
+#define BUZZER_OUTPUT_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include "pwm_sysfs.h"
+
+/**
+ * Output-state cache for the buzzer pins.
+ *
+ * Every lgTxPwm call restarts the PWM (a syscall and usually a phase glitch
+ * you can hear), so the programs no longer call lgpio directly. They go through
+ * buzzer_output_tone() / buzzer_output_volume(), which compare the request with
+ * what was last applied and only touch the hardware for fields that changed.
+ * The counters show how many calls that saved.
+ *
+ * Nothing is cached before the first call: that one always reaches the pins.
+ * A failed lgpio call forgets the cached field, so the next request retries it.
+ *
+ * The tone comes from one of two backends with the same calls:
+ * - hardware PWM (RP1 pwmchip through sysfs, see pwm_sysfs.h) when
+ *   buzzer_output_open_hw_pwm() succeeds: jitter-free, no CPU
+ * - lgTxPwm otherwise: timed by lgpio's thread, needs the clock pin claimed as an output
+ */
+
+// Default hardware PWM channel for GPIO 18 on the Pi 5 (RP1 PWM0 channel 2)
+#define BUZZER_PWM_CHIP     0
+#define BUZZER_PWM_CHANNEL  2
+
+typedef enum {
+    BUZZER_TONE_LGPIO,
+    BUZZER_TONE_HW_PWM
+} buzzer_tone_backend_t;
+
+typedef struct {
+    int handle;         // lgpio chip handle
+    int clock_pin;      // PWM tone output
+    int vol_group;      // First pin of the volume group (see lgGroupClaimOutput)
+    uint64_t vol_mask;  // Group bits that are volume pins
+    buzzer_tone_backend_t backend;
+    pwm_sysfs_t pwm;    // BUZZER_TONE_HW_PWM only
+
+    // Last applied state, -1 = unknown
+    int freq_hz;
+    float duty;
+    int64_t vol_bits;
+
+    // Stats
+    uint64_t tone_writes;
+    uint64_t tone_skipped;
+    uint64_t volume_writes;
+    uint64_t volume_skipped;
+} buzzer_output_t;
+
+/**
+ * Sets up the cache for pins already claimed on 'handle', with the lgTxPwm backend.
+ * 'vol_mask' covers the group's pins (0xF for four volume pins).
+ */
+void buzzer_output_init(buzzer_output_t *out, int handle, int clock_pin, int vol_group, uint64_t vol_mask);
+
+/**
+ * Switches the tone to hardware PWM channel 'channel' of pwmchip'chip'.
+ * Returns 0, or -1 (and stays on lgTxPwm) if the channel isn't there.
+ * With hardware PWM the clock pin must not be claimed through lgpio, as that
+ * would take it away from the PWM function.
+ */
+int buzzer_output_open_hw_pwm(buzzer_output_t *out, int chip, int channel);
+
+/**
+ * Stops the tone and releases the hardware PWM channel, if one is open.
+ */
+void buzzer_output_close(buzzer_output_t *out);
+
+/**
+ * "hardware PWM" or "lgTxPwm", for start-up messages.
+ */
+const char *buzzer_output_backend_name(const buzzer_output_t *out);
+
+/**
+ * Plays 'frequency_hz' at 'duty' percent; 0 or less stops the tone and drives the
+ * clock pin low. Returns 0 or the lgpio error.
+ */
+int buzzer_output_tone(buzzer_output_t *out, int frequency_hz, float duty);
+
+/**
+ * Writes the volume group bits in one lgGroupWrite. Returns 0 or the lgpio error.
+ */
+int buzzer_output_volume(buzzer_output_t *out, uint64_t bits);
+
+/**
+ * Volume levels 0-8 as group bits (bit n = n-th pin of the group, PIN_VOL_0 first).
+ * Pin 3 counts 4, pin 2 counts 2, then pin 1 counts 2 or pin 0 counts 1 (never both).
+ */
+#define BUZZER_MAX_VOLUME 8
+extern const uint8_t BUZZER_VOLUME_MASKS[BUZZER_MAX_VOLUME + 1];
+
+/**
+ * Sets volume 0-8 (clamped) through BUZZER_VOLUME_MASKS. Returns 0 or the lgpio error.
+ */
+int buzzer_output_level(buzzer_output_t *out, int level);
+
+/**
+ * Forgets the cached state, e.g. after something else has driven the pins.
+ */
+void buzzer_output_invalidate(buzzer_output_t *out);
+
+/**
+ * Prints the write / skip counters.
+ */
+void buzzer_output_print_stats(const buzzer_output_t *out, FILE *f);
+
+#endif
@@ -0,0 +1,133 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <time.h>
+#include <unistd.h>
+#include "pwm_sysfs.h"
+
+static int write_str(int fd, const char *str) {
+    size_t len = strlen(str);
+    return pwrite(fd, str, len, 0) == (ssize_t)len ? 0 : -1;
+}
+
+static int write_u64(int fd, uint64_t value) {
+    char buf[24];
+    snprintf(buf, sizeof(buf), "%llu", (unsigned long long)value);
+    return write_str(fd, buf);
+}
+
+static int write_file(const char *path, const char *str) {
+    int fd = open(path, O_WRONLY | O_CLOEXEC);
+    if (fd < 0) return -1;
+    int ret = write_str(fd, str);
+    close(fd);
+    return ret;
+}
+
+static int open_attr(const pwm_sysfs_t *pwm, const char *name) {
+    char path[96];
+    snprintf(path, sizeof(path), "/sys/class/pwm/pwmchip%d/pwm%d/%s", pwm->chip, pwm->channel, name);
+    return open(path, O_WRONLY | O_CLOEXEC);
+}
+
+int pwm_sysfs_open(pwm_sysfs_t *pwm, int chip, int channel) {
+    char path[96], num[16];
+    memset(pwm, 0, sizeof(*pwm));
+    pwm->chip = chip;
+    pwm->channel = channel;
+    pwm->period_fd = pwm->duty_fd = pwm->enable_fd = -1;
+
+    snprintf(path, sizeof(path), "/sys/class/pwm/pwmchip%d/pwm%d", chip, channel);
+    if (access(path, F_OK) != 0) {
+        char export_path[64];
+        snprintf(export_path, sizeof(export_path), "/sys/class/pwm/pwmchip%d/export", chip);
+        snprintf(num, sizeof(num), "%d", channel);
+        if (write_file(export_path, num) == 0) pwm->exported = 1;
+        else if (errno != EBUSY) return -1; // EBUSY: someone else just exported it
+    }
+
+    // udev may still be fixing the permissions of a freshly exported channel
+    for (int tries = 0; tries < 20; tries++) {
+        pwm->period_fd = open_attr(pwm, "period");
+        if (pwm->period_fd >= 0 || (errno != ENOENT && errno != EACCES)) break;
+        struct timespec ts = { 0, 10000000 };
+        nanosleep(&ts, NULL);
+    }
+    pwm->duty_fd = open_attr(pwm, "duty_cycle");
+    pwm->enable_fd = open_attr(pwm, "enable");
+    if (pwm->period_fd < 0 || pwm->duty_fd < 0 || pwm->enable_fd < 0) {
+        pwm_sysfs_close(pwm);
+        return -1;
+    }
+
+    // A channel left configured (e.g. by a run that crashed) may still be sounding and
+    // may hold any duty. Silence it and zero the duty, so that any period is valid next.
+    // The old period is still unknown (period_ns = 0).
+    if (write_str(pwm->enable_fd, "0") < 0 || write_u64(pwm->duty_fd, 0) < 0) {
+        pwm_sysfs_close(pwm);
+        return -1;
+    }
+    return 0;
+}
+
+int pwm_sysfs_set(pwm_sysfs_t *pwm, int frequency_hz, float duty) {
+    if (frequency_hz <= 0) return pwm_sysfs_disable(pwm);
+
+    uint64_t period = 1000000000ULL / (uint64_t)frequency_hz;
+    uint64_t duty_ns = (uint64_t)(period * (duty / 100.0));
+
+    // The kernel rejects duty_cycle > period, so the order depends on the direction
+    int err = 0;
+    if (period != pwm->period_ns) {
+        if (period < pwm->period_ns) {
+            err = write_u64(pwm->duty_fd, duty_ns) < 0 || write_u64(pwm->period_fd, period) < 0;
+        } else {
+            err = write_u64(pwm->period_fd, period) < 0 || write_u64(pwm->duty_fd, duty_ns) < 0;
+        }
+    } else if (duty_ns != pwm->duty_ns) {
+        err = write_u64(pwm->duty_fd, duty_ns) < 0;
+    }
+    if (err) {
+        // The hardware state is unknown. Zero the duty first (then any period is valid)
+        // and retry once. If that fails too, the next call starts from here again.
+        pwm->period_ns = pwm->duty_ns = 0;
+        if (write_u64(pwm->duty_fd, 0) < 0 || write_u64(pwm->period_fd, period) < 0 ||
+            write_u64(pwm->duty_fd, duty_ns) < 0) {
+            return -1;
+        }
+    }
+    pwm->period_ns = period;
+    pwm->duty_ns = duty_ns;
+
+    if (!pwm->enabled) {
+        if (write_str(pwm->enable_fd, "1") < 0) return -1;
+        pwm->enabled = 1;
+    }
+    return 0;
+}
+
+int pwm_sysfs_disable(pwm_sysfs_t *pwm) {
+    if (!pwm->enabled) return 0;
+    if (write_str(pwm->enable_fd, "0") < 0) return -1;
+    pwm->enabled = 0;
+    return 0;
+}
+
+void pwm_sysfs_close(pwm_sysfs_t *pwm) {
+    if (pwm->enable_fd >= 0) pwm_sysfs_disable(pwm);
+    if (pwm->period_fd >= 0) close(pwm->period_fd);
+    if (pwm->duty_fd >= 0) close(pwm->duty_fd);
+    if (pwm->enable_fd >= 0) close(pwm->enable_fd);
+    pwm->period_fd = pwm->duty_fd = pwm->enable_fd = -1;
+
+    if (pwm->exported) {
+        char path[64], num[16];
+        snprintf(path, sizeof(path), "/sys/class/pwm/pwmchip%d/unexport", pwm->chip);
+        snprintf(num, sizeof(num), "%d", pwm->channel);
+        write_file(path, num);
+        pwm->exported = 0;
+    }
+}
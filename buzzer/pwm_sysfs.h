@@ -0,0 +1,50 @@
+#ifndef PWM_SYSFS_H
+#define PWM_SYSFS_H
+
+#include <stdint.h>
+
+/**
+ * Hardware PWM channel through the kernel PWM sysfs interface
+ * (/sys/class/pwm/pwmchipN/pwmM/{period,duty_cycle,enable}).
+ *
+ * On the Pi 5 the RP1 PWM0 block drives GPIO 18 as channel 2 once the pin is
+ * routed to it, e.g. in /boot/firmware/config.txt:
+ *   dtoverlay=pwm,pin=18,func=2
+ * The counter runs in hardware: no CPU time once a frequency is set, and no
+ * jitter from scheduling. Check `ls /sys/class/pwm` for the chip number.
+ */
+typedef struct {
+    int chip;
+    int channel;
+    int period_fd;
+    int duty_fd;
+    int enable_fd;
+    int exported;           // We exported the channel, so unexport it on close
+    uint64_t period_ns;     // Last written values (0 = not yet)
+    uint64_t duty_ns;
+    int enabled;
+} pwm_sysfs_t;
+
+/**
+ * Exports (if needed) and opens pwmchip'chip' channel 'channel', then disables it and
+ * zeroes its duty cycle (an already exported channel may have been left running).
+ * Returns 0, or -1 if there is no such channel or it can't be opened or reset.
+ */
+int pwm_sysfs_open(pwm_sysfs_t *pwm, int chip, int channel);
+
+/**
+ * Sets the frequency and duty (percent) and enables the output. Returns 0 or -1.
+ */
+int pwm_sysfs_set(pwm_sysfs_t *pwm, int frequency_hz, float duty);
+
+/**
+ * Disables the output (the pin idles low). Returns 0 or -1.
+ */
+int pwm_sysfs_disable(pwm_sysfs_t *pwm);
+
+/**
+ * Disables the output, closes the files and unexports the channel if we exported it.
+ */
+void pwm_sysfs_close(pwm_sysfs_t *pwm);
+
+#endif
@@ -0,0 +1,234 @@
+#define _GNU_SOURCE // pthread_condattr_setclock is POSIX, eventfd/timerfd are Linux
+
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+#include <poll.h>
+#include <unistd.h>
+#include <sys/eventfd.h>
+#include <sys/timerfd.h>
+#include "tone_sequencer.h"
+
+static uint64_t now_ns(void) {
+    struct timespec te;
+    clock_gettime(CLOCK_MONOTONIC, &te);
+    return (uint64_t)te.tv_sec * 1000000000ULL + (uint64_t)te.tv_nsec;
+}
+
+static void wake(tone_seq_t *seq) {
+    uint64_t one = 1;
+    if (write(seq->wake_fd, &one, sizeof(one)) < 0) {
+        // Counter overflow only: the thread is awake anyway
+    }
+}
+
+// Called under 'lock' with the current melody finished: next queued one, loop, or idle.
+// Returns 1 if there is a melody to continue with.
+static int next_melody(tone_seq_t *seq) {
+    if (seq->queue_count > 0) {
+        seq->current = seq->queue[seq->queue_head];
+        seq->queue_head = (seq->queue_head + 1) % TONE_QUEUE_LEN;
+        seq->queue_count--;
+        seq->index = 0;
+        return 1;
+    }
+    if (seq->current.flags & TONE_SEQ_LOOP) {
+        seq->index = 0;
+        return 1;
+    }
+    seq->current.steps = NULL;
+    pthread_cond_broadcast(&seq->idle);
+    return 0;
+}
+
+static void *sequencer_thread(void *arg) {
+    tone_seq_t *seq = (tone_seq_t *)arg;
+
+    pthread_mutex_lock(&seq->lock);
+    while (seq->running) {
+        uint64_t now = now_ns();
+        tone_step_t step;
+        int apply = 0, silence = 0;
+
+        if (seq->restart) {
+            seq->restart = 0;
+            seq->index = -1;
+            seq->deadline_ns = now;
+            if (!seq->current.steps) silence = 1;
+        }
+
+        if (seq->current.steps && now >= seq->deadline_ns) {
+            int more = ++seq->index < seq->current.count || next_melody(seq);
+            if (more) {
+                step = seq->current.steps[seq->index];
+                apply = 1;
+                uint64_t late = now - seq->deadline_ns;
+                if (late > seq->max_late_ns) seq->max_late_ns = late;
+                seq->steps_played++;
+
+                // Next switch relative to this deadline, not to 'now': lateness doesn't accumulate
+                seq->deadline_ns += (uint64_t)step.ms * 1000000ULL;
+            } else {
+                silence = 1;
+            }
+        }
+
+        struct itimerspec its = {0};
+        if (seq->current.steps) {
+            its.it_value.tv_sec = seq->deadline_ns / 1000000000ULL;
+            its.it_value.tv_nsec = seq->deadline_ns % 1000000000ULL;
+        }
+        pthread_mutex_unlock(&seq->lock);
+
+        // The pins are only touched here, without the lock: play() never waits for lgpio
+        if (apply) {
+            if (step.volume != TONE_KEEP_VOLUME) buzzer_output_level(seq->out, step.volume);
+            buzzer_output_tone(seq->out, step.freq_hz, TONE_DUTY);
+        } else if (silence) {
+            buzzer_output_tone(seq->out, 0, 0);
+        }
+
+        // A deadline already in the past fires at once
+        timerfd_settime(seq->timer_fd, TFD_TIMER_ABSTIME, &its, NULL);
+
+        struct pollfd fds[2] = {
+            { .fd = seq->timer_fd, .events = POLLIN },
+            { .fd = seq->wake_fd, .events = POLLIN },
+        };
+        if (poll(fds, 2, -1) > 0) {
+            uint64_t count;
+            if (fds[0].revents & POLLIN) while (read(seq->timer_fd, &count, sizeof(count)) < 0 && errno == EINTR);
+            if (fds[1].revents & POLLIN) while (read(seq->wake_fd, &count, sizeof(count)) < 0 && errno == EINTR);
+        }
+        pthread_mutex_lock(&seq->lock);
+    }
+    pthread_mutex_unlock(&seq->lock);
+
+    buzzer_output_tone(seq->out, 0, 0);
+    return NULL;
+}
+
+int tone_seq_start(tone_seq_t *seq, buzzer_output_t *out) {
+    memset(seq, 0, sizeof(*seq));
+    seq->out = out;
+    seq->index = -1;
+
+    seq->timer_fd = timerfd_create(CLOCK_MONOTONIC, TFD_CLOEXEC);
+    seq->wake_fd = eventfd(0, EFD_CLOEXEC);
+    if (seq->timer_fd < 0 || seq->wake_fd < 0) {
+        perror("Tone sequencer: timerfd/eventfd");
+        if (seq->timer_fd >= 0) close(seq->timer_fd);
+        if (seq->wake_fd >= 0) close(seq->wake_fd);
+        return -1;
+    }
+
+    // tone_seq_wait() timeouts on the monotonic clock too
+    pthread_condattr_t attr;
+    pthread_condattr_init(&attr);
+    pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+    pthread_cond_init(&seq->idle, &attr);
+    pthread_condattr_destroy(&attr);
+    pthread_mutex_init(&seq->lock, NULL);
+
+    seq->running = 1;
+    int err = pthread_create(&seq->thread, NULL, sequencer_thread, seq);
+    if (err != 0) {
+        fprintf(stderr, "Tone sequencer: can't start thread: %s\n", strerror(err));
+        seq->running = 0;
+        close(seq->timer_fd);
+        close(seq->wake_fd);
+        return -1;
+    }
+    return 0;
+}
+
+void tone_seq_stop(tone_seq_t *seq) {
+    if (!seq->running) return;
+    pthread_mutex_lock(&seq->lock);
+    seq->running = 0;
+    seq->current.steps = NULL;
+    seq->queue_count = 0;
+    pthread_cond_broadcast(&seq->idle);
+    pthread_mutex_unlock(&seq->lock);
+    wake(seq);
+    pthread_join(seq->thread, NULL);
+
+    close(seq->timer_fd);
+    close(seq->wake_fd);
+    pthread_cond_destroy(&seq->idle);
+    pthread_mutex_destroy(&seq->lock);
+}
+
+int tone_seq_play(tone_seq_t *seq, const tone_step_t *steps, int count, int flags) {
+    if (!steps || count <= 0) return -1;
+    tone_melody_t melody = { steps, count, flags };
+    int ret = 0;
+
+    pthread_mutex_lock(&seq->lock);
+    if (flags & TONE_SEQ_NOW) seq->queue_count = 0;
+
+    if (!seq->current.steps || (flags & TONE_SEQ_NOW)) {
+        seq->current = melody;
+        seq->restart = 1;
+    } else if (seq->queue_count < TONE_QUEUE_LEN) {
+        seq->queue[(seq->queue_head + seq->queue_count) % TONE_QUEUE_LEN] = melody;
+        seq->queue_count++;
+    } else {
+        ret = -1;
+    }
+    pthread_mutex_unlock(&seq->lock);
+
+    if (ret == 0) wake(seq);
+    return ret;
+}
+
+void tone_seq_cancel(tone_seq_t *seq) {
+    pthread_mutex_lock(&seq->lock);
+    seq->current.steps = NULL;
+    seq->queue_count = 0;
+    seq->restart = 1;
+    pthread_cond_broadcast(&seq->idle);
+    pthread_mutex_unlock(&seq->lock);
+    wake(seq);
+}
+
+int tone_seq_busy(tone_seq_t *seq) {
+    pthread_mutex_lock(&seq->lock);
+    int busy = seq->current.steps != NULL || seq->queue_count > 0;
+    pthread_mutex_unlock(&seq->lock);
+    return busy;
+}
+
+int tone_seq_wait(tone_seq_t *seq, int timeout_ms) {
+    struct timespec abs;
+    clock_gettime(CLOCK_MONOTONIC, &abs);
+    if (timeout_ms > 0) {
+        abs.tv_sec += timeout_ms / 1000;
+        abs.tv_nsec += (long)(timeout_ms % 1000) * 1000000L;
+        if (abs.tv_nsec >= 1000000000L) {
+            abs.tv_sec++;
+            abs.tv_nsec -= 1000000000L;
+        }
+    }
+
+    int ret = 0;
+    pthread_mutex_lock(&seq->lock);
+    while (seq->current.steps || seq->queue_count > 0) {
+        if (timeout_ms < 0) {
+            pthread_cond_wait(&seq->idle, &seq->lock);
+        } else if (pthread_cond_timedwait(&seq->idle, &seq->lock, &abs) == ETIMEDOUT) {
+            ret = -1;
+            break;
+        }
+    }
+    pthread_mutex_unlock(&seq->lock);
+    return ret;
+}
+
+void tone_seq_print_stats(tone_seq_t *seq, FILE *f) {
+    pthread_mutex_lock(&seq->lock);
+    fprintf(f, "Tone sequencer: %llu steps, worst switch %.3f ms late\n",
+            (unsigned long long)seq->steps_played, seq->max_late_ns / 1e6);
+    pthread_mutex_unlock(&seq->lock);
+}
@@ -0,0 +1,104 @@
+#ifndef TONE_SEQUENCER_H
+#define TONE_SEQUENCER_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include <pthread.h>
+#include "buzzer_output.h"
+
+/**
+ * Non-blocking tone sequencer.
+ *
+ * A melody is an array of steps. The sequencer thread switches the buzzer at
+ * absolute CLOCK_MONOTONIC deadlines, using a timerfd with TFD_TIMER_ABSTIME.
+ * Each deadline is the previous deadline plus that step's duration, so a late
+ * wakeup delays one switch but never shifts the rest of the melody.
+ * tone_seq_play() only queues the melody and wakes the thread, so it is safe
+ * to call from a button handler or an interrupt callback.
+ *
+ * While it runs, the sequencer thread is the only user of the buzzer_output_t.
+ */
+
+#define TONE_QUEUE_LEN    8     // Melodies waiting behind the current one
+#define TONE_KEEP_VOLUME  0xFF  // Step volume: leave the volume as it is
+#define TONE_DUTY         50.0  // PWM duty cycle in percent
+
+typedef struct {
+    uint16_t freq_hz;   // 0 = rest (silence)
+    uint8_t volume;     // 0 - BUZZER_MAX_VOLUME, or TONE_KEEP_VOLUME
+    uint16_t ms;        // How long the step lasts
+} tone_step_t;
+
+// tone_seq_play() flags
+#define TONE_SEQ_LOOP 0x1   // Repeat until cancelled or until another melody is queued
+#define TONE_SEQ_NOW  0x2   // Drop the current melody and the queue, start right away
+
+typedef struct {
+    const tone_step_t *steps;
+    int count;
+    int flags;
+} tone_melody_t;
+
+typedef struct {
+    buzzer_output_t *out;
+    pthread_t thread;
+    pthread_mutex_t lock;
+    pthread_cond_t idle;
+    int timer_fd;
+    int wake_fd;            // eventfd: play / cancel / stop
+    int running;
+
+    // Under 'lock'
+    tone_melody_t current;  // steps == NULL: idle
+    int index;              // Step now sounding, -1 = before the first one
+    int restart;            // Start 'current' (or go silent) on the next wakeup
+    uint64_t deadline_ns;   // End of the step now sounding
+    tone_melody_t queue[TONE_QUEUE_LEN];
+    int queue_head;
+    int queue_count;
+
+    // Stats
+    uint64_t steps_played;
+    uint64_t max_late_ns;   // Worst delay between a deadline and the switch
+} tone_seq_t;
+
+/**
+ * Starts the sequencer thread on an initialised buzzer output.
+ * Returns 0, or -1 with the error printed.
+ */
+int tone_seq_start(tone_seq_t *seq, buzzer_output_t *out);
+
+/**
+ * Cancels everything, silences the buzzer and joins the thread.
+ */
+void tone_seq_stop(tone_seq_t *seq);
+
+/**
+ * Plays 'count' steps after whatever is queued (or at once with TONE_SEQ_NOW).
+ * 'steps' is not copied and must stay valid until the melody ends: use static tables.
+ * Returns 0, or -1 if the queue is full.
+ */
+int tone_seq_play(tone_seq_t *seq, const tone_step_t *steps, int count, int flags);
+
+/**
+ * Stops the current melody, drops the queue and silences the buzzer.
+ */
+void tone_seq_cancel(tone_seq_t *seq);
+
+/**
+ * Returns 1 while a melody is playing or queued.
+ */
+int tone_seq_busy(tone_seq_t *seq);
+
+/**
+ * Waits up to 'timeout_ms' (-1 = forever) for the sequencer to go idle.
+ * Returns 0 once idle, -1 on timeout.
+ */
+int tone_seq_wait(tone_seq_t *seq, int timeout_ms);
+
+/**
+ * Prints the step count and the worst lateness. Call before tone_seq_stop().
+ */
+void tone_seq_print_stats(tone_seq_t *seq, FILE *f);
+
+#endif
@@ -0,0 +1,104 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include "arena.h"
+
+static arena_t process_arena;
+
+int arena_init(arena_t *arena, size_t size) {
+    memset(arena, 0, sizeof(*arena));
+    size_t page = (size_t)sysconf(_SC_PAGESIZE);
+    size = (size + page - 1) / page * page;
+    if (size == 0) return -1;
+
+    // MAP_POPULATE faults every page in now rather than on first use
+    void *base = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_POPULATE, -1, 0);
+    if (base == MAP_FAILED) {
+        fprintf(stderr, "Arena: can't map %zu bytes: %s\n", size, strerror(errno));
+        return -1;
+    }
+    arena->base = base;
+    arena->size = size;
+
+    if (mlock(base, size) == 0) {
+        arena->locked = 1;
+    } else {
+        fprintf(stderr, "Arena: mlock of %zu KB failed: %s%s\n", size / 1024, strerror(errno),
+                errno == ENOMEM || errno == EPERM ? " (run as root or raise ulimit -l)" : "");
+    }
+    return 0;
+}
+
+void *arena_alloc(arena_t *arena, size_t size) {
+    size = (size + ARENA_ALIGN - 1) & ~(size_t)(ARENA_ALIGN - 1);
+    size_t used = __atomic_load_n(&arena->used, __ATOMIC_RELAXED);
+    do {
+        if (size > arena->size - used) {
+            __atomic_fetch_add(&arena->failures, 1, __ATOMIC_RELAXED);
+            return NULL;
+        }
+    } while (!__atomic_compare_exchange_n(&arena->used, &used, used + size, 1,
+                                          __ATOMIC_RELAXED, __ATOMIC_RELAXED));
+    // Fresh anonymous pages: already zero, and never handed out twice
+    return arena->base + used;
+}
+
+void arena_destroy(arena_t *arena) {
+    if (arena->base) munmap(arena->base, arena->size);
+    memset(arena, 0, sizeof(*arena));
+}
+
+// --- PROCESS ARENA ---
+
+int arena_setup(size_t default_size) {
+    size_t size = default_size;
+    const char *spec = getenv(ARENA_ENV_VAR);
+    if (spec && *spec) {
+        char *end;
+        unsigned long long v = strtoull(spec, &end, 10);
+        if (*end == 'k' || *end == 'K') v <<= 10, end++;
+        else if (*end == 'm' || *end == 'M') v <<= 20, end++;
+        if (end == spec || *end) {
+            fprintf(stderr, "%s: can't parse '%s' (bytes, k or m suffix)\n", ARENA_ENV_VAR, spec);
+            return -1;
+        }
+        size = (size_t)v;
+    }
+    if (size == 0) return 0; // Heap
+    return arena_init(&process_arena, size);
+}
+
+void *arena_calloc(size_t count, size_t size) {
+    if (!process_arena.base) return calloc(count, size);
+    if (size && count > SIZE_MAX / size) return NULL;
+
+    void *p = arena_alloc(&process_arena, count * size);
+    if (!p) {
+        fprintf(stderr, "Arena: no room for %zu bytes (%zu of %zu KB used), raise %s\n",
+                count * size, process_arena.used / 1024, process_arena.size / 1024, ARENA_ENV_VAR);
+    }
+    return p;
+}
+
+void arena_free(void *ptr) {
+    uint8_t *p = ptr;
+    if (process_arena.base && p >= process_arena.base && p < process_arena.base + process_arena.size) return;
+    free(ptr);
+}
+
+void arena_print_stats(FILE *f) {
+    if (!process_arena.base) {
+        fprintf(f, "Arena: off (heap)\n");
+        return;
+    }
+    fprintf(f, "Arena: %zu of %zu KB used, %s, %llu failed requests\n",
+            (process_arena.used + 1023) / 1024, process_arena.size / 1024,
+            process_arena.locked ? "locked" : "not locked", (unsigned long long)process_arena.failures);
+}
+
+void arena_teardown(void) {
+    arena_destroy(&process_arena);
+}
@@ -0,0 +1,65 @@
+#ifndef ARENA_H
+#define ARENA_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stddef.h>
+
+// --- FIXED-FOOTPRINT MEMORY ---
+// One block mapped, locked and touched at startup, from which every subsystem takes
+// its buffers (framebuffers, SPI double buffers, log rings, effect canvases, packet
+// batches). After setup nothing calls malloc(): no allocator locks or page faults in
+// the LED / input / tone paths, and the program's footprint is known up front.
+//
+//   PANEL_ARENA=512k sudo -E ./bin/...     (k / m suffix; 0 = plain heap)
+//
+// Unset, each program uses its own default size. The modules allocate through
+// arena_calloc() and give memory back with arena_free(); without an arena (programs
+// that never call arena_setup()) those are calloc() and free(). Memory freed into the
+// arena is not reused, so set things up once and keep them. Allocations are
+// ARENA_ALIGN aligned and zeroed, and safe from any thread.
+// The block is mlock()ed: that needs CAP_IPC_LOCK or a large enough RLIMIT_MEMLOCK
+// (ulimit -l); without, it is only pre-faulted and the failure is printed.
+
+#define ARENA_ENV_VAR "PANEL_ARENA"
+#define ARENA_ALIGN   64    // Cache line: no two buffers share one
+
+typedef struct {
+    uint8_t *base;
+    size_t size;
+    size_t used;            // Bump pointer (atomic)
+    int locked;             // mlock() succeeded
+    uint64_t failures;      // Requests that didn't fit
+} arena_t;
+
+// Maps and pre-faults 'size' bytes (rounded up to pages) and tries to mlock them.
+// Returns 0, or -1 with the reason printed.
+int arena_init(arena_t *arena, size_t size);
+
+// 'size' zeroed bytes, or NULL if the arena is full.
+void *arena_alloc(arena_t *arena, size_t size);
+
+// Unmaps the whole block.
+void arena_destroy(arena_t *arena);
+
+// --- PROCESS ARENA ---
+
+// Sets up the process arena: PANEL_ARENA if set, else 'default_size'. Call once at
+// startup, before any subsystem is opened. Returns 0, or -1 if the setting is invalid
+// or the block can't be mapped.
+int arena_setup(size_t default_size);
+
+// calloc() from the process arena (NULL when it is full, with the request printed),
+// or from the heap if there is none.
+void *arena_calloc(size_t count, size_t size);
+
+// No-op for memory from the process arena, free() for anything else.
+void arena_free(void *ptr);
+
+// Size, used, locked, failed requests: to tune PANEL_ARENA.
+void arena_print_stats(FILE *f);
+
+// Unmaps the process arena. Everything allocated from it must be unused by then.
+void arena_teardown(void);
+
+#endif
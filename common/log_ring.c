@@ -0,0 +1,280 @@
+#define _POSIX_C_SOURCE 200112L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stddef.h>
+#include <errno.h>
+#include <time.h>
+#include <pthread.h>
+#include <semaphore.h>
+#include <stdatomic.h>
+#include <sys/types.h>
+#include "log_ring.h"
+#include "arena.h"
+
+// One single-producer / single-consumer ring per logging thread: the thread owns
+// 'head', the writer owns 'tail'. Rings are allocated on a thread's first record
+// and kept until exit, so LOG_MAX_THREADS counts every thread that ever logged.
+typedef struct {
+    log_record_t records[LOG_RING_SIZE];
+    _Atomic uint32_t head;
+    _Atomic uint32_t tail;
+    _Atomic uint64_t dropped;
+} log_thread_ring_t;
+
+static log_thread_ring_t *_Atomic rings[LOG_MAX_THREADS];
+static _Atomic int num_rings = 0;
+static _Thread_local log_thread_ring_t *my_ring = NULL;
+static _Thread_local int my_ring_failed = 0;
+
+static _Atomic int running = 0;
+static FILE *log_out = NULL;
+static pthread_t writer;
+static sem_t wake;
+
+static uint64_t now_ns(void) {
+    struct timespec te;
+    clock_gettime(CLOCK_MONOTONIC, &te);
+    return (uint64_t)te.tv_sec * 1000000000ULL + (uint64_t)te.tv_nsec;
+}
+
+// --- FORMATTING (writer thread) ---
+
+// Prints one conversion, with the argument cast back to the type its spec expects
+static void print_arg(FILE *out, const char *spec, char conv, const char *len, uint64_t v) {
+    double d;
+
+    switch (conv) {
+        case 'd': case 'i':
+            if (!strcmp(len, "l")) fprintf(out, spec, (long)v);
+            else if (!strcmp(len, "ll") || !strcmp(len, "j")) fprintf(out, spec, (long long)v);
+            else if (!strcmp(len, "z")) fprintf(out, spec, (ssize_t)v);
+            else if (!strcmp(len, "t")) fprintf(out, spec, (ptrdiff_t)v);
+            else fprintf(out, spec, (int)v);
+            break;
+        case 'u': case 'o': case 'x': case 'X':
+            if (!strcmp(len, "l")) fprintf(out, spec, (unsigned long)v);
+            else if (!strcmp(len, "ll") || !strcmp(len, "j")) fprintf(out, spec, (unsigned long long)v);
+            else if (!strcmp(len, "z")) fprintf(out, spec, (size_t)v);
+            else if (!strcmp(len, "t")) fprintf(out, spec, (ptrdiff_t)v);
+            else fprintf(out, spec, (unsigned int)v);
+            break;
+        case 'c':
+            fprintf(out, spec, (int)v);
+            break;
+        case 'f': case 'F': case 'e': case 'E': case 'g': case 'G': case 'a': case 'A':
+            memcpy(&d, &v, sizeof(d));
+            if (!strcmp(len, "L")) fprintf(out, spec, (long double)d);
+            else fprintf(out, spec, d);
+            break;
+        case 's':
+            fprintf(out, spec, v ? (const char *)(uintptr_t)v : "(null)");
+            break;
+        case 'p':
+            fprintf(out, spec, (void *)(uintptr_t)v);
+            break;
+        default:
+            break; // %n and unknown conversions print nothing
+    }
+}
+
+static void print_record(FILE *out, const log_record_t *r) {
+    const char *p = r->fmt;
+    int arg = 0;
+
+    while (*p) {
+        // Literal text up to the next conversion
+        const char *pct = strchr(p, '%');
+        if (!pct) {
+            fputs(p, out);
+            break;
+        }
+        fwrite(p, 1, pct - p, out);
+        p = pct + 1;
+        if (*p == '%') {
+            fputc('%', out);
+            p++;
+            continue;
+        }
+
+        // Rebuild the spec: flags, width, precision ('*' filled in from the arguments),
+        // length modifier, conversion
+        char spec[48], len[3] = "";
+        int n = 0;
+        spec[n++] = '%';
+        while (*p && strchr("-+ #0", *p) && n < 8) spec[n++] = *p++;
+        for (int part = 0; part < 2; part++) {
+            if (part == 1) {
+                if (*p != '.') break;
+                spec[n++] = *p++;
+            }
+            if (*p == '*') {
+                int v = arg < r->nargs ? (int)r->args[arg] : 0;
+                arg++;
+                n += snprintf(spec + n, sizeof(spec) - n - 8, "%d", v);
+                p++;
+            } else {
+                while (*p >= '0' && *p <= '9' && n < 32) spec[n++] = *p++;
+            }
+        }
+        int l = 0;
+        while (*p && strchr("hlLqjzt", *p) && l < 2) len[l++] = spec[n++] = *p++;
+        len[l] = '\0';
+        if (!*p) break;
+        char conv = *p++;
+        spec[n++] = conv;
+        spec[n] = '\0';
+
+        print_arg(out, spec, conv, len, arg < r->nargs ? r->args[arg] : 0);
+        arg++;
+    }
+}
+
+// --- WRITER THREAD ---
+
+// Writes every queued record, oldest first across all rings. Returns how many.
+static int drain(void) {
+    int count = 0;
+    int threads = atomic_load_explicit(&num_rings, memory_order_acquire);
+    if (threads > LOG_MAX_THREADS) threads = LOG_MAX_THREADS;
+
+    while (1) {
+        log_thread_ring_t *oldest = NULL;
+        uint64_t oldest_ts = 0;
+
+        for (int i = 0; i < threads; i++) {
+            log_thread_ring_t *ring = atomic_load_explicit(&rings[i], memory_order_acquire);
+            if (!ring) continue;
+            uint32_t tail = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+            if (tail == atomic_load_explicit(&ring->head, memory_order_acquire)) continue;
+            uint64_t ts = ring->records[tail % LOG_RING_SIZE].timestamp_ns;
+            if (!oldest || ts < oldest_ts) {
+                oldest = ring;
+                oldest_ts = ts;
+            }
+        }
+        if (!oldest) break;
+
+        uint32_t tail = atomic_load_explicit(&oldest->tail, memory_order_relaxed);
+        print_record(log_out, &oldest->records[tail % LOG_RING_SIZE]);
+        atomic_store_explicit(&oldest->tail, tail + 1, memory_order_release);
+        count++;
+    }
+    if (count) fflush(log_out);
+    return count;
+}
+
+static void *writer_thread(void *arg) {
+    while (atomic_load_explicit(&running, memory_order_acquire)) {
+        // Woken early only when a ring is half full (or by flush/stop)
+        struct timespec abs;
+        clock_gettime(CLOCK_REALTIME, &abs);
+        abs.tv_nsec += LOG_FLUSH_MS * 1000000L;
+        if (abs.tv_nsec >= 1000000000L) {
+            abs.tv_sec++;
+            abs.tv_nsec -= 1000000000L;
+        }
+        while (sem_timedwait(&wake, &abs) < 0 && errno == EINTR);
+        drain();
+    }
+    drain();
+    return NULL;
+}
+
+// --- PRODUCERS ---
+
+static log_thread_ring_t *thread_ring(void) {
+    if (my_ring || my_ring_failed) return my_ring;
+
+    int slot = atomic_fetch_add_explicit(&num_rings, 1, memory_order_relaxed);
+    log_thread_ring_t *ring = slot < LOG_MAX_THREADS ? arena_calloc(1, sizeof(*ring)) : NULL;
+    if (!ring) {
+        my_ring_failed = 1; // Too many threads: this one prints directly
+        return NULL;
+    }
+    atomic_store_explicit(&rings[slot], ring, memory_order_release);
+    my_ring = ring;
+    return ring;
+}
+
+void log_write(int level, const char *fmt, int nargs, const uint64_t *args) {
+    log_record_t rec;
+    rec.timestamp_ns = now_ns();
+    rec.fmt = fmt;
+    rec.level = (uint8_t)level;
+    rec.nargs = (uint8_t)(nargs > LOG_MAX_ARGS ? LOG_MAX_ARGS : nargs);
+    memcpy(rec.args, args, rec.nargs * sizeof(uint64_t));
+
+    log_thread_ring_t *ring = atomic_load_explicit(&running, memory_order_acquire) ? thread_ring() : NULL;
+    if (!ring) {
+        print_record(stdout, &rec);
+        return;
+    }
+
+    uint32_t head = atomic_load_explicit(&ring->head, memory_order_relaxed);
+    uint32_t tail = atomic_load_explicit(&ring->tail, memory_order_acquire);
+    if (head - tail == LOG_RING_SIZE) {
+        atomic_fetch_add_explicit(&ring->dropped, 1, memory_order_relaxed);
+        return;
+    }
+    ring->records[head % LOG_RING_SIZE] = rec;
+    atomic_store_explicit(&ring->head, head + 1, memory_order_release);
+
+    // One wakeup per half ring, not per record
+    if (head - tail == LOG_RING_SIZE / 2) sem_post(&wake);
+}
+
+int log_start(FILE *out) {
+    if (atomic_load(&running)) return 0;
+    log_out = out;
+    sem_init(&wake, 0, 0);
+    atomic_store(&running, 1);
+    if (pthread_create(&writer, NULL, writer_thread, NULL) != 0) {
+        atomic_store(&running, 0);
+        fprintf(stderr, "Could not start the log writer thread\n");
+        return -1;
+    }
+    return 0;
+}
+
+void log_flush(void) {
+    if (!atomic_load(&running)) return;
+
+    // Wait until the writer has caught up with every head seen now
+    uint32_t heads[LOG_MAX_THREADS] = {0};
+    int threads = atomic_load(&num_rings);
+    if (threads > LOG_MAX_THREADS) threads = LOG_MAX_THREADS;
+    for (int i = 0; i < threads; i++) {
+        log_thread_ring_t *ring = atomic_load(&rings[i]);
+        if (ring) heads[i] = atomic_load(&ring->head);
+    }
+    sem_post(&wake);
+
+    for (int i = 0; i < threads; i++) {
+        log_thread_ring_t *ring = atomic_load(&rings[i]);
+        if (!ring) continue;
+        while ((int32_t)(atomic_load(&ring->tail) - heads[i]) < 0) {
+            struct timespec ts = { 0, 1000000 };
+            nanosleep(&ts, NULL);
+        }
+    }
+    fflush(log_out);
+}
+
+void log_stop(void) {
+    if (!atomic_load(&running)) return;
+    atomic_store(&running, 0);
+    sem_post(&wake);
+    pthread_join(writer, NULL);
+
+    uint64_t dropped = 0;
+    int threads = atomic_load(&num_rings);
+    if (threads > LOG_MAX_THREADS) threads = LOG_MAX_THREADS;
+    for (int i = 0; i < threads; i++) {
+        log_thread_ring_t *ring = atomic_load(&rings[i]);
+        if (ring) dropped += atomic_load(&ring->dropped);
+    }
+    if (dropped) fprintf(log_out, "(%llu log lines dropped, ring full)\n", (unsigned long long)dropped);
+    fflush(log_out);
+}
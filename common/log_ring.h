@@ -0,0 +1,122 @@
+#ifndef LOG_RING_H
+#define LOG_RING_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+
+// --- ASYNC LOGGING ---
+// printf() on a hot path (an interrupt callback, a per-pixel setter) can block on
+// the terminal or a slow serial console. The LOG_* macros instead copy the format
+// pointer and up to LOG_MAX_ARGS raw argument values into a fixed-size record in a
+// ring owned by the calling thread (no locks, no syscalls, no formatting). A
+// background thread merges the rings in timestamp order and does the printf.
+//
+// Rules that come from not formatting on the spot:
+// - the format must be a string literal, and %s arguments must stay valid until the
+//   line is written (literals, lguErrorText(), static tables), not stack buffers
+// - at most LOG_MAX_ARGS arguments; %p takes a void *
+// - a full ring drops the record and counts it (printed by log_stop())
+//
+// Levels are filtered at compile time: below LOG_LEVEL a macro generates no code and
+// its arguments are never evaluated. Build with -DLOG_LEVEL=LOG_LEVEL_DEBUG to get the debug lines.
+// Until log_start() is called (or after log_stop()) records are printed directly.
+
+#define LOG_LEVEL_DEBUG 0
+#define LOG_LEVEL_INFO  1
+#define LOG_LEVEL_WARN  2
+#define LOG_LEVEL_ERROR 3
+#define LOG_LEVEL_NONE  4
+
+#ifndef LOG_LEVEL
+#define LOG_LEVEL LOG_LEVEL_INFO
+#endif
+
+#define LOG_MAX_ARGS    6
+#define LOG_RING_SIZE   1024    // Records per thread, power of two
+#define LOG_MAX_THREADS 8       // Threads that can log (others print directly)
+#define LOG_FLUSH_MS    10      // Writer wakes up at least this often
+
+typedef struct {
+    uint64_t timestamp_ns;      // CLOCK_MONOTONIC, taken by the producer
+    const char *fmt;
+    uint8_t level;
+    uint8_t nargs;
+    uint64_t args[LOG_MAX_ARGS];    // Integers as 64 bits, doubles as their bit pattern
+} log_record_t;
+
+// Starts the writer thread, printing to 'out' (e.g. stdout). Returns 0 or -1.
+int log_start(FILE *out);
+
+// Writes everything still queued, stops the writer and reports dropped records.
+void log_stop(void);
+
+// Blocks until every record logged so far has been written (e.g. before a prompt).
+void log_flush(void);
+
+// Backend of the LOG_* macros.
+void log_write(int level, const char *fmt, int nargs, const uint64_t *args);
+
+// --- Argument packing (used by the macros) ---
+static inline uint64_t log_arg_int(uint64_t v) { return v; }
+static inline uint64_t log_arg_ptr(const void *p) { return (uint64_t)(uintptr_t)p; }
+static inline uint64_t log_arg_double(double d) {
+    uint64_t bits;
+    memcpy(&bits, &d, sizeof(bits));
+    return bits;
+}
+
+#define LOG_ARG(x) _Generic((x), \
+    float: log_arg_double, double: log_arg_double, \
+    char *: log_arg_ptr, const char *: log_arg_ptr, \
+    void *: log_arg_ptr, const void *: log_arg_ptr, \
+    default: log_arg_int)(x)
+
+#define LOG_NARGS_(_0, _1, _2, _3, _4, _5, _6, N, ...) N
+#define LOG_NARGS(...) LOG_NARGS_(_, ##__VA_ARGS__, 6, 5, 4, 3, 2, 1, 0)
+#define LOG_MAP_0()
+#define LOG_MAP_1(a) LOG_ARG(a)
+#define LOG_MAP_2(a, b) LOG_ARG(a), LOG_ARG(b)
+#define LOG_MAP_3(a, b, c) LOG_ARG(a), LOG_ARG(b), LOG_ARG(c)
+#define LOG_MAP_4(a, b, c, d) LOG_ARG(a), LOG_ARG(b), LOG_ARG(c), LOG_ARG(d)
+#define LOG_MAP_5(a, b, c, d, e) LOG_ARG(a), LOG_ARG(b), LOG_ARG(c), LOG_ARG(d), LOG_ARG(e)
+#define LOG_MAP_6(a, b, c, d, e, f) LOG_ARG(a), LOG_ARG(b), LOG_ARG(c), LOG_ARG(d), LOG_ARG(e), LOG_ARG(f)
+#define LOG_CAT_(a, b) a##b
+#define LOG_CAT(a, b) LOG_CAT_(a, b)
+
+// The dead printf() call only makes the compiler check the format against the arguments
+#define LOG_EMIT(level, fmt, ...) do { \
+    if (0) printf(fmt, ##__VA_ARGS__); \
+    log_write(level, fmt, LOG_NARGS(__VA_ARGS__), (const uint64_t[LOG_MAX_ARGS + 1]){ \
+        0, LOG_CAT(LOG_MAP_, LOG_NARGS(__VA_ARGS__))(__VA_ARGS__) } + 1); \
+} while (0)
+
+// Filtered out: no code is generated, but the arguments still count as used
+// and the format is still checked
+#define LOG_DISABLED(fmt, ...) do { if (0) printf(fmt, ##__VA_ARGS__); } while (0)
+
+#if LOG_LEVEL <= LOG_LEVEL_DEBUG
+#define LOG_DEBUG(fmt, ...) LOG_EMIT(LOG_LEVEL_DEBUG, fmt, ##__VA_ARGS__)
+#else
+#define LOG_DEBUG(fmt, ...) LOG_DISABLED(fmt, ##__VA_ARGS__)
+#endif
+
+#if LOG_LEVEL <= LOG_LEVEL_INFO
+#define LOG_INFO(fmt, ...) LOG_EMIT(LOG_LEVEL_INFO, fmt, ##__VA_ARGS__)
+#else
+#define LOG_INFO(fmt, ...) LOG_DISABLED(fmt, ##__VA_ARGS__)
+#endif
+
+#if LOG_LEVEL <= LOG_LEVEL_WARN
+#define LOG_WARN(fmt, ...) LOG_EMIT(LOG_LEVEL_WARN, fmt, ##__VA_ARGS__)
+#else
+#define LOG_WARN(fmt, ...) LOG_DISABLED(fmt, ##__VA_ARGS__)
+#endif
+
+#if LOG_LEVEL <= LOG_LEVEL_ERROR
+#define LOG_ERROR(fmt, ...) LOG_EMIT(LOG_LEVEL_ERROR, fmt, ##__VA_ARGS__)
+#else
+#define LOG_ERROR(fmt, ...) LOG_DISABLED(fmt, ##__VA_ARGS__)
+#endif
+
+#endif
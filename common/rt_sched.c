@@ -0,0 +1,155 @@
+#define _GNU_SOURCE // pthread_setaffinity_np, CPU_SET
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <sched.h>
+#include <sys/mman.h>
+#include "rt_sched.h"
+
+static const char *role_names[RT_NUM_ROLES] = { "input", "led", "tone" };
+
+int rt_config_parse(rt_cfg_t *cfg, const char *spec) {
+    char buf[256];
+    strncpy(buf, spec, sizeof(buf) - 1);
+    buf[sizeof(buf) - 1] = '\0';
+
+    for (char *save = NULL, *item = strtok_r(buf, ",", &save); item; item = strtok_r(NULL, ",", &save)) {
+        if (strcmp(item, "mlock") == 0) {
+            cfg->lock_memory = 1;
+            continue;
+        }
+
+        // role=priority[@cpu] or role@cpu
+        int role = -1;
+        for (int r = 0; r < RT_NUM_ROLES; r++) {
+            size_t len = strlen(role_names[r]);
+            if (strncmp(item, role_names[r], len) == 0 && (item[len] == '=' || item[len] == '@')) {
+                role = r;
+                item += len;
+                break;
+            }
+        }
+        if (role < 0) {
+            fprintf(stderr, "%s: unknown item '%s' (input, led, tone, mlock)\n", RT_ENV_VAR, item);
+            return -1;
+        }
+
+        rt_thread_cfg_t *t = &cfg->roles[role];
+        char *end = item;
+        if (*item == '=') {
+            long prio = strtol(item + 1, &end, 10);
+            int lo = sched_get_priority_min(SCHED_FIFO), hi = sched_get_priority_max(SCHED_FIFO);
+            if (end == item + 1 || prio < 0 || prio > hi || (prio != 0 && prio < lo)) {
+                fprintf(stderr, "%s: bad priority for %s (0 or %d-%d)\n", RT_ENV_VAR, role_names[role], lo, hi);
+                return -1;
+            }
+            t->priority = (int)prio;
+        }
+        if (*end == '@') {
+            char *cpu_end;
+            long cpu = strtol(end + 1, &cpu_end, 10);
+            if (cpu_end == end + 1 || cpu < 0 || cpu >= CPU_SETSIZE) {
+                fprintf(stderr, "%s: bad CPU for %s\n", RT_ENV_VAR, role_names[role]);
+                return -1;
+            }
+            t->cpu = (int)cpu;
+            end = cpu_end;
+        }
+        if (*end != '\0') {
+            fprintf(stderr, "%s: can't parse '%s' for %s\n", RT_ENV_VAR, end, role_names[role]);
+            return -1;
+        }
+    }
+    return 0;
+}
+
+int rt_config_load(rt_cfg_t *cfg) {
+    memset(cfg, 0, sizeof(*cfg));
+    for (int r = 0; r < RT_NUM_ROLES; r++) cfg->roles[r].cpu = -1;
+
+    const char *spec = getenv(RT_ENV_VAR);
+    if (!spec || !*spec) return 0;
+    if (rt_config_parse(cfg, spec) < 0) {
+        memset(cfg, 0, sizeof(*cfg));
+        for (int r = 0; r < RT_NUM_ROLES; r++) cfg->roles[r].cpu = -1;
+        return -1;
+    }
+
+    for (int r = 0; r < RT_NUM_ROLES; r++) {
+        const rt_thread_cfg_t *t = &cfg->roles[r];
+        if (t->priority || t->cpu >= 0) {
+            printf("RT: %-5s ", role_names[r]);
+            if (t->priority) printf("SCHED_FIFO %d", t->priority);
+            else printf("normal priority");
+            if (t->cpu >= 0) printf(", CPU %d", t->cpu);
+            printf("\n");
+        }
+    }
+    if (cfg->lock_memory && rt_lock_memory(256 * 1024) == 0) printf("RT: memory locked\n");
+    return 0;
+}
+
+// Warns if 'cpu' isn't isolated from the scheduler: other tasks can still run there
+static void check_isolated(int cpu) {
+    FILE *f = fopen("/sys/devices/system/cpu/isolated", "r");
+    char list[128] = "";
+    if (f) {
+        if (!fgets(list, sizeof(list), f)) list[0] = '\0';
+        fclose(f);
+    }
+
+    // Format: "2-3,5" (empty line when nothing is isolated)
+    for (char *p = list; *p && *p != '\n';) {
+        long lo = strtol(p, &p, 10), hi = lo;
+        if (*p == '-') hi = strtol(p + 1, &p, 10);
+        if (cpu >= lo && cpu <= hi) return;
+        if (*p == ',') p++;
+        else break;
+    }
+    fprintf(stderr, "RT: note: CPU %d is not in isolcpus, other tasks may share it\n", cpu);
+}
+
+int rt_apply(const rt_cfg_t *cfg, rt_role_t role, pthread_t thread, const char *name) {
+    const rt_thread_cfg_t *t = &cfg->roles[role];
+    int ret = 0, err;
+
+    if (t->cpu >= 0) {
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        CPU_SET(t->cpu, &set);
+        if ((err = pthread_setaffinity_np(thread, sizeof(set), &set)) != 0) {
+            fprintf(stderr, "RT: can't pin %s to CPU %d: %s\n", name, t->cpu, strerror(err));
+            ret = -1;
+        } else {
+            check_isolated(t->cpu);
+        }
+    }
+    if (t->priority > 0) {
+        struct sched_param sp = { .sched_priority = t->priority };
+        if ((err = pthread_setschedparam(thread, SCHED_FIFO, &sp)) != 0) {
+            fprintf(stderr, "RT: can't set SCHED_FIFO %d for %s: %s%s\n", t->priority, name, strerror(err),
+                    err == EPERM ? " (needs root or CAP_SYS_NICE)" : "");
+            ret = -1;
+        }
+    }
+    return ret;
+}
+
+int rt_apply_self(const rt_cfg_t *cfg, rt_role_t role, const char *name) {
+    return rt_apply(cfg, role, pthread_self(), name);
+}
+
+int rt_lock_memory(size_t stack_bytes) {
+    if (mlockall(MCL_CURRENT | MCL_FUTURE) < 0) {
+        fprintf(stderr, "RT: mlockall failed: %s%s\n", strerror(errno),
+                errno == ENOMEM || errno == EPERM ? " (raise RLIMIT_MEMLOCK or run as root)" : "");
+        return -1;
+    }
+
+    // Fault in the stack now rather than on the first deep call
+    volatile unsigned char *stack = alloca(stack_bytes);
+    for (size_t i = 0; i < stack_bytes; i += 4096) stack[i] = 0;
+    return 0;
+}
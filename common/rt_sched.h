@@ -0,0 +1,63 @@
+#ifndef RT_SCHED_H
+#define RT_SCHED_H
+
+#include <pthread.h>
+
+// --- REAL-TIME SCHEDULING ---
+// Optional SCHED_FIFO priority and CPU pinning per kind of thread, plus mlockall(),
+// configured at run time through the PANEL_RT environment variable so every
+// program takes the same setting without new command line options:
+//
+//   PANEL_RT="input=80@3,led=70@2,tone=60@2,mlock" sudo -E ./bin/...
+//
+//   input  GPIO alert callback / poller / event loop thread
+//   led    SPI transmit thread(s)
+//   tone   buzzer tone sequencing
+//   =P     SCHED_FIFO priority 1-99 (0 = stay SCHED_OTHER)
+//   @C     pin to CPU C (for a quiet core, boot with isolcpus=C nohz_full=C)
+//   mlock  lock all current and future memory, so no page fault stalls a deadline
+//
+// Unset (or an empty string) changes nothing. SCHED_FIFO needs root or CAP_SYS_NICE;
+// failures are printed and the thread keeps running at normal priority. The kernel's
+// RT throttling (/proc/sys/kernel/sched_rt_runtime_us, 95% by default) still keeps a
+// runaway FIFO thread from locking up the Pi.
+
+#define RT_ENV_VAR "PANEL_RT"
+
+typedef enum {
+    RT_ROLE_INPUT,
+    RT_ROLE_LED,
+    RT_ROLE_TONE,
+    RT_NUM_ROLES
+} rt_role_t;
+
+typedef struct {
+    int priority;   // SCHED_FIFO priority, 0 = leave the scheduling policy alone
+    int cpu;        // CPU to pin to, -1 = any
+} rt_thread_cfg_t;
+
+typedef struct {
+    rt_thread_cfg_t roles[RT_NUM_ROLES];
+    int lock_memory;
+} rt_cfg_t;
+
+// Parses a spec like "input=80@3,led=70,mlock" into 'cfg' (unlisted roles unchanged).
+// Returns 0, or -1 with the bad item printed.
+int rt_config_parse(rt_cfg_t *cfg, const char *spec);
+
+// Reads PANEL_RT (everything off if unset) and does the mlockall() if asked.
+// Call once at startup, before starting threads. Returns 0, or -1 if the spec is invalid.
+int rt_config_load(rt_cfg_t *cfg);
+
+// Applies a role's priority and CPU to 'thread'. No-op for a role that isn't configured.
+// 'name' is only used in messages. Returns 0, or -1 if anything was refused.
+int rt_apply(const rt_cfg_t *cfg, rt_role_t role, pthread_t thread, const char *name);
+
+// Same, for the calling thread (e.g. from inside lgpio's alert callback).
+int rt_apply_self(const rt_cfg_t *cfg, rt_role_t role, const char *name);
+
+// mlockall(MCL_CURRENT | MCL_FUTURE) and touch 'stack_bytes' of the calling thread's
+// stack so those pages are resident too. Returns 0 or -1.
+int rt_lock_memory(size_t stack_bytes);
+
+#endif
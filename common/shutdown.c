@@ -0,0 +1,35 @@
+#include <signal.h>
+#include <errno.h>
+#include <poll.h>
+#include <unistd.h>
+#include <sys/signalfd.h>
+#include "shutdown.h"
+
+int shutdown_fd_open(void) {
+    sigset_t mask;
+    sigemptyset(&mask);
+    sigaddset(&mask, SIGINT);
+    sigaddset(&mask, SIGTERM);
+    if (sigprocmask(SIG_BLOCK, &mask, NULL) < 0) return -1;
+    return signalfd(-1, &mask, SFD_NONBLOCK | SFD_CLOEXEC);
+}
+
+int shutdown_requested(int fd) {
+    struct signalfd_siginfo si;
+    return read(fd, &si, sizeof(si)) == (ssize_t)sizeof(si);
+}
+
+int shutdown_wait(int shutdown_fd, int fd, int timeout_ms) {
+    struct pollfd fds[2] = {
+        { .fd = shutdown_fd, .events = POLLIN },
+        { .fd = fd, .events = POLLIN },
+    };
+    while (1) {
+        int ret = poll(fds, 2, timeout_ms);
+        if (ret < 0 && errno == EINTR) continue;
+        if (ret < 0) return -1;
+        if (ret == 0) return 0;
+        if ((fds[0].revents & POLLIN) && shutdown_requested(shutdown_fd)) return -1;
+        if (fds[1].revents & (POLLIN | POLLHUP | POLLERR)) return 1;
+    }
+}
@@ -0,0 +1,23 @@
+#ifndef SHUTDOWN_H
+#define SHUTDOWN_H
+
+// --- SIGNAL-FREE SHUTDOWN ---
+// Ctrl+C and SIGTERM delivered as a readable fd (signalfd) instead of a handler:
+// the main loop polls it next to its other fds and does the cleanup (LEDs off,
+// printing, freeing) in normal context, where none of that is restricted to
+// async-signal-safe calls and no handler can interrupt a half-sent SPI frame.
+//
+// Call shutdown_fd_open() before starting any thread: threads inherit the blocked
+// mask, so the signals are only ever seen through the fd.
+
+// Blocks SIGINT and SIGTERM and returns a non-blocking signalfd for them, or -1.
+int shutdown_fd_open(void);
+
+// 1 if a shutdown signal is pending on 'fd' (consumes it), else 0. Never blocks.
+int shutdown_requested(int fd);
+
+// Waits up to 'timeout_ms' (-1 = forever) for 'fd' (e.g. stdin, -1 = none) to become
+// readable. Returns 1 if it is, 0 on timeout, -1 if a shutdown signal came first.
+int shutdown_wait(int shutdown_fd, int fd, int timeout_ms);
+
+#endif
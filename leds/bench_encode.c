@@ -0,0 +1,191 @@
+#define _POSIX_C_SOURCE 199309L
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "ws2812_spi.h"
+
+// --- CONFIGURATION ---
+#define LED_COUNT 186
+#define FRAMES    20000
+
+// Micro-benchmark for the SPI encoder. No hardware needed.
+// Compares the original per-bit loop with the lookup table, the bulk encode_frame()
+// and the packed GRB kernels. Before timing anything, every encoder is checked
+// bit-exact against encode_byte_bitwise().
+
+uint32_t pixels[LED_COUNT];
+uint8_t grb[LED_COUNT * 3];
+uint8_t tx_buffer[LED_COUNT * WS2812_MAX_SPI_BITS * WS2812_MAX_COLORS];
+ws2812_encoder_t profile_enc;
+
+// Helper: Current time in ns
+long long current_timestamp_ns() {
+    struct timespec te;
+    clock_gettime(CLOCK_MONOTONIC, &te);
+    return te.tv_sec * 1000000000LL + te.tv_nsec;
+}
+
+// Old path: set_pixel() with the bitwise encoder, three calls per LED
+void encode_bitwise(void) {
+    for (int i = 0; i < LED_COUNT; i++) {
+        uint8_t *ptr = tx_buffer + i * WS2812_SPI_BYTES_PER_LED;
+        encode_byte_bitwise((pixels[i] >> 8) & 0xFF, ptr);
+        encode_byte_bitwise((pixels[i] >> 16) & 0xFF, ptr + 3);
+        encode_byte_bitwise(pixels[i] & 0xFF, ptr + 6);
+    }
+}
+
+// set_pixel() with the table, three calls per LED
+void encode_table(void) {
+    for (int i = 0; i < LED_COUNT; i++) {
+        uint8_t *ptr = tx_buffer + i * WS2812_SPI_BYTES_PER_LED;
+        encode_byte((pixels[i] >> 8) & 0xFF, ptr);
+        encode_byte((pixels[i] >> 16) & 0xFF, ptr + 3);
+        encode_byte(pixels[i] & 0xFF, ptr + 6);
+    }
+}
+
+void encode_bulk(void) {
+    encode_frame(tx_buffer, pixels, LED_COUNT);
+}
+
+void encode_grb_table(void) {
+    encode_grb_scalar(tx_buffer, grb, sizeof(grb));
+}
+
+void encode_grb_dispatch(void) {
+    encode_grb(tx_buffer, grb, sizeof(grb));
+}
+
+void encode_profile(void) {
+    ws2812_encode_packed(&profile_enc, tx_buffer, grb, sizeof(grb));
+}
+
+void encode_limited(void) {
+    ws2812_limit_power(&profile_enc, grb, sizeof(grb));
+    ws2812_encode_packed(&profile_enc, tx_buffer, grb, sizeof(grb));
+}
+
+// Checks one GRB encoder against the original loop for every length up to MAX_LEN
+// (so all tail sizes are covered) and for all 256 values in one run.
+int check_grb_encoder(const char *name, void (*fn)(uint8_t *, const uint8_t *, size_t)) {
+    enum { MAX_LEN = 256 + 48 };
+    uint8_t src[MAX_LEN];
+    uint8_t expected[MAX_LEN * 3];
+    uint8_t actual[MAX_LEN * 3 + 1];
+
+    for (int i = 0; i < MAX_LEN; i++) {
+        src[i] = (i < 256) ? (uint8_t)i : (uint8_t)rand();
+        encode_byte_bitwise(src[i], expected + i * 3);
+    }
+
+    for (size_t len = 0; len <= MAX_LEN; len++) {
+        memset(actual, 0xA5, sizeof(actual));
+        fn(actual, src, len);
+        if (memcmp(actual, expected, len * 3) != 0 || actual[len * 3] != 0xA5) {
+            fprintf(stderr, "%s encoder mismatch at length %zu\n", name, len);
+            return -1;
+        }
+    }
+    return 0;
+}
+
+void run(const char *name, void (*fn)(void)) {
+    // Warm up caches
+    for (int f = 0; f < 100; f++) fn();
+
+    long long start = current_timestamp_ns();
+    for (int f = 0; f < FRAMES; f++) {
+        // Keep the compiler from hoisting the work
+        pixels[f % LED_COUNT] ^= (uint32_t)f;
+        grb[f % sizeof(grb)] ^= (uint8_t)f;
+        fn();
+    }
+    long long elapsed = current_timestamp_ns() - start;
+
+    printf("%-22s %8.2f ns/LED  %8.2f us/frame\n", name,
+           (double)elapsed / ((double)FRAMES * LED_COUNT),
+           (double)elapsed / FRAMES / 1000.0);
+}
+
+int main() {
+    // Sanity check: the table must match the original loop for every value
+    for (int v = 0; v < 256; v++) {
+        uint8_t a[3], b[3];
+        encode_byte_bitwise((uint8_t)v, a);
+        encode_byte((uint8_t)v, b);
+        if (memcmp(a, b, 3) != 0) {
+            fprintf(stderr, "Table mismatch for value %d\n", v);
+            return 1;
+        }
+    }
+
+    srand(1);
+    if (check_grb_encoder("scalar", encode_grb_scalar) < 0) return 1;
+#ifdef WS2812_HAVE_NEON
+    if (check_grb_encoder("neon", encode_grb_neon) < 0) return 1;
+#endif
+    if (check_grb_encoder("dispatch", encode_grb) < 0) return 1;
+
+    // The generated 3-bit profile table must match the compile-time one
+    if (ws2812_encoder_init(&profile_enc, ws2812_profile_find("ws2812-3bit")) < 0) return 1;
+    for (int c = 0; c < 3; c++) {
+        for (int v = 0; v < 256; v++) {
+            if (memcmp(profile_enc.lut[c][v], ws2812_spi_lut[v], 3) != 0) {
+                fprintf(stderr, "ws2812-3bit profile table mismatch for value %d\n", v);
+                return 1;
+            }
+        }
+    }
+
+    // Gamma + half brightness must land in the same table, not in a second pass
+    ws2812_correction_t corr = { 128, 1, { 255, 255, 255, 255 } };
+    ws2812_set_correction(&profile_enc, &corr);
+    for (int v = 0; v < 256; v++) {
+        uint8_t expected = (uint8_t)((ws2812_gamma8[v] * 128 + 127) / 255);
+        if (memcmp(profile_enc.lut[0][v], ws2812_spi_lut[expected], 3) != 0) {
+            fprintf(stderr, "Corrected table mismatch for value %d\n", v);
+            return 1;
+        }
+    }
+
+    for (int i = 0; i < LED_COUNT; i++) {
+        pixels[i] = ((uint32_t)rand() & 0xFFFFFF);
+        grb[i * 3 + 0] = (pixels[i] >> 8) & 0xFF;
+        grb[i * 3 + 1] = (pixels[i] >> 16) & 0xFF;
+        grb[i * 3 + 2] = pixels[i] & 0xFF;
+    }
+
+    printf("SPI encode benchmark: %d LEDs, %d frames\n", LED_COUNT, FRAMES);
+    run("bitwise set_pixel", encode_bitwise);
+    run("table set_pixel", encode_table);
+    run("table encode_frame", encode_bulk);
+    run("grb scalar", encode_grb_table);
+    printf("(encode_grb backend: %s)\n", encode_grb_backend());
+    run("grb encode_grb", encode_grb_dispatch);
+
+    // Other profiles (RGB data only, so the RGBW one is left out)
+    for (int p = 0; p < ws2812_num_profiles; p++) {
+        if (ws2812_profiles[p].colors != 3) continue;
+        ws2812_encoder_init(&profile_enc, &ws2812_profiles[p]);
+        char name[40];
+        snprintf(name, sizeof(name), "profile %s", ws2812_profiles[p].name);
+        run(name, encode_profile);
+    }
+
+    // Correction and power limiter on the 3-bit profile (table path, fast_grb off)
+    ws2812_encoder_init(&profile_enc, ws2812_profile_find("ws2812-3bit"));
+    ws2812_set_correction(&profile_enc, &corr);
+    run("3bit gamma+brightness", encode_profile);
+    ws2812_set_power_budget(&profile_enc, 1000, 0);
+    run("3bit + power limit", encode_limited);
+    printf("(estimate %u mA, limited to %u/256)\n",
+           profile_enc.last_estimate_ma, profile_enc.limit);
+
+    // Print one byte so the buffer is observably used
+    printf("(checksum byte: 0x%02X)\n", tx_buffer[LED_COUNT]);
+    return 0;
+}
@@ -0,0 +1,262 @@
+#define _GNU_SOURCE // struct mmsghdr (net_ingest.h)
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include "strip_manager.h"
+#include "net_ingest.h"
+
+// --- CONFIGURATION ---
+#define LED_COUNT    300        // Two E1.31 universes
+#define BASE_UNIVERSE 1
+#define DDP_PORT     14048      // Not the default, so a running led_net_daemon doesn't interfere
+#define WAIT_MS      500        // Longest wait for packets / a frame to be shown
+#define BENCH_FRAMES 2000
+
+// Packet-level check and benchmark of net_ingest.c, no hardware or sudo needed.
+// Builds real DDP and E1.31 (sACN) datagrams, sends them over loopback to the ingest
+// sockets and checks frame completion, sync and the late packet test against the
+// counters and the encoded pixels on a mock strip. Then sends BENCH_FRAMES DDP frames
+// back to back and prints packets/s and frames shown / dropped.
+//
+// Usage: bench_net_ingest [profile]
+
+strip_manager_t sm;
+net_ingest_t ni;
+int tx_fd = -1;
+int failures = 0;
+
+// Helper: Current time in ns
+uint64_t current_timestamp_ns() {
+    struct timespec te;
+    clock_gettime(CLOCK_MONOTONIC, &te);
+    return (uint64_t)te.tv_sec * 1000000000ULL + (uint64_t)te.tv_nsec;
+}
+
+static void put16(uint8_t *p, uint16_t v) {
+    p[0] = v >> 8;
+    p[1] = v & 0xFF;
+}
+
+static void put32(uint8_t *p, uint32_t v) {
+    put16(p, v >> 16);
+    put16(p + 2, v & 0xFFFF);
+}
+
+// --- PACKETS ---
+
+// Root layer shared by data and sync packets
+static void e131_root(uint8_t *pkt, size_t len, uint32_t vector) {
+    static const uint8_t acn_id[12] = { 'A', 'S', 'C', '-', 'E', '1', '.', '1', '7', 0, 0, 0 };
+    put16(pkt, 0x0010);
+    memcpy(pkt + 4, acn_id, 12);
+    put16(pkt + 16, 0x7000 | (len - 16));
+    put32(pkt + 18, vector);
+    memset(pkt + 22, 0xAB, 16);                     // CID
+}
+
+// Data packet for 'universe', every pixel 'color' (0xRRGGBB). Returns its length.
+static size_t e131_data(uint8_t *pkt, uint16_t universe, uint8_t seq, uint16_t sync, uint32_t color) {
+    size_t channels = NET_E131_PIXELS * 3, len = 126 + channels;
+    memset(pkt, 0, len);
+    e131_root(pkt, len, 0x00000004);
+    put16(pkt + 38, 0x7000 | (len - 38));
+    put32(pkt + 40, 0x00000002);
+    strcpy((char *)pkt + 44, "bench_net_ingest");   // Source name
+    pkt[108] = 100;                                 // Priority (the default)
+    put16(pkt + 109, sync);
+    pkt[111] = seq;
+    put16(pkt + 113, universe);
+    put16(pkt + 115, 0x7000 | (len - 115));
+    pkt[117] = 0x02;
+    pkt[118] = 0xA1;
+    put16(pkt + 121, 1);
+    put16(pkt + 123, channels + 1);                 // Start code + channels
+    for (size_t i = 0; i < channels; i += 3) {
+        pkt[126 + i] = color >> 16;
+        pkt[127 + i] = color >> 8;
+        pkt[128 + i] = color;
+    }
+    return len;
+}
+
+static size_t e131_sync(uint8_t *pkt, uint8_t seq, uint16_t sync) {
+    size_t len = 49;
+    memset(pkt, 0, len);
+    e131_root(pkt, len, 0x00000008);
+    put16(pkt + 38, 0x7000 | (len - 38));
+    put32(pkt + 40, 0x00000001);
+    pkt[44] = seq;
+    put16(pkt + 45, sync);
+    return len;
+}
+
+// RGB data for LEDs [first, first + count), every one 'color'
+static size_t ddp_data(uint8_t *pkt, uint8_t seq, int push, size_t first, size_t count, uint32_t color) {
+    size_t data_len = count * 3;
+    pkt[0] = 0x40 | (push ? 0x01 : 0);
+    pkt[1] = seq;
+    pkt[2] = 0x0B;                                  // RGB, 8 bits per channel
+    pkt[3] = 1;                                     // Display
+    put32(pkt + 4, first * 3);
+    put16(pkt + 8, data_len);
+    for (size_t i = 0; i < data_len; i += 3) {
+        pkt[10 + i] = color >> 16;
+        pkt[11 + i] = color >> 8;
+        pkt[12 + i] = color;
+    }
+    return 10 + data_len;
+}
+
+// --- CHECKS ---
+
+static void send_to(const uint8_t *pkt, size_t len, int port) {
+    struct sockaddr_in addr = { .sin_family = AF_INET, .sin_port = htons(port),
+                                .sin_addr.s_addr = htonl(INADDR_LOOPBACK) };
+    if (sendto(tx_fd, pkt, len, 0, (struct sockaddr *)&addr, sizeof(addr)) != (ssize_t)len) {
+        perror("sendto");
+    }
+}
+
+// Polls until 'packets' datagrams have been handled and every completed frame is out
+static void pump(uint64_t packets) {
+    uint64_t deadline = current_timestamp_ns() + WAIT_MS * 1000000ULL;
+    while (current_timestamp_ns() < deadline) {
+        net_ingest_poll(&ni, 1);
+        if (ni.packets >= packets && ni.frames_shown + ni.frames_dropped >= ni.frames) return;
+    }
+}
+
+static void check(int ok, const char *what) {
+    printf("  %-52s %s\n", what, ok ? "ok" : "FAILED");
+    if (!ok) failures++;
+}
+
+// The frame handed off last shows 'color' at logical LED 'index'
+static int shows(size_t index, uint32_t color) {
+    uint8_t expected[WS2812_MAX_SPI_BITS * WS2812_MAX_COLORS];
+    for (int s = 0; s < sm.num_segments; s++) {
+        strip_segment_t *seg = &sm.segments[s];
+        if (index < seg->first || index >= seg->first + seg->count) continue;
+        spi_tx_flush(&seg->tx);
+        ws2812_encode_pixel(&sm.enc, expected, color);
+        return memcmp(spi_tx_front(&seg->tx) + (index - seg->first) * sm.enc.bytes_per_led,
+                      expected, sm.enc.bytes_per_led) == 0;
+    }
+    return 0;
+}
+
+static void run_checks(void) {
+    uint8_t pkt[NET_PACKET_MAX];
+    uint64_t frames, late;
+
+    printf("E1.31:\n");
+    frames = ni.frames;
+    send_to(pkt, e131_data(pkt, BASE_UNIVERSE, 5, 0, 0x102030), NET_E131_PORT);
+    send_to(pkt, e131_data(pkt, BASE_UNIVERSE + 1, 5, 0, 0x102030), NET_E131_PORT);
+    pump(ni.packets + 2);
+    check(ni.frames == frames + 1 && ni.e131_sync == 0, "unsynchronized: frame on the last universe");
+    check(shows(0, 0x102030) && shows(LED_COUNT - 1, 0x102030), "pixels on both universes encoded");
+
+    frames = ni.frames;
+    late = ni.late_packets;
+    send_to(pkt, e131_data(pkt, BASE_UNIVERSE, 4, 0, 0x400000), NET_E131_PORT);
+    send_to(pkt, e131_data(pkt, BASE_UNIVERSE + 1, 4, 0, 0x400000), NET_E131_PORT);
+    pump(ni.packets + 2);
+    check(ni.frames == frames && ni.late_packets == late + 2, "older sequence after a frame: late");
+    check(shows(0, 0x102030), "late packets not shown");
+
+    frames = ni.frames;
+    send_to(pkt, e131_data(pkt, BASE_UNIVERSE, 6, 7, 0x004000), NET_E131_PORT);
+    send_to(pkt, e131_data(pkt, BASE_UNIVERSE + 1, 6, 7, 0x004000), NET_E131_PORT);
+    pump(ni.packets + 2);
+    check(ni.frames == frames && ni.e131_sync == 7, "sync address 7: waits for the sync packet");
+    send_to(pkt, e131_sync(pkt, 0, 8), NET_E131_PORT);
+    pump(ni.packets + 1);
+    check(ni.frames == frames, "sync packet for another address ignored");
+    send_to(pkt, e131_sync(pkt, 1, 7), NET_E131_PORT);
+    pump(ni.packets + 1);
+    check(ni.frames == frames + 1 && shows(200, 0x004000), "sync packet shows the frame");
+
+    printf("DDP:\n");
+    frames = ni.frames;
+    send_to(pkt, ddp_data(pkt, 1, 0, 0, 150, 0x000040), DDP_PORT);
+    send_to(pkt, ddp_data(pkt, 2, 1, 150, 150, 0x000040), DDP_PORT);
+    pump(ni.packets + 2);
+    check(ni.frames == frames + 1 && shows(0, 0x000040) && shows(299, 0x000040), "two packets, PUSH on the last");
+
+    frames = ni.frames;
+    late = ni.late_packets;
+    send_to(pkt, ddp_data(pkt, 1, 1, 0, 150, 0x404040), DDP_PORT);
+    pump(ni.packets + 1);
+    check(ni.frames == frames && ni.late_packets == late + 1 && shows(0, 0x000040), "older sequence: late");
+}
+
+// --- BENCHMARK ---
+
+static void run_bench(void) {
+    uint8_t pkt[2][NET_PACKET_MAX];
+    uint64_t packets = ni.packets, shown = ni.frames_shown, dropped = ni.frames_dropped;
+    uint64_t start = current_timestamp_ns(), sent = 0;
+    uint8_t seq = 3;
+
+    for (int f = 0; f < BENCH_FRAMES; f++) {
+        uint32_t color = (uint32_t)f * 0x010203;
+        size_t len0 = ddp_data(pkt[0], seq, 0, 0, 150, color);
+        seq = seq % 15 + 1;
+        size_t len1 = ddp_data(pkt[1], seq, 1, 150, 150, color);
+        seq = seq % 15 + 1;
+        send_to(pkt[0], len0, DDP_PORT);
+        send_to(pkt[1], len1, DDP_PORT);
+        sent += 2;
+        net_ingest_poll(&ni, 0);
+    }
+    pump(packets + sent);
+    double s = (current_timestamp_ns() - start) / 1e9;
+
+    printf("Benchmark: %d DDP frames (%d LEDs, 2 packets each) in %.2f s\n", BENCH_FRAMES, LED_COUNT, s);
+    printf("  %.0f packets/s handled, %.1f per recvmmsg, %llu shown, %llu dropped, %llu lost\n",
+           (ni.packets - packets) / s, ni.syscalls ? (double)ni.packets / ni.syscalls : 0.0,
+           (unsigned long long)(ni.frames_shown - shown), (unsigned long long)(ni.frames_dropped - dropped),
+           (unsigned long long)(packets + sent - ni.packets));
+}
+
+int main(int argc, char **argv) {
+    const ws2812_profile_t *profile = ws2812_profile_find(argc > 1 ? argv[1] : NULL);
+    if (!profile) {
+        fprintf(stderr, "Unknown encoding profile '%s'\n", argv[1]);
+        ws2812_print_profiles();
+        return 1;
+    }
+
+    strip_segment_cfg_t strips[] = { { STRIP_MOCK_DEVICE, LED_COUNT } };
+    if (strip_manager_open(&sm, strips, 1, profile) < 0) return 1;
+    if (net_ingest_open(&ni, &sm, DDP_PORT, BASE_UNIVERSE) < 0) {
+        strip_manager_close(&sm);
+        return 1;
+    }
+    tx_fd = socket(AF_INET, SOCK_DGRAM | SOCK_CLOEXEC, 0);
+    if (tx_fd < 0) {
+        perror("UDP socket");
+        return 1;
+    }
+
+    printf("Network ingest check: %d LEDs on a mock strip (%s), DDP port %d, E1.31 universes %d-%d\n",
+           LED_COUNT, profile->name, DDP_PORT, BASE_UNIVERSE, BASE_UNIVERSE + ni.e131_universes - 1);
+    run_checks();
+    if (!failures) run_bench();
+
+    close(tx_fd);
+    net_ingest_close(&ni);
+    strip_manager_close(&sm);
+    if (failures) {
+        printf("%d check(s) FAILED\n", failures);
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,183 @@
+#define _POSIX_C_SOURCE 199309L
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "ws2812_spi.h"
+#include "spi_tx.h"
+
+// --- CONFIGURATION ---
+static const size_t CHAIN_LENGTHS[] = { 50, 186, 500, 1000, 2000, 5000, 10000 };
+#define NUM_LENGTHS (int)(sizeof(CHAIN_LENGTHS) / sizeof(CHAIN_LENGTHS[0]))
+#define MAX_FRAMES  300     // Frames per run at most...
+#define MIN_FRAMES  10      // ...and at least
+#define RUN_TIME_MS 1500    // Stop a run after this long once MIN_FRAMES are done
+#define CHASE_TAIL  10
+
+// End-to-end benchmark of the LED output path, no hardware or sudo needed.
+// Runs the set_pixel() / fill_black() / show() pipeline of led_test_spi against a mock
+// SPI sink (see spi_mock_open()) that models the wire time, for chain lengths from 50
+// to 10000 LEDs, once blocking (spi_sched_send) and once double-buffered (spi_tx).
+// Lengths whose frame is over spidev's bufsiz are skipped, as the real device refuses them.
+//
+// Usage: bench_pipeline [--no-wire] [profile]
+//   --no-wire  the sink returns immediately: measures CPU cost only
+//
+// Columns:
+//   encode   ns per LED spent in the encoder
+//   fps      frames per second through the whole pipeline
+//   sys/fr   syscalls (SPI messages) per frame
+//   p50/p99  frame latency, from the first set_pixel() until show() returns
+
+ws2812_encoder_t enc;
+uint8_t *grb_buffer = NULL;
+size_t grb_len = 0;
+size_t led_count = 0;
+uint64_t latency_ns[MAX_FRAMES];
+
+// Helper: Current time in ns
+uint64_t current_timestamp_ns() {
+    struct timespec te;
+    clock_gettime(CLOCK_MONOTONIC, &te);
+    return (uint64_t)te.tv_sec * 1000000000ULL + (uint64_t)te.tv_nsec;
+}
+
+void set_pixel(size_t index, uint32_t color) {
+    if (index >= led_count) return;
+    ws2812_pack_pixel(&enc, grb_buffer + index * enc.profile->colors, color);
+}
+
+void fill_black() {
+    memset(grb_buffer, 0, grb_len);
+}
+
+// Frame 'n' of a chase, the same kind of update the test programs do
+void render_chase(unsigned n) {
+    fill_black();
+    size_t head = n % led_count;
+    for (int t = 0; t < CHASE_TAIL; t++) {
+        set_pixel((head + led_count - t) % led_count, 0xFF4000 >> t);
+    }
+}
+
+int compare_u64(const void *a, const void *b) {
+    uint64_t x = *(const uint64_t *)a, y = *(const uint64_t *)b;
+    return (x > y) - (x < y);
+}
+
+// Runs one chain length through one pipeline and prints a result row
+int run(int fd, int async) {
+    size_t frame_len = ws2812_frame_bytes(&enc, led_count);
+    uint32_t speed = enc.profile->spi_hz;
+    spi_frame_sched_t sync_sched;
+    spi_tx_t tx;
+    uint8_t *sync_buffer = NULL;
+
+    if (async) {
+        if (spi_tx_start(&tx, fd, frame_len, speed, enc.profile->latch_us) < 0) return -1;
+    } else {
+        sync_buffer = calloc(1, frame_len);
+        if (!sync_buffer) return -1;
+        spi_sched_init(&sync_sched, fd, speed, enc.profile->latch_us);
+    }
+
+    uint64_t encode_ns = 0;
+    int frames = 0;
+    uint64_t start = current_timestamp_ns();
+
+    while (frames < MAX_FRAMES) {
+        uint64_t t0 = current_timestamp_ns();
+        render_chase(frames);
+
+        // show()
+        uint8_t *dst = async ? spi_tx_back(&tx) : sync_buffer;
+        uint64_t e0 = current_timestamp_ns();
+        ws2812_encode_packed(&enc, dst, grb_buffer, grb_len);
+        encode_ns += current_timestamp_ns() - e0;
+        if (async) {
+            spi_tx_swap(&tx);
+        } else {
+            spi_sched_send(&sync_sched, sync_buffer, frame_len);
+        }
+
+        uint64_t t1 = current_timestamp_ns();
+        latency_ns[frames++] = t1 - t0;
+        if (frames >= MIN_FRAMES && t1 - start >= RUN_TIME_MS * 1000000ULL) break;
+    }
+
+    spi_frame_sched_t *sched = &sync_sched;
+    if (async) {
+        spi_tx_flush(&tx);
+        sched = &tx.sched;
+    }
+    uint64_t elapsed = current_timestamp_ns() - start;
+
+    qsort(latency_ns, frames, sizeof(latency_ns[0]), compare_u64);
+    printf("%6zu  %-5s  %8.2f  %8.1f  %6.2f  %9.1f  %9.1f\n",
+           led_count, async ? "async" : "sync",
+           (double)encode_ns / ((double)frames * led_count),
+           frames * 1e9 / elapsed,
+           sched->frames ? (double)sched->ioctls / sched->frames : 0.0,
+           latency_ns[frames / 2] / 1000.0,
+           latency_ns[(frames * 99) / 100] / 1000.0);
+
+    if (async) {
+        spi_tx_stop(&tx);
+    } else {
+        free(sync_buffer);
+    }
+    return 0;
+}
+
+int main(int argc, char **argv) {
+    int wire_time = 1;
+    const char *profile_name = NULL;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--no-wire") == 0) {
+            wire_time = 0;
+        } else {
+            profile_name = argv[i];
+        }
+    }
+
+    const ws2812_profile_t *profile = ws2812_profile_find(profile_name);
+    if (!profile || ws2812_encoder_init(&enc, profile) < 0) {
+        fprintf(stderr, "Unknown encoding profile '%s'\n", profile_name);
+        ws2812_print_profiles();
+        return 1;
+    }
+
+    int fd = spi_mock_open(wire_time);
+    if (fd < 0) return 1;
+
+    printf("LED pipeline benchmark: profile %s at %u Hz, %s encoder, %s\n",
+           profile->name, profile->spi_hz, enc.fast_grb ? encode_grb_backend() : "table",
+           wire_time ? "simulated wire time" : "no wire time");
+    printf("%6s  %-5s  %8s  %8s  %6s  %9s  %9s\n",
+           "LEDs", "mode", "ns/LED", "fps", "sys/fr", "p50 us", "p99 us");
+
+    for (int l = 0; l < NUM_LENGTHS; l++) {
+        led_count = CHAIN_LENGTHS[l];
+        size_t frame_len = ws2812_frame_bytes(&enc, led_count);
+        if (frame_len > spi_max_frame_bytes()) {
+            // Refused like on the real device: it would go out in several ioctls and tear
+            printf("%6zu  needs spidev.bufsiz=%zu (now %zu bytes per frame at most)\n",
+                   led_count, frame_len, spi_max_frame_bytes());
+            continue;
+        }
+        grb_len = led_count * profile->colors;
+        grb_buffer = calloc(1, grb_len);
+        if (!grb_buffer) return 1;
+
+        if (run(fd, 0) < 0 || run(fd, 1) < 0) return 1;
+
+        free(grb_buffer);
+        grb_buffer = NULL;
+    }
+
+    spi_mock_close(fd);
+    return 0;
+}
@@ -0,0 +1,99 @@
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "led_anim.h"
+
+_Static_assert(sizeof(led_anim_header_t) == LED_ANIM_HEADER_SIZE, "led_anim header layout");
+
+int led_anim_open(led_anim_t *anim, const char *path) {
+    memset(anim, 0, sizeof(*anim));
+    anim->fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (anim->fd < 0) {
+        fprintf(stderr, "Can't open %s: %s\n", path, strerror(errno));
+        return -1;
+    }
+
+    struct stat st;
+    if (fstat(anim->fd, &st) < 0 || st.st_size < LED_ANIM_HEADER_SIZE) {
+        fprintf(stderr, "%s: not an animation file\n", path);
+        goto fail;
+    }
+    anim->map_len = st.st_size;
+    void *map = mmap(NULL, anim->map_len, PROT_READ, MAP_SHARED, anim->fd, 0);
+    if (map == MAP_FAILED) {
+        fprintf(stderr, "Can't map %s: %s\n", path, strerror(errno));
+        anim->map_len = 0;
+        goto fail;
+    }
+    anim->map = map;
+
+    led_anim_header_t h;
+    memcpy(&h, anim->map, sizeof(h));
+    if (memcmp(h.magic, LED_ANIM_MAGIC, sizeof(h.magic)) != 0 || h.version != LED_ANIM_VERSION ||
+        h.header_size < LED_ANIM_HEADER_SIZE || h.header_size > anim->map_len || h.fps == 0) {
+        fprintf(stderr, "%s: not an animation file (or a newer version)\n", path);
+        goto fail;
+    }
+
+    h.profile[LED_ANIM_PROFILE_LEN - 1] = '\0';
+    anim->profile = ws2812_profile_find(h.profile);
+    if (!anim->profile) {
+        fprintf(stderr, "%s: unknown encoding profile '%s'\n", path, h.profile);
+        goto fail;
+    }
+    size_t bytes_per_led = (size_t)anim->profile->spi_bits * anim->profile->colors;
+    if (h.led_count == 0 || h.frame_bytes != (uint64_t)h.led_count * bytes_per_led) {
+        fprintf(stderr, "%s: %u bytes per frame don't match %u LEDs of %s\n", path,
+                h.frame_bytes, h.led_count, anim->profile->name);
+        goto fail;
+    }
+    // frame_count * frame_bytes may not fit in a size_t: compare by division instead
+    size_t avail = anim->map_len - h.header_size;
+    if (avail / h.frame_bytes < h.frame_count) {
+        fprintf(stderr, "%s: truncated (%u frames in the header)\n", path, h.frame_count);
+        goto fail;
+    }
+
+    anim->frames = anim->map + h.header_size;
+    anim->led_count = h.led_count;
+    anim->frame_count = h.frame_count;
+    anim->fps = h.fps;
+    anim->frame_bytes = h.frame_bytes;
+
+    // Played front to back, and usually looped: read ahead and keep it cached
+    madvise(map, anim->map_len, MADV_SEQUENTIAL);
+    madvise(map, anim->map_len, MADV_WILLNEED);
+    return 0;
+
+fail:
+    led_anim_close(anim);
+    return -1;
+}
+
+void led_anim_close(led_anim_t *anim) {
+    if (anim->map_len) munmap((void *)anim->map, anim->map_len);
+    if (anim->fd >= 0) close(anim->fd);
+    memset(anim, 0, sizeof(*anim));
+    anim->fd = -1;
+}
+
+int led_anim_write_header(FILE *f, const ws2812_profile_t *profile, uint32_t led_count,
+                          uint32_t fps, uint32_t frame_count) {
+    led_anim_header_t h;
+    memset(&h, 0, sizeof(h));
+    memcpy(h.magic, LED_ANIM_MAGIC, sizeof(h.magic));
+    h.version = LED_ANIM_VERSION;
+    h.header_size = LED_ANIM_HEADER_SIZE;
+    h.led_count = led_count;
+    h.frame_count = frame_count;
+    h.fps = fps;
+    h.frame_bytes = led_count * profile->spi_bits * profile->colors;
+    snprintf(h.profile, sizeof(h.profile), "%s", profile->name);
+
+    if (fseek(f, 0, SEEK_SET) < 0 || fwrite(&h, sizeof(h), 1, f) != 1) return -1;
+    return 0;
+}
@@ -0,0 +1,71 @@
+#ifndef LED_ANIM_H
+#define LED_ANIM_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stddef.h>
+#include "ws2812_spi.h"
+
+// --- PRE-ENCODED ANIMATION FILES ---
+// Long, fixed sequences (installations that loop the same show) stored exactly as
+// they go to spidev: a 64 byte header, then every frame encoded with the file's
+// profile (9 bytes per LED for ws2812-3bit, like set_pixel() + show() produce),
+// back to back. The player maps the file and hands each frame's address straight to
+// the SPI ioctl: no encoding, no read() and no copy in user space per frame.
+//
+// Header (little endian, as on the Pi):
+//   0   magic "LEDANIM1"
+//   8   u32 version (1)           12  u32 header size (frames start here)
+//   16  u32 LED count             20  u32 frame count
+//   24  u32 fps                   28  u32 bytes per frame (LED count * bytes per LED)
+//   32  char[24] profile name     56  reserved, 0
+// Brightness, gamma and the power limit are baked in by the converter (led_anim_convert.c).
+
+#define LED_ANIM_MAGIC       "LEDANIM1"
+#define LED_ANIM_VERSION     1
+#define LED_ANIM_HEADER_SIZE 64
+#define LED_ANIM_PROFILE_LEN 24
+#define LED_ANIM_EXT         ".ledanim"
+
+typedef struct {
+    char magic[8];
+    uint32_t version;
+    uint32_t header_size;
+    uint32_t led_count;
+    uint32_t frame_count;
+    uint32_t fps;
+    uint32_t frame_bytes;
+    char profile[LED_ANIM_PROFILE_LEN];
+    uint8_t reserved[8];
+} led_anim_header_t;
+
+typedef struct {
+    int fd;
+    const uint8_t *map;         // Whole file, read only
+    size_t map_len;
+    const ws2812_profile_t *profile;
+    const uint8_t *frames;      // First frame
+    uint32_t led_count;
+    uint32_t frame_count;
+    uint32_t fps;
+    size_t frame_bytes;
+} led_anim_t;
+
+// Maps 'path' and checks the header against the profile table and the file size.
+// Returns 0, or -1 with the reason printed.
+int led_anim_open(led_anim_t *anim, const char *path);
+
+// Unmaps and closes.
+void led_anim_close(led_anim_t *anim);
+
+// Frame 'index' (< frame_count), ready for spi_sched_send() / spi_send_frame().
+static inline const uint8_t *led_anim_frame(const led_anim_t *anim, uint32_t index) {
+    return anim->frames + (size_t)index * anim->frame_bytes;
+}
+
+// Writes a header at the start of 'f'. The converter writes it once with frame_count 0,
+// then again after the last frame. Returns 0 or -1.
+int led_anim_write_header(FILE *f, const ws2812_profile_t *profile, uint32_t led_count,
+                          uint32_t fps, uint32_t frame_count);
+
+#endif
@@ -0,0 +1,112 @@
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "led_anim.h"
+#include "ws2812_spi.h"
+
+// --- CONFIGURATION ---
+#define DEFAULT_FPS 60
+
+// Converts raw RGB frames into a pre-encoded animation file for led_anim_play.
+// Usage: led_anim_convert --leds N [--fps N] [--brightness 0-255] [--gamma]
+//                         [--power-budget mA] [profile] IN.rgb OUT.ledanim
+// The input is frame after frame of N * 3 bytes (R, G, B per LED), e.g. from
+//   ffmpeg -i show.mp4 -vf scale=186:1 -f rawvideo -pix_fmt rgb24 show.rgb
+// ("-" reads stdin). On RGBW profiles the white channel is left off. Brightness,
+// gamma and the power limit are applied here, once, so playback costs nothing.
+
+int main(int argc, char **argv) {
+    const char *profile_name = NULL, *in_path = NULL, *out_path = NULL;
+    long leds = 0;
+    int fps = DEFAULT_FPS, brightness = 255, gamma = 0;
+    long budget_ma = 0;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--leds") == 0 && i + 1 < argc) leds = atol(argv[++i]);
+        else if (strcmp(argv[i], "--fps") == 0 && i + 1 < argc) fps = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--brightness") == 0 && i + 1 < argc) brightness = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--gamma") == 0) gamma = 1;
+        else if (strcmp(argv[i], "--power-budget") == 0 && i + 1 < argc) budget_ma = atol(argv[++i]);
+        else if (!in_path && ws2812_profile_find(argv[i]) && !profile_name) profile_name = argv[i];
+        else if (!in_path) in_path = argv[i];
+        else out_path = argv[i];
+    }
+    if (leds <= 0 || fps <= 0 || brightness < 0 || brightness > 255 || !in_path || !out_path) {
+        fprintf(stderr, "Usage: %s --leds N [--fps N] [--brightness 0-255] [--gamma] "
+                        "[--power-budget mA] [profile] IN.rgb OUT%s\n", argv[0], LED_ANIM_EXT);
+        return 1;
+    }
+    const ws2812_profile_t *profile = ws2812_profile_find(profile_name);
+
+    ws2812_encoder_t enc;
+    if (ws2812_encoder_init(&enc, profile) < 0) return 1;
+    ws2812_correction_t corr = { .brightness = (uint8_t)brightness, .gamma = (uint8_t)gamma,
+                                 .channel_scale = { 255, 255, 255, 255 } };
+    ws2812_set_correction(&enc, &corr);
+    if (budget_ma > 0) ws2812_set_power_budget(&enc, (uint32_t)budget_ma, 0);
+
+    FILE *in = strcmp(in_path, "-") == 0 ? stdin : fopen(in_path, "rb");
+    if (!in) {
+        perror(in_path);
+        return 1;
+    }
+    FILE *out = fopen(out_path, "wb");
+    if (!out) {
+        perror(out_path);
+        return 1;
+    }
+
+    size_t rgb_len = (size_t)leds * 3;
+    size_t frame_bytes = ws2812_frame_bytes(&enc, leds);
+    uint8_t *rgb = malloc(rgb_len);
+    uint8_t *packed = malloc((size_t)leds * profile->colors);
+    uint8_t *frame = malloc(frame_bytes);
+    if (!rgb || !packed || !frame || led_anim_write_header(out, profile, leds, fps, 0) < 0) {
+        fprintf(stderr, "Failed to start %s\n", out_path);
+        goto fail;
+    }
+
+    uint32_t frames = 0;
+    uint64_t limited = 0;
+    size_t got;
+    while ((got = fread(rgb, 1, rgb_len, in)) == rgb_len) {
+        for (long i = 0; i < leds; i++) {
+            const uint8_t *p = rgb + i * 3;
+            ws2812_pack_pixel(&enc, packed + i * profile->colors,
+                              (uint32_t)p[0] << 16 | (uint32_t)p[1] << 8 | p[2]);
+        }
+        ws2812_limit_power(&enc, packed, (size_t)leds * profile->colors);
+        ws2812_encode_packed(&enc, frame, packed, (size_t)leds * profile->colors);
+        if (fwrite(frame, frame_bytes, 1, out) != 1) {
+            perror(out_path);
+            goto fail;
+        }
+        frames++;
+    }
+    limited = enc.frames_limited;
+    if (got) fprintf(stderr, "Ignoring %zu bytes at the end (not a whole frame)\n", got);
+
+    // Now the frame count is known
+    if (led_anim_write_header(out, profile, leds, fps, frames) < 0 || fclose(out) != 0) {
+        out = NULL;
+        perror(out_path);
+        goto fail;
+    }
+    if (in != stdin) fclose(in);
+
+    printf("%s: %u frames of %ld LEDs (%s, %zu bytes each) at %d fps, %.1f s",
+           out_path, frames, leds, profile->name, frame_bytes, fps, (double)frames / fps);
+    if (budget_ma > 0) printf(", %llu frames power limited", (unsigned long long)limited);
+    printf("\n");
+    free(rgb);
+    free(packed);
+    free(frame);
+    return 0;
+
+fail:
+    if (out) fclose(out);
+    unlink(out_path);
+    return 1;
+}
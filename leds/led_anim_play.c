@@ -0,0 +1,132 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+#include <signal.h>
+#include "led_anim.h"
+#include "spi_tx.h"
+#include "../lib/panel_hw.h"
+#include "../common/rt_sched.h"
+#include "../common/arena.h"
+
+// Plays a pre-encoded animation file (led_anim_convert) straight from its mapping.
+// Usage: led_anim_play FILE [--once] [--fps N] [--mock]
+//   --once   stop after the last frame instead of looping
+//   --fps N  play at N fps instead of the rate in the file
+// Frames are due at fixed times from the start. If one goes out late (another
+// process, a long frame), the frames whose time has already passed are skipped, so
+// the show stays in sync with the clock.
+
+volatile sig_atomic_t keep_running = 1;
+
+void signal_handler(int sig) {
+    keep_running = 0;
+}
+
+// Helper: Current time in ns
+uint64_t current_timestamp_ns() {
+    struct timespec te;
+    clock_gettime(CLOCK_MONOTONIC, &te);
+    return (uint64_t)te.tv_sec * 1000000000ULL + (uint64_t)te.tv_nsec;
+}
+
+void sleep_until_ns(uint64_t t) {
+    struct timespec ts = { (time_t)(t / 1000000000ULL), (long)(t % 1000000000ULL) };
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL) == EINTR && keep_running);
+}
+
+int main(int argc, char **argv) {
+    const char *path = NULL;
+    int mock = 0, once = 0, fps = 0;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--mock") == 0) mock = 1;
+        else if (strcmp(argv[i], "--once") == 0) once = 1;
+        else if (strcmp(argv[i], "--fps") == 0 && i + 1 < argc) fps = atoi(argv[++i]);
+        else path = argv[i];
+    }
+    if (!path) {
+        fprintf(stderr, "Usage: %s FILE%s [--once] [--fps N] [--mock]\n", argv[0], LED_ANIM_EXT);
+        return 1;
+    }
+
+    led_anim_t anim;
+    if (led_anim_open(&anim, path) < 0) return 1;
+    if (anim.frame_count == 0) {
+        fprintf(stderr, "%s: no frames\n", path);
+        return 1;
+    }
+    if (fps <= 0) fps = anim.fps;
+    const ws2812_profile_t *profile = anim.profile;
+    if (spi_check_frame_len(anim.frame_bytes) < 0) return 1;
+
+    // PANEL_RT="led=70@2,mlock": the player is the "led" role (common/rt_sched.h)
+    rt_cfg_t rt;
+    if (rt_config_load(&rt) < 0) return 1;
+
+    // The frames stay in the page cache; the only buffer of our own is the black frame
+    // sent at exit, encoded now into a locked block so nothing is allocated later.
+    ws2812_encoder_t enc;
+    uint8_t *black = NULL;
+    if (arena_setup(anim.frame_bytes) < 0 || ws2812_encoder_init(&enc, profile) < 0 ||
+        !(black = arena_calloc(1, anim.frame_bytes))) return 1;
+    for (uint32_t i = 0; i < anim.led_count; i++) {
+        ws2812_encode_pixel(&enc, black + (size_t)i * enc.bytes_per_led, 0);
+    }
+
+    panel_hw_t hw;
+    int want = mock ? PANEL_HW_SPI_MOCK : PANEL_HW_SPI;
+    if (!(panel_hw_open(&hw, want, profile->spi_hz) & want)) {
+        fprintf(stderr, "Did you enable SPI in raspi-config? (--mock runs without the strip)\n");
+        return 1;
+    }
+    rt_apply_self(&rt, RT_ROLE_LED, "player");
+
+    spi_frame_sched_t sched;
+    spi_sched_init(&sched, hw.spi_fd, profile->spi_hz, profile->latch_us);
+
+    signal(SIGINT, signal_handler);
+    signal(SIGTERM, signal_handler);
+
+    printf("Playing %s: %u frames of %u LEDs (%s) at %d fps%s. Ctrl+C to exit.\n", path,
+           anim.frame_count, anim.led_count, profile->name, fps, once ? "" : ", looping");
+
+    uint64_t period_ns = 1000000000ULL / fps;
+    uint64_t start = current_timestamp_ns();
+    uint64_t due = 0, sent = 0, skipped = 0;
+    int errors = 0;
+
+    while (keep_running) {
+        uint32_t index = due % anim.frame_count;
+        if (once && due >= anim.frame_count) break;
+
+        sleep_until_ns(start + due * period_ns);
+        if (!keep_running) break;
+        if (spi_sched_send(&sched, led_anim_frame(&anim, index), anim.frame_bytes) < 0) {
+            if (++errors == 1) perror("SPI transfer");
+        } else {
+            sent++;
+        }
+
+        // Next frame whose time hasn't passed yet
+        uint64_t next = (current_timestamp_ns() - start) / period_ns + 1;
+        if (next <= due) next = due + 1;
+        skipped += next - due - 1;
+        due = next;
+    }
+
+    printf("%llu frames sent, %llu skipped (late), %llu times through, %llu latch waits, %d errors\n",
+           (unsigned long long)sent, (unsigned long long)skipped, (unsigned long long)(due / anim.frame_count),
+           (unsigned long long)sched.latch_waits, errors);
+
+    // --- Cleanup: LEDs off ---
+    spi_sched_send(&sched, black, anim.frame_bytes);
+    arena_free(black);
+    led_anim_close(&anim);
+    panel_hw_close(&hw);
+    arena_teardown();
+    return 0;
+}
@@ -0,0 +1,134 @@
+#define _POSIX_C_SOURCE 199309L
+
+#include <stdint.h>
+#include <unistd.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "ws2812_spi.h"
+#include "spi_tx.h"
+#include "../common/rt_sched.h"
+#include "../common/arena.h"
+#include "../common/shutdown.h"
+
+// --- CONFIGURATION ---
+#define LED_COUNT 186
+#define SPI_DEVICE "/dev/spidev0.0"
+#define SPI_FREQ 2400000
+#define REPORT_EVERY_MS 1000
+#define ARENA_SLACK (4 * 1024) // Alignment
+
+// Chase animation driven as fast as the strip allows.
+// Default: double-buffered, the next frame is encoded while the previous one is on the wire.
+// With --sync: the old blocking path (encode, then send, then encode...), for comparison.
+
+int spi_fd = -1;
+uint8_t grb_buffer[LED_COUNT * 3];
+
+// Helper: Current time in ms
+long long current_timestamp_ms() {
+    struct timespec te;
+    clock_gettime(CLOCK_MONOTONIC, &te);
+    return te.tv_sec * 1000LL + te.tv_nsec / 1000000LL;
+}
+
+// Renders frame 'n' of a chase: a 10-LED tail fading out behind the head
+void render_chase(unsigned n) {
+    memset(grb_buffer, 0, sizeof(grb_buffer));
+    int head = n % LED_COUNT;
+    for (int t = 0; t < 10; t++) {
+        int i = (head - t + LED_COUNT) % LED_COUNT;
+        uint8_t level = (uint8_t)(255 >> t);
+        grb_buffer[i * 3 + 0] = level / 4; // Green
+        grb_buffer[i * 3 + 1] = level;     // Red
+        grb_buffer[i * 3 + 2] = 0;         // Blue
+    }
+}
+
+int main(int argc, char **argv) {
+    int sync_mode = (argc > 1 && strcmp(argv[1], "--sync") == 0);
+    size_t frame_len = sizeof(grb_buffer) * WS2812_SPI_BYTES_PER_COLOR;
+
+    // Ctrl+C on a signalfd, polled between frames (common/shutdown.h). Before
+    // spi_tx_start(), so the transmit thread never takes the signal.
+    int shutdown_fd = shutdown_fd_open();
+    if (shutdown_fd < 0) return 1;
+
+    // PANEL_RT="led=70@2,mlock": SCHED_FIFO / CPU for the transmit thread (common/rt_sched.h)
+    rt_cfg_t rt;
+    if (rt_config_load(&rt) < 0) return 1;
+
+    // Locked block for the encoded frames: the two spi_tx buffers, or the --sync one.
+    // PANEL_ARENA overrides.
+    if (arena_setup(2 * frame_len + ARENA_SLACK) < 0) return 1;
+
+    if ((spi_fd = spi_open(SPI_DEVICE, SPI_FREQ)) < 0) return 1;
+
+    spi_tx_t tx;
+    spi_frame_sched_t sync_sched;
+    uint8_t *sync_buffer = NULL;
+    if (sync_mode) {
+        sync_buffer = arena_calloc(1, frame_len);
+        if (!sync_buffer) return 1;
+        spi_sched_init(&sync_sched, spi_fd, SPI_FREQ, WS2812_LATCH_US);
+    } else if (spi_tx_start(&tx, spi_fd, frame_len, SPI_FREQ, WS2812_LATCH_US) < 0) {
+        return 1;
+    } else {
+        rt_apply(&rt, RT_ROLE_LED, tx.thread, "SPI transmit thread");
+    }
+
+    printf("Chase demo (%s, %s encoder). Ctrl+C to exit.\n",
+           sync_mode ? "blocking write" : "double-buffered", encode_grb_backend());
+
+    unsigned frame = 0;
+    unsigned frames_in_window = 0;
+    long long window_start = current_timestamp_ms();
+
+    while (!shutdown_requested(shutdown_fd)) {
+        render_chase(frame++);
+
+        if (sync_mode) {
+            encode_grb(sync_buffer, grb_buffer, sizeof(grb_buffer));
+            spi_sched_send(&sync_sched, sync_buffer, frame_len);
+        } else {
+            // Encode into the back buffer while the previous frame is on the wire
+            encode_grb(spi_tx_back(&tx), grb_buffer, sizeof(grb_buffer));
+            spi_tx_swap(&tx);
+        }
+        frames_in_window++;
+
+        long long now = current_timestamp_ms();
+        if (now - window_start >= REPORT_EVERY_MS) {
+            printf("\r%.1f fps   ", frames_in_window * 1000.0 / (now - window_start));
+            fflush(stdout);
+            frames_in_window = 0;
+            window_start = now;
+        }
+    }
+
+    // Send one black frame before exiting
+    memset(grb_buffer, 0, sizeof(grb_buffer));
+    spi_frame_sched_t *sched = sync_mode ? &sync_sched : &tx.sched;
+    if (sync_mode) {
+        encode_grb(sync_buffer, grb_buffer, sizeof(grb_buffer));
+        spi_sched_send(&sync_sched, sync_buffer, frame_len);
+        arena_free(sync_buffer);
+    } else {
+        encode_grb(spi_tx_back(&tx), grb_buffer, sizeof(grb_buffer));
+        spi_tx_swap(&tx);
+        spi_tx_flush(&tx);
+        printf("\nErrors: %llu", (unsigned long long)tx.write_errors);
+    }
+    printf("\nFrames: %llu, ioctls: %llu, latch waits: %llu (avg %.0f us)\n",
+           (unsigned long long)sched->frames, (unsigned long long)sched->ioctls,
+           (unsigned long long)sched->latch_waits,
+           sched->latch_waits ? (double)sched->latch_wait_us / sched->latch_waits : 0.0);
+    if (!sync_mode) spi_tx_stop(&tx);
+
+    close(spi_fd);
+    arena_print_stats(stdout);
+    arena_teardown();
+    printf("\nClean exit.\n");
+    return 0;
+}
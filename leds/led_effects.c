@@ -0,0 +1,161 @@
+#include <stdint.h>
+#include <unistd.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <signal.h>
+#include <poll.h>
+#include <termios.h>
+#include "../lib/panel_hw.h"
+#include "../lib/led_strip.h"
+#include "../lib/effects.h"
+#include "../common/rt_sched.h"
+#include "../common/arena.h"
+
+// --- CONFIGURATION ---
+#define LED_COUNT 186
+#define DEFAULT_FPS 60
+#define FPS_STEP 10
+#define LEVEL_STEP 16
+#define POWER_BUDGET_MA 1500 // Frames estimated above this are dimmed as a whole (0 = no limit)
+#define ARENA_SIZE (64 * 1024) // Strip buffers and canvases (PANEL_ARENA overrides)
+
+// Layered effects on the whole strip, rendered by the effects engine's frame clock:
+//   1  rainbow background (dim)
+//   2  orange chase, left to right
+//   3  blue chase, right to left, added on top
+//   4  white breathing zone at the start of the strip
+//   5  status bar at the end of the strip (+/- changes the fill)
+// Usage: led_effects [profile] [--mock] [--fps N]
+
+enum { LAYER_RAINBOW, LAYER_CHASE, LAYER_CHASE_BACK, LAYER_BREATHE, LAYER_BAR, NUM_DEMO_LAYERS };
+
+static const effect_layer_t demo_layers[NUM_DEMO_LAYERS] = {
+    [LAYER_RAINBOW]    = { .type = EFFECT_RAINBOW, .opacity = 40, .period_ms = 8000 },
+    [LAYER_CHASE]      = { .type = EFFECT_CHASE, .color = 0xFF4000, .width = 16, .speed = 60 },
+    [LAYER_CHASE_BACK] = { .type = EFFECT_CHASE, .blend = EFFECT_BLEND_ADD, .color = 0x0040FF,
+                           .width = 8, .speed = -35 },
+    [LAYER_BREATHE]    = { .type = EFFECT_BREATHE, .start = 0, .len = 20, .color = 0xFFFFFF,
+                           .opacity = 160, .period_ms = 3000 },
+    [LAYER_BAR]        = { .type = EFFECT_BAR, .start = LED_COUNT - 36, .len = 36, .color = 0x00FF20,
+                           .color2 = 0x100000, .level = 128 },
+};
+
+panel_hw_t hw;
+led_strip_t strip;
+effects_t fx;
+int layer_on[NUM_DEMO_LAYERS];
+struct termios saved_terminal_settings;
+volatile sig_atomic_t keep_running = 1;
+
+void signal_handler(int sig) {
+    keep_running = 0;
+}
+
+// --- Terminal Control ---
+void restore_terminal_settings() {
+    tcsetattr(STDIN_FILENO, TCSANOW, &saved_terminal_settings);
+}
+
+void set_terminal_raw_mode() {
+    struct termios tattr;
+    if (tcgetattr(STDIN_FILENO, &saved_terminal_settings) < 0) return;
+    tattr = saved_terminal_settings;
+    tattr.c_lflag &= ~(ICANON | ECHO);
+    tattr.c_cc[VMIN] = 1;
+    tattr.c_cc[VTIME] = 0;
+    tcsetattr(STDIN_FILENO, TCSAFLUSH, &tattr);
+    atexit(restore_terminal_settings);
+}
+
+void toggle_layer(int k) {
+    layer_on[k] = !layer_on[k];
+    effects_set_layer(&fx, k, layer_on[k] ? &demo_layers[k] : NULL);
+}
+
+int main(int argc, char **argv) {
+    const char *profile_name = NULL;
+    int mock = 0, fps = DEFAULT_FPS;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--mock") == 0) mock = 1;
+        else if (strcmp(argv[i], "--fps") == 0 && i + 1 < argc) fps = atoi(argv[++i]);
+        else profile_name = argv[i];
+    }
+    const ws2812_profile_t *profile = ws2812_profile_find(profile_name);
+    if (!profile) {
+        fprintf(stderr, "Unknown encoding profile '%s'\n", profile_name);
+        ws2812_print_profiles();
+        return 1;
+    }
+
+    // Priorities / CPUs / mlockall from PANEL_RT: the frame clock thread is "led"
+    rt_cfg_t rt;
+    if (rt_config_load(&rt) < 0 || arena_setup(ARENA_SIZE) < 0) return 1;
+
+    int want = mock ? PANEL_HW_SPI_MOCK : PANEL_HW_SPI;
+    if (!(panel_hw_open(&hw, want, profile->spi_hz) & want)) {
+        fprintf(stderr, "Did you enable SPI in raspi-config? (--mock runs without the strip)\n");
+        return 1;
+    }
+    if (led_strip_init(&strip, hw.spi_fd, LED_COUNT, profile) < 0 ||
+        led_strip_set_power_budget(&strip, POWER_BUDGET_MA) < 0 ||
+        effects_init(&fx, &strip, fps) < 0) {
+        fprintf(stderr, "Failed to set up the LED strip\n");
+        return 1;
+    }
+
+    for (int k = 0; k < NUM_DEMO_LAYERS; k++) toggle_layer(k);
+    uint8_t level = demo_layers[LAYER_BAR].level;
+
+    signal(SIGINT, signal_handler);
+    signal(SIGTERM, signal_handler);
+    if (effects_start(&fx) < 0) return 1;
+    rt_apply(&rt, RT_ROLE_LED, fx.thread, "effects thread");
+
+    printf("Effects on %d LEDs (%s, profile %s) at %d fps\n", LED_COUNT,
+           hw.spi_is_mock ? "mock sink" : PANEL_SPI_DEVICE, profile->name, fx.fps);
+    printf("Keys: 1-5 = toggle layer, +/- = bar level, [/] = fps, q = quit\n");
+    set_terminal_raw_mode();
+
+    // Keys as they come, the achieved frame rate once per second
+    struct pollfd pfd = { STDIN_FILENO, POLLIN, 0 };
+    while (keep_running) {
+        int ret = poll(&pfd, 1, EFFECTS_REPORT_MS);
+        if (ret < 0) continue;
+        if (ret == 0) {
+            printf("\r%5.1f fps (target %d), %llu ticks dropped   ", effects_fps(&fx), fx.fps,
+                   (unsigned long long)fx.dropped);
+            fflush(stdout);
+            continue;
+        }
+
+        // stdin closed: keep animating until a signal
+        char c;
+        if (read(STDIN_FILENO, &c, 1) != 1) {
+            pfd.fd = -1;
+            continue;
+        }
+        if (c == 'q') break;
+        if (c >= '1' && c < '1' + NUM_DEMO_LAYERS) {
+            toggle_layer(c - '1');
+        } else if (c == '+' || c == '-') {
+            int v = level + (c == '+' ? LEVEL_STEP : -LEVEL_STEP);
+            level = v < 0 ? 0 : v > 255 ? 255 : (uint8_t)v;
+            effects_set_level(&fx, LAYER_BAR, level);
+        } else if (c == '[' || c == ']') {
+            effects_set_fps(&fx, fx.fps + (c == ']' ? FPS_STEP : -FPS_STEP));
+        }
+    }
+
+    // --- Cleanup ---
+    effects_stop(&fx);
+    printf("\n");
+    effects_print_stats(&fx, stdout);
+    arena_print_stats(stdout);
+    effects_free(&fx);
+    led_strip_clear(&strip);
+    led_strip_free(&strip);
+    panel_hw_close(&hw);
+    arena_teardown();
+    return 0;
+}
@@ -0,0 +1,101 @@
+#include <stdlib.h>
+#include <string.h>
+#include "led_framebuffer.h"
+#include "../common/arena.h"
+
+#define DIRTY_WORDS(count) (((count) + 63) / 64)
+
+int fb_init(framebuffer_t *fb, uint8_t *spi, size_t count, const ws2812_encoder_t *enc) {
+    memset(fb, 0, sizeof(*fb));
+    fb->pixels = arena_calloc(count, sizeof(uint32_t));
+    fb->dirty = arena_calloc(DIRTY_WORDS(count), sizeof(uint64_t));
+    if (!fb->pixels || !fb->dirty) {
+        fb_free(fb);
+        return -1;
+    }
+    fb->spi = spi;
+    fb->count = count;
+    fb->enc = enc;
+    fb->color_mask = enc->profile->colors == 4 ? 0xFFFFFFFF : 0xFFFFFF;
+    fb_invalidate(fb);
+    return 0;
+}
+
+void fb_free(framebuffer_t *fb) {
+    arena_free(fb->pixels);
+    arena_free(fb->dirty);
+    fb->pixels = NULL;
+    fb->dirty = NULL;
+    fb->count = 0;
+}
+
+static inline void mark_dirty(framebuffer_t *fb, size_t index) {
+    size_t word = index / 64;
+    fb->dirty[word] |= 1ULL << (index % 64);
+    if (word < fb->dirty_lo) fb->dirty_lo = word;
+    if (word >= fb->dirty_hi) fb->dirty_hi = word + 1;
+}
+
+void fb_set(framebuffer_t *fb, size_t index, uint32_t color) {
+    if (index >= fb->count) return;
+    color &= fb->color_mask;
+    if (fb->pixels[index] == color) return;
+    fb->pixels[index] = color;
+    mark_dirty(fb, index);
+}
+
+void fb_fill(framebuffer_t *fb, uint32_t color) {
+    color &= fb->color_mask;
+    for (size_t i = 0; i < fb->count; i++) {
+        if (fb->pixels[i] != color) {
+            fb->pixels[i] = color;
+            mark_dirty(fb, i);
+        }
+    }
+}
+
+void fb_invalidate(framebuffer_t *fb) {
+    size_t words = DIRTY_WORDS(fb->count);
+    if (words == 0) return;
+    memset(fb->dirty, 0xFF, words * sizeof(uint64_t));
+    // Don't leave bits set past the last LED
+    if (fb->count % 64) fb->dirty[words - 1] = (1ULL << (fb->count % 64)) - 1;
+    fb->dirty_lo = 0;
+    fb->dirty_hi = words;
+}
+
+size_t fb_dirty_count(const framebuffer_t *fb) {
+    size_t n = 0;
+    for (size_t w = fb->dirty_lo; w < fb->dirty_hi; w++) n += (size_t)__builtin_popcountll(fb->dirty[w]);
+    return n;
+}
+
+void fb_mark_clean(framebuffer_t *fb) {
+    for (size_t w = fb->dirty_lo; w < fb->dirty_hi; w++) fb->dirty[w] = 0;
+    fb->dirty_lo = DIRTY_WORDS(fb->count);
+    fb->dirty_hi = 0;
+}
+
+size_t fb_flush(framebuffer_t *fb) {
+    size_t encoded = 0;
+
+    for (size_t w = fb->dirty_lo; w < fb->dirty_hi; w++) {
+        uint64_t bits = fb->dirty[w];
+        fb->dirty[w] = 0;
+
+        // Visit only the set bits
+        while (bits) {
+            size_t index = w * 64 + (size_t)__builtin_ctzll(bits);
+            bits &= bits - 1;
+
+            uint8_t *ptr = fb->spi + index * fb->enc->bytes_per_led;
+            ws2812_encode_pixel(fb->enc, ptr, fb->pixels[index]);
+            encoded++;
+        }
+    }
+
+    // Empty range
+    fb->dirty_lo = DIRTY_WORDS(fb->count);
+    fb->dirty_hi = 0;
+    return encoded;
+}
@@ -0,0 +1,53 @@
+#ifndef LED_FRAMEBUFFER_H
+#define LED_FRAMEBUFFER_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "ws2812_spi.h"
+
+// RGB framebuffer with dirty tracking on top of an SPI tx buffer.
+// fb_set()/fb_fill() only record what changed; fb_flush() re-encodes just those
+// pixels into the SPI buffer. WS2812 chains can't be partially addressed, so the
+// whole tx buffer is still sent by show(), but untouched pixels cost nothing.
+typedef struct {
+    uint32_t *pixels;    // 0xRRGGBB (0xWWRRGGBB for RGBW profiles) per LED
+    uint8_t *spi;        // Encoded data area (enc->bytes_per_led per LED), usually tx_buffer
+    size_t count;
+    const ws2812_encoder_t *enc;
+    uint32_t color_mask; // Bits of a color that reach the wire
+    uint64_t *dirty;     // 1 bit per LED
+    size_t dirty_lo;     // Range of dirty words still to scan: [dirty_lo, dirty_hi)
+    size_t dirty_hi;
+} framebuffer_t;
+
+// Sets up the framebuffer for 'count' LEDs encoding into 'spi' with 'enc'.
+// 'spi' must hold ws2812_frame_bytes(enc, count) bytes.
+// All pixels start black and dirty, so the first fb_flush() writes the whole buffer.
+int fb_init(framebuffer_t *fb, uint8_t *spi, size_t count, const ws2812_encoder_t *enc);
+void fb_free(framebuffer_t *fb);
+
+// Sets one pixel. No-op (and not marked dirty) if the color is unchanged.
+void fb_set(framebuffer_t *fb, size_t index, uint32_t color);
+
+static inline uint32_t fb_get(const framebuffer_t *fb, size_t index) {
+    return index < fb->count ? fb->pixels[index] : 0;
+}
+
+// Sets every pixel to 'color', marking only the ones that differ.
+void fb_fill(framebuffer_t *fb, uint32_t color);
+
+// Marks every pixel dirty (e.g. after the SPI buffer was overwritten elsewhere).
+void fb_invalidate(framebuffer_t *fb);
+
+// Number of dirty pixels.
+size_t fb_dirty_count(const framebuffer_t *fb);
+
+// Clears the dirty set without encoding, after the caller wrote the whole SPI
+// buffer from the same pixels another way.
+void fb_mark_clean(framebuffer_t *fb);
+
+// Encodes the dirty pixels into the SPI buffer and clears the dirty set.
+// Returns the number of pixels re-encoded.
+size_t fb_flush(framebuffer_t *fb);
+
+#endif
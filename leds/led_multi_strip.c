@@ -0,0 +1,102 @@
+#define _POSIX_C_SOURCE 199309L
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "strip_manager.h"
+#include "../common/rt_sched.h"
+#include "../common/arena.h"
+#include "../common/shutdown.h"
+
+// --- CONFIGURATION ---
+// One entry per physical strip. The logical LED index runs through them in order.
+// Enable the extra buses in /boot/firmware/config.txt (e.g. dtoverlay=spi1-1cs).
+static const strip_segment_cfg_t SEGMENTS[] = {
+    { "/dev/spidev0.0", 186 },
+    { "/dev/spidev1.0", 186 },
+};
+#define NUM_SEGMENTS (int)(sizeof(SEGMENTS) / sizeof(SEGMENTS[0]))
+#define REPORT_EVERY_MS 1000
+#define POWER_BUDGET_MA 2000   // Supply budget for all strips together (0 = no limit)
+#define ARENA_SLACK (16 * 1024) // Segment table, alignment
+
+// Helper: Current time in ms
+long long current_timestamp_ms() {
+    struct timespec te;
+    clock_gettime(CLOCK_MONOTONIC, &te);
+    return te.tv_sec * 1000LL + te.tv_nsec / 1000000LL;
+}
+
+int main(int argc, char **argv) {
+    strip_manager_t sm;
+
+    // Encoding profile (SPI clock, bits per LED bit, RGB/RGBW) from the first argument
+    const ws2812_profile_t *profile = ws2812_profile_find(argc > 1 ? argv[1] : NULL);
+    if (!profile) {
+        fprintf(stderr, "Unknown encoding profile '%s'\n", argv[1]);
+        ws2812_print_profiles();
+        return 1;
+    }
+
+    // Ctrl+C / SIGTERM arrive on a signalfd, checked once per frame (common/shutdown.h).
+    // Opened before the transmit threads start, so they inherit the blocked signals.
+    int shutdown_fd = shutdown_fd_open();
+    if (shutdown_fd < 0) return 1;
+
+    // PANEL_RT="led=70@2,mlock": every transmit thread gets the "led" setting (common/rt_sched.h)
+    rt_cfg_t rt;
+    if (rt_config_load(&rt) < 0) return 1;
+
+    // Locked block sized from SEGMENTS: two encoded frames per strip plus the packed
+    // framebuffer. PANEL_ARENA overrides.
+    size_t leds = 0;
+    for (int i = 0; i < NUM_SEGMENTS; i++) leds += SEGMENTS[i].count;
+    size_t bytes_per_led = (size_t)profile->spi_bits * profile->colors;
+    if (arena_setup(leds * (2 * bytes_per_led + profile->colors) + ARENA_SLACK) < 0) return 1;
+
+    if (strip_manager_open(&sm, SEGMENTS, NUM_SEGMENTS, profile) < 0) {
+        fprintf(stderr, "Failed to open the LED strips.\n");
+        return 1;
+    }
+    ws2812_set_power_budget(&sm.enc, POWER_BUDGET_MA, 0);
+    for (int i = 0; i < sm.num_segments; i++) {
+        rt_apply(&rt, RT_ROLE_LED, sm.segments[i].tx.thread, sm.segments[i].device);
+    }
+
+    printf("Multi-strip chase: %zu LEDs on %d strips (%s). Ctrl+C to exit.\n",
+           sm.total, sm.num_segments, profile->name);
+    for (int i = 0; i < sm.num_segments; i++) {
+        printf("  %s: LEDs %zu-%zu\n", sm.segments[i].device,
+               sm.segments[i].first, sm.segments[i].first + sm.segments[i].count - 1);
+    }
+
+    // A single dot that runs across all strips as one logical chain
+    size_t head = 0;
+    unsigned frames_in_window = 0;
+    long long window_start = current_timestamp_ms();
+
+    while (!shutdown_requested(shutdown_fd)) {
+        strip_set_pixel(&sm, head, 0x000000);
+        head = (head + 1) % sm.total;
+        strip_set_pixel(&sm, head, 0x404040);
+        strip_manager_show(&sm);
+        frames_in_window++;
+
+        long long now = current_timestamp_ms();
+        if (now - window_start >= REPORT_EVERY_MS) {
+            printf("\r%.1f fps   ", frames_in_window * 1000.0 / (now - window_start));
+            fflush(stdout);
+            frames_in_window = 0;
+            window_start = now;
+        }
+    }
+
+    strip_manager_close(&sm);
+    printf("\n");
+    arena_print_stats(stdout);
+    arena_teardown();
+    printf("Clean exit.\n");
+    return 0;
+}
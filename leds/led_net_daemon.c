@@ -0,0 +1,141 @@
+#define _GNU_SOURCE // struct mmsghdr (net_ingest.h)
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <signal.h>
+#include "strip_manager.h"
+#include "net_ingest.h"
+#include "../common/rt_sched.h"
+#include "../common/arena.h"
+
+// --- CONFIGURATION ---
+#define MAX_STRIPS 8
+#define DEFAULT_DEVICE "/dev/spidev0.0"
+#define DEFAULT_COUNT 186
+#define REPORT_EVERY_MS 1000
+#define ARENA_SLACK (16 * 1024) // Per-segment state, alignment
+
+// Shows pixel frames sent over the network (DDP and/or E1.31) on one or more strips.
+// Usage: led_net_daemon [--strip DEV:COUNT]... [--ddp-port N] [--e131 UNIVERSE] [profile]
+//   --strip mock:186   runs on a mock sink with wire timing instead of spidev
+//   --ddp-port 0       turns DDP off (default 4048); --e131 1 listens for universes 1, 2, ...
+
+volatile sig_atomic_t keep_running = 1;
+
+void signal_handler(int sig) {
+    keep_running = 0;
+}
+
+// Helper: Current time in ms
+long long current_timestamp_ms() {
+    struct timespec te;
+    clock_gettime(CLOCK_MONOTONIC, &te);
+    return te.tv_sec * 1000LL + te.tv_nsec / 1000000LL;
+}
+
+int main(int argc, char **argv) {
+    strip_segment_cfg_t strips[MAX_STRIPS];
+    int num_strips = 0, ddp_port = NET_DDP_PORT, e131_universe = 0;
+    const char *profile_name = NULL;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--strip") == 0 && i + 1 < argc) {
+            char *spec = argv[++i], *colon = strrchr(spec, ':');
+            if (!colon || num_strips == MAX_STRIPS || atoi(colon + 1) <= 0) {
+                fprintf(stderr, "Bad --strip '%s' (DEV:COUNT, at most %d)\n", spec, MAX_STRIPS);
+                return 1;
+            }
+            *colon = '\0';
+            strips[num_strips++] = (strip_segment_cfg_t){ spec, (size_t)atoi(colon + 1) };
+        } else if (strcmp(argv[i], "--ddp-port") == 0 && i + 1 < argc) {
+            ddp_port = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--e131") == 0 && i + 1 < argc) {
+            e131_universe = atoi(argv[++i]);
+        } else {
+            profile_name = argv[i];
+        }
+    }
+    if (num_strips == 0) strips[num_strips++] = (strip_segment_cfg_t){ DEFAULT_DEVICE, DEFAULT_COUNT };
+    if (ddp_port <= 0 && e131_universe <= 0) {
+        fprintf(stderr, "Nothing to listen on: enable DDP or E1.31\n");
+        return 1;
+    }
+
+    const ws2812_profile_t *profile = ws2812_profile_find(profile_name);
+    if (!profile) {
+        fprintf(stderr, "Unknown encoding profile '%s'\n", profile_name);
+        ws2812_print_profiles();
+        return 1;
+    }
+
+    signal(SIGINT, signal_handler);
+    signal(SIGTERM, signal_handler);
+
+    // PANEL_RT="led=70@2,mlock": every transmit thread gets the "led" setting (common/rt_sched.h)
+    rt_cfg_t rt;
+    if (rt_config_load(&rt) < 0) return 1;
+
+    // Locked block sized from the strip list: two encoded frames per strip, the packed
+    // framebuffer and one receive batch. PANEL_ARENA overrides.
+    size_t leds = 0;
+    for (int i = 0; i < num_strips; i++) leds += strips[i].count;
+    size_t bytes_per_led = (size_t)profile->spi_bits * profile->colors;
+    if (arena_setup(leds * (2 * bytes_per_led + profile->colors) + NET_BATCH * NET_PACKET_MAX +
+                    ARENA_SLACK) < 0) return 1;
+
+    strip_manager_t sm;
+    net_ingest_t ni;
+    if (strip_manager_open(&sm, strips, num_strips, profile) < 0) {
+        fprintf(stderr, "Failed to open the LED strips.\n");
+        return 1;
+    }
+    if (net_ingest_open(&ni, &sm, ddp_port, e131_universe) < 0) {
+        strip_manager_close(&sm);
+        return 1;
+    }
+    for (int i = 0; i < sm.num_segments; i++) {
+        rt_apply(&rt, RT_ROLE_LED, sm.segments[i].tx.thread, sm.segments[i].device);
+    }
+
+    printf("Network LEDs: %zu LEDs on %d strips (%s)", sm.total, sm.num_segments, profile->name);
+    if (ni.ddp_fd >= 0) printf(", DDP on port %d", ddp_port);
+    if (ni.e131_fd >= 0) printf(", E1.31 universes %d-%d", e131_universe, e131_universe + ni.e131_universes - 1);
+    printf(". Ctrl+C to exit.\n");
+    for (int i = 0; i < sm.num_segments; i++) {
+        printf("  %s: LEDs %zu-%zu\n", sm.segments[i].device,
+               sm.segments[i].first, sm.segments[i].first + sm.segments[i].count - 1);
+    }
+
+    // Rates from the counter deltas over each report window
+    net_ingest_t last = ni;
+    long long window_start = current_timestamp_ms();
+
+    while (keep_running) {
+        if (net_ingest_poll(&ni, REPORT_EVERY_MS) < 0) break;
+
+        long long now = current_timestamp_ms();
+        if (now - window_start >= REPORT_EVERY_MS) {
+            double s = (now - window_start) / 1000.0;
+            printf("\r%7.0f packets/s  %5.1f fps  %llu late  %llu dropped  %llu bad   ",
+                   (ni.packets - last.packets) / s, (ni.frames_shown - last.frames_shown) / s,
+                   (unsigned long long)(ni.late_packets - last.late_packets),
+                   (unsigned long long)(ni.frames_dropped - last.frames_dropped),
+                   (unsigned long long)(ni.bad_packets - last.bad_packets));
+            fflush(stdout);
+            last = ni;
+            window_start = now;
+        }
+    }
+
+    printf("\n");
+    net_ingest_print_stats(&ni, stdout);
+    arena_print_stats(stdout);
+    net_ingest_close(&ni);
+    strip_manager_close(&sm);
+    arena_teardown();
+    printf("Clean exit.\n");
+    return 0;
+}
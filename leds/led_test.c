@@ -3,8 +3,8 @@
 #include <stdlib.h>
 #include <string.h>
 #include <unistd.h>
-#include <signal.h>
 #include "ws2811.h"
+#include "../common/shutdown.h"
 
 // --- CONFIGURATION ---
 #define TARGET_FREQ     WS2811_TARGET_FREQ
@@ -34,8 +34,10 @@ ws2811_t ledstring = {
     },
 };
 
-// Signal handler to clear LEDs on Ctrl+C
-void cleanup(int signum) {
+int shutdown_fd = -1; // Ctrl+C / SIGTERM arrive here, handled in main()
+
+// Clears the LEDs on Ctrl+C
+void cleanup() {
     printf("\nInterrupted! Clearing LEDs and exiting...\n");
     
     // Turn off all LEDs
@@ -43,16 +45,26 @@ void cleanup(int signum) {
         ledstring.channel[0].leds[i] = 0;
     }
     ws2811_render(&ledstring);
-    ws2811_fini(&ledstring);
-    exit(signum);
+}
+
+// Waits for ENTER. Returns 0, or -1 on Ctrl+C / end of input.
+int wait_for_enter() {
+    char c;
+    do {
+        if (shutdown_wait(shutdown_fd, STDIN_FILENO, -1) < 0) return -1;
+        if (read(STDIN_FILENO, &c, 1) != 1) return -1;
+    } while (c != '\n');
+    return 0;
 }
 
 int main() {
     ws2811_return_t ret;
 
-    // Register signal handlers for clean exit
-    signal(SIGINT, cleanup);
-    signal(SIGTERM, cleanup);
+    // Signals for a clean exit come through a signalfd, not a handler
+    if ((shutdown_fd = shutdown_fd_open()) < 0) {
+        perror("signalfd");
+        return 1;
+    }
 
     // Initialize the library
     if ((ret = ws2811_init(&ledstring)) != WS2811_SUCCESS) {
@@ -87,7 +99,10 @@ int main() {
         fflush(stdout);
 
         // 4. Wait for Enter key
-        while(getchar() != '\n');
+        if (wait_for_enter() < 0) {
+            cleanup();
+            break;
+        }
 
         // 5. Turn OFF current LED before moving to next
         ledstring.channel[0].leds[i] = 0; 
@@ -1,145 +1,89 @@
 #include <stdint.h>
-#include <unistd.h>
 #include <stdio.h>
 #include <stdlib.h>
-#include <string.h>
-#include <fcntl.h>
-#include <sys/ioctl.h>
-#include <linux/types.h>
-#include <linux/spi/spidev.h>
-#include <signal.h>
+#include <unistd.h>
+#include "../lib/panel_hw.h"
+#include "../lib/led_strip.h"
+#include "../common/arena.h"
+#include "../common/shutdown.h"
 
 // --- CONFIGURATION ---
 #define LED_COUNT 186
-#define SPI_DEVICE "/dev/spidev0.0"
-#define SPI_FREQ 2400000 
-#define BITS_PER_PIXEL 24
-#define SPI_BITS_PER_LED_BIT 3
-
-int spi_fd = -1;
-uint8_t *tx_buffer = NULL;
-size_t tx_buffer_len = 0;
+#define POWER_BUDGET_MA 1500 // Frames estimated above this are dimmed as a whole (0 = no limit)
+#define ARENA_SIZE (64 * 1024) // Strip buffers (PANEL_ARENA overrides)
+// SPI device: PANEL_SPI_DEVICE in lib/panel_hw.h.
+// SPI clock, SPI bits per LED bit and color count come from the encoding profile
+// (first argument, default ws2812-3bit). See ws2812_profiles[] in ws2812_spi.c.
+
+panel_hw_t hw;     // SPI fd, opened once
+led_strip_t strip; // Encoder, framebuffer, tx buffer and frame scheduler
+
+int shutdown_fd = -1; // Ctrl+C arrives here, handled in main()
+
+// Waits for ENTER. Returns 0, or -1 on Ctrl+C / end of input.
+int wait_for_enter() {
+    char c;
+    do {
+        if (shutdown_wait(shutdown_fd, STDIN_FILENO, -1) < 0) return -1;
+        if (read(STDIN_FILENO, &c, 1) != 1) return -1;
+    } while (c != '\n');
+    return 0;
+}
 
-// Signal handler to clean up
-void cleanup(int signum) {
-    if (tx_buffer) {
-        // Clear buffer (all zeros = all LEDs off)
-        memset(tx_buffer, 0, tx_buffer_len);
-        if (spi_fd >= 0) write(spi_fd, tx_buffer, tx_buffer_len);
-        free(tx_buffer);
+void cleanup() {
+    if (strip.tx_buffer) {
+        // Send "Black" to all LEDs to turn them off physically
+        led_strip_clear(&strip);
+        led_strip_free(&strip);
     }
-    if (spi_fd >= 0) close(spi_fd);
+    panel_hw_close(&hw);
+    arena_teardown();
     printf("\nExiting and clearing LEDs.\n");
-    exit(0);
 }
 
-// Initialize SPI port
-int spi_init() {
-    uint8_t mode = SPI_MODE_0;
-    uint8_t bits = 8;
-    uint32_t speed = SPI_FREQ;
-
-    if ((spi_fd = open(SPI_DEVICE, O_RDWR)) < 0) {
-        perror("Failed to open SPI device. Did you enable it in raspi-config?");
-        return -1;
+int main(int argc, char **argv) {
+    const ws2812_profile_t *profile = ws2812_profile_find(argc > 1 ? argv[1] : NULL);
+    if (!profile) {
+        fprintf(stderr, "Unknown encoding profile '%s'\n", argv[1]);
+        ws2812_print_profiles();
+        return 1;
     }
 
-    if (ioctl(spi_fd, SPI_IOC_WR_MODE, &mode) < 0) return -1;
-    if (ioctl(spi_fd, SPI_IOC_WR_BITS_PER_WORD, &bits) < 0) return -1;
-    if (ioctl(spi_fd, SPI_IOC_WR_MAX_SPEED_HZ, &speed) < 0) return -1;
+    // Every buffer comes out of one locked block; Ctrl+C is read from a signalfd
+    if (arena_setup(ARENA_SIZE) < 0 || (shutdown_fd = shutdown_fd_open()) < 0) return 1;
 
-    // Calculate buffer size:
-    // (LEDs * 24 bits-color * 3 bits-spi) / 8 bits-per-byte
-    tx_buffer_len = (LED_COUNT * BITS_PER_PIXEL * SPI_BITS_PER_LED_BIT) / 8;
-    
-    // Add reset padding (>280us low). At 2.4MHz, 100 bytes is plenty.
-    tx_buffer_len += 100; 
-
-    tx_buffer = malloc(tx_buffer_len);
-    if (!tx_buffer) {
-        fprintf(stderr, "Failed to allocate memory\n");
-        return -1;
+    if (!(panel_hw_open(&hw, PANEL_HW_SPI, profile->spi_hz) & PANEL_HW_SPI)) {
+        fprintf(stderr, "Did you enable SPI in raspi-config?\n");
+        return 1;
     }
-    memset(tx_buffer, 0, tx_buffer_len);
-    
-    return 0;
-}
-
-// Helper: Encodes a single color byte (8 bits) into 3 SPI bytes (24 bits)
-void encode_byte(uint8_t val, uint8_t *ptr) {
-    // We generate 3 SPI bytes for the 8 bits of 'val'
-    // 1 WS bit = 3 SPI bits. 
-    // Data 0 = 100 (binary)
-    // Data 1 = 110 (binary)
-    
-    uint32_t p = 0;
-    for (int b = 7; b >= 0; b--) {
-        // Shift existing pattern to make room
-        // OR in the new 3-bit pattern (110 or 100)
-        p = (p << 3) | (((val >> b) & 1) ? 0b110 : 0b100);
+    if (led_strip_init(&strip, hw.spi_fd, LED_COUNT, profile) < 0 ||
+        led_strip_set_power_budget(&strip, POWER_BUDGET_MA) < 0) {
+        fprintf(stderr, "Failed to set up the LED strip\n");
+        return 1;
     }
-    
-    // Write 3 bytes to the buffer (MSB first)
-    ptr[0] = (p >> 16) & 0xFF;
-    ptr[1] = (p >> 8) & 0xFF;
-    ptr[2] = p & 0xFF;
-}
-
-void set_pixel(int index, uint32_t color) {
-    if (index < 0 || index >= LED_COUNT) return;
 
-    // Extract RGB
-    uint8_t r = (color >> 16) & 0xFF;
-    uint8_t g = (color >> 8) & 0xFF;
-    uint8_t b = color & 0xFF;
-
-    // Offset in buffer: index * 9 bytes (because 24 bits * 3 SPI bits / 8 = 9 bytes)
-    uint8_t *ptr = tx_buffer + (index * 9); 
-
-    // WS2812B expects GRB order
-    encode_byte(g, ptr);      // Green first (Bytes 0-2)
-    encode_byte(r, ptr + 3);  // Red next (Bytes 3-5)
-    encode_byte(b, ptr + 6);  // Blue last (Bytes 6-8)
-}
-
-void show() {
-    if (spi_fd < 0) return; // Guard against uninitialized FD
-    if (write(spi_fd, tx_buffer, tx_buffer_len) < 0) {
-        perror("SPI Write failed");
-    }
-}
-
-void clear() {
-    // Zero out data (leaving the reset padding at the end alone is fine, or zero it all)
-    memset(tx_buffer, 0, tx_buffer_len);
-    show();
-}
-
-int main() {
-    signal(SIGINT, cleanup);
-    
-    if (spi_init() < 0) return 1;
-
-    printf("SPI WS2812B Test Started (Pi 5 Compatible)\n");
+    // Single-pixel updates use the table; full frames use encode_grb() when the profile allows
+    printf("SPI WS2812B Test Started (Pi 5 Compatible, profile %s, full frames: %s encoder)\n",
+           profile->name, strip.enc.fast_grb ? encode_grb_backend() : "table");
     printf("Controls: Press ENTER for next LED. Ctrl+C to exit.\n\n");
 
-    clear();
+    led_strip_clear(&strip);
 
     for (int i = 0; i < LED_COUNT; i++) {
         // Set Pixel 'i' to White (0xFFFFFF)
-        set_pixel(i, 0xFFFFFF);
-        show();
+        led_strip_set(&strip, i, 0xFFFFFF);
+        led_strip_show(&strip);
 
         printf("LED %d is ON. Press ENTER...", i + 1);
         fflush(stdout);
-        while(getchar() != '\n');
+        if (wait_for_enter() < 0) break;
 
         // Turn it off
-        set_pixel(i, 0x000000);
-        show();
+        led_strip_set(&strip, i, 0x000000);
+        led_strip_show(&strip);
     }
 
     printf("\nDone!\n");
-    cleanup(0);
+    cleanup();
     return 0;
-}
\ No newline at end of file
+}
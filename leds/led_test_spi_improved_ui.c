@@ -1,32 +1,35 @@
 #include <stdint.h>
 #include <unistd.h>
 #include <stdio.h>
-#include <math.h>
 #include <stdlib.h>
 #include <string.h>
-#include <fcntl.h>
-#include <sys/ioctl.h>
-#include <linux/types.h>
-#include <linux/spi/spidev.h>
-#include <signal.h>
 #include <termios.h> 
+#include <stdbool.h>
+#include "../lib/panel_hw.h"
+#include "../lib/led_strip.h"
+#include "../common/log_ring.h"
+#include "../common/arena.h"
+#include "../common/shutdown.h"
 
 // --- CONFIGURATION ---
 #define LED_COUNT 186
-#define SPI_DEVICE "/dev/spidev0.0"
-#define SPI_FREQ 2400000 
-#define BITS_PER_PIXEL 24
-#define SPI_BITS_PER_LED_BIT 3
+// SPI device: PANEL_SPI_DEVICE in lib/panel_hw.h.
+// SPI clock and SPI bits per LED bit come from the encoding profile
+// (first argument, default ws2812-3bit). See ws2812_profiles[] in ws2812_spi.c.
 #define COLOR_STEP 16 
 #define INTENSITY_STEP 20 
+#define USE_GAMMA 1 // Gamma 2.8: brightness steps look even to the eye
+#define ARENA_SIZE (256 * 1024) // Strip buffers + log rings (PANEL_ARENA overrides)
 
 // Global state
-int spi_fd = -1;
-uint8_t *tx_buffer = NULL;
-size_t tx_buffer_len = 0;
+panel_hw_t hw; // SPI fd, opened once
+led_strip_t strip; // Encoder tables, RGB pixels + dirty set, tx buffer, frame scheduler
+int lit_led_index = -1; // LED currently showing a color (-1 = none)
 struct termios saved_terminal_settings;
 int current_led_index = 0;
 uint32_t current_color = 0x8F8F8F; 
+int brightness = 255; // Global brightness, applied by the encoder tables
+int shutdown_fd = -1; // Ctrl+C arrives here, next to the keys
 
 // Forward declarations
 void show();
@@ -60,66 +63,25 @@ void set_terminal_raw_mode() {
 
 // --- SPI and LED Control ---
 
-// Initialize SPI port
-int spi_init() {
-    uint8_t mode = SPI_MODE_0;
-    uint8_t bits = 8;
-    uint32_t speed = SPI_FREQ;
+// Initialize SPI port and the strip
+int spi_init(const ws2812_profile_t *profile) {
+    if (!(panel_hw_open(&hw, PANEL_HW_SPI, profile->spi_hz) & PANEL_HW_SPI)) return -1;
+    if (led_strip_init(&strip, hw.spi_fd, LED_COUNT, profile) < 0) return -1;
 
-    if ((spi_fd = open(SPI_DEVICE, O_RDWR)) < 0) {
-        perror("Failed to open SPI device");
-        return -1;
-    }
-
-    if (ioctl(spi_fd, SPI_IOC_WR_MODE, &mode) < 0) return -1;
-    if (ioctl(spi_fd, SPI_IOC_WR_BITS_PER_WORD, &bits) < 0) return -1;
-    if (ioctl(spi_fd, SPI_IOC_WR_MAX_SPEED_HZ, &speed) < 0) return -1;
+    ws2812_correction_t corr = { 255, USE_GAMMA, { 255, 255, 255, 255 } };
+    ws2812_set_correction(&strip.enc, &corr);
 
-    // Calculate data_len: (LEDs * 24 bits-color * 3 bits-spi) / 8 bits-per-byte
-    size_t data_len = (LED_COUNT * BITS_PER_PIXEL * SPI_BITS_PER_LED_BIT) / 8;
-    tx_buffer_len = data_len + 100; // + Padding for Reset
-
-    tx_buffer = malloc(tx_buffer_len);
-    if (!tx_buffer) return -1;
-    
-    // Initialize strip to Black
-    fill_black();
+    // All pixels start black and dirty, so the first show() encodes the whole strip
     show();
     
     return 0;
 }
 
-// Fills the buffer with the SPI pattern for "Off" (RGB 0,0,0)
-// memset(0) sends RESET signals. This sends "Black" data.
+// Sets every pixel to "Off" (RGB 0,0,0).
+// Only pixels that were lit get re-encoded on the next show(); the rest of
+// the buffer already holds the "Black" pattern (0x92 0x49 0x24 per color byte).
 void fill_black() {
-    // The SPI pattern for a byte '0' (00000000) at 2.4MHz is:
-    // 100 100 100 100 100 100 100 100 (binary)
-    // Grouped into 3 SPI bytes: 10010010 (0x92), 01001001 (0x49), 00100100 (0x24)
-    const uint8_t black_pattern[3] = {0x92, 0x49, 0x24};
-    
-    // Fill the data area of the buffer with this pattern
-    for (int i = 0; i < LED_COUNT * 3; i++) { // 3 bytes per pixel color * 3 colors = 9 bytes/LED
-        // We write 9 bytes per LED. The pattern repeats every 3 bytes.
-        tx_buffer[i * 3 + 0] = black_pattern[0];
-        tx_buffer[i * 3 + 1] = black_pattern[1];
-        tx_buffer[i * 3 + 2] = black_pattern[2];
-    }
-    
-    // Zero out the padding area at the end to ensure a RESET happens AFTER data
-    size_t data_end = (LED_COUNT * 9);
-    memset(tx_buffer + data_end, 0, tx_buffer_len - data_end);
-}
-
-void encode_byte(uint8_t val, uint8_t *ptr) {
-    uint32_t p = 0;
-    for (int b = 7; b >= 0; b--) {
-        // Data 1 = 110 (binary), Data 0 = 100 (binary)
-        p = (p << 3) | (((val >> b) & 1) ? 0b110 : 0b100);
-    }
-    // Write 3 bytes to the buffer (MSB first)
-    ptr[0] = (p >> 16) & 0xFF;
-    ptr[1] = (p >> 8) & 0xFF;
-    ptr[2] = p & 0xFF;
+    led_strip_fill(&strip, 0x000000);
 }
 
 void set_pixel(int index, uint32_t color) {
@@ -130,40 +92,42 @@ void set_pixel(int index, uint32_t color) {
     uint8_t g = (color >> 8) & 0xFF;
     uint8_t b = color & 0xFF;
 
-    // Offset: 9 bytes per LED
-    uint8_t *ptr = tx_buffer + (index * 9); 
-    printf("Setting pixel %d to color R=%d G=%d B=%d\n", index, r, g, b);
+    // Compiled out unless built with -DLOG_LEVEL=LOG_LEVEL_DEBUG
+    LOG_DEBUG("Setting pixel %d to color R=%d G=%d B=%d\n", index, r, g, b);
 
-    // WS2812B expects GRB order
-    encode_byte(g, ptr);      // Green first (Bytes 0-2)
-    encode_byte(r, ptr + 3);  // Red next (Bytes 3-5)
-    encode_byte(b, ptr + 6);  // Blue last (Bytes 6-8)
+    // Encoded (GRB, 9 bytes per LED) on the next show(), only if it changed
+    led_strip_set(&strip, index, color);
 }
 
 void show() {
-    if (spi_fd >= 0) if (write(spi_fd, tx_buffer, tx_buffer_len) < 0) perror("SPI Write failed");
+    // Re-encode only the pixels changed since the last frame
+    if (strip.tx_buffer) led_strip_show(&strip);
 }
 
-void cleanup(int signum) {
-    if (tx_buffer) {
+void cleanup() {
+    if (strip.tx_buffer) {
         // Send "Black" to all LEDs to turn them off physically
         fill_black();
         show();
-        free(tx_buffer);
+        led_strip_free(&strip);
     }
-    if (spi_fd >= 0) close(spi_fd);
+    panel_hw_close(&hw);
     restore_terminal_settings();
+    log_stop();
+    arena_teardown();
     printf("\nClean exit.\n");
-    exit(0);
 }
 
 void update_display() {
-    // 1. Fill buffer with "Black" patterns (Logic 0)
-    fill_black();
-    
+    // 1. Turn off the previously lit LED (the rest are already black)
+    if (lit_led_index >= 0 && lit_led_index != current_led_index) {
+        set_pixel(lit_led_index, 0x000000);
+    }
+
     // 2. Overwrite the specific LED with color
     set_pixel(current_led_index, current_color);
-    
+    lit_led_index = current_led_index;
+
     // 3. Send
     show();
 }
@@ -180,9 +144,10 @@ void print_status() {
     uint8_t g = (current_color >> 8) & 0xFF;
     uint8_t b = current_color & 0xFF;
     
-    // Use ANSI codes to clear the line and print the status
-    printf("\r\033[KLED: %03d/%03d | Color: R=%03d G=%03d B=%03d", 
-           current_led_index + 1, LED_COUNT, r, g, b);
+    // Debug lines first, then clear the line and print the status (ANSI codes)
+    log_flush();
+    printf("\r\033[KLED: %03d/%03d | Color: R=%03d G=%03d B=%03d | Brightness: %03d", 
+           current_led_index + 1, LED_COUNT, r, g, b, brightness);
     fflush(stdout);
 }
 
@@ -190,7 +155,7 @@ void print_help() {
     printf("\n--- Interactive LED Controller ---\n");
     printf("Controls:\n");
     printf("  [a/s]: next/previous LED (circular)\n");
-    printf("  [d/f]: +/- intensity\n");
+    printf("  [d/f]: +/- brightness\n");
     printf("  [e/r/t]: make color more Red/Green/Blue\n");
     printf("  [w]: Set color to White\n");
     printf("  [q]: Close program\n");
@@ -200,12 +165,21 @@ void print_help() {
 
 // --- Main Logic ---
 
-int main() {
-    // Set up signal handler for cleanup (Ctrl+C)
-    signal(SIGINT, cleanup);
+int main(int argc, char **argv) {
+    const ws2812_profile_t *profile = ws2812_profile_find(argc > 1 ? argv[1] : NULL);
+    if (!profile) {
+        fprintf(stderr, "Unknown encoding profile '%s'\n", argv[1]);
+        ws2812_print_profiles();
+        return 1;
+    }
+
+    // Buffers and log rings from one locked block. Ctrl+C comes in through a signalfd,
+    // opened before log_start() so the log thread has the signals blocked too.
+    if (arena_setup(ARENA_SIZE) < 0 || (shutdown_fd = shutdown_fd_open()) < 0) return 1;
+    log_start(stdout);
     
     // Initialize SPI
-    if (spi_init() < 0) {
+    if (spi_init(profile) < 0) {
         fprintf(stderr, "SPI Initialization failed.\n");
         return 1;
     }
@@ -220,9 +194,11 @@ int main() {
     print_status();
 
     char command;
-    while (true) {
-        // Read a single character immediately
-        if (read(STDIN_FILENO, &command, 1) < 1) continue;
+    bool quit = false;
+    while (!quit) {
+        // A key as soon as it is pressed, unless Ctrl+C came first
+        if (shutdown_wait(shutdown_fd, STDIN_FILENO, -1) < 0) break;
+        if (read(STDIN_FILENO, &command, 1) < 1) break;
 
         uint8_t r = (current_color >> 16) & 0xFF;
         uint8_t g = (current_color >> 8) & 0xFF;
@@ -231,8 +207,8 @@ int main() {
         // Process the command
         switch (command) {
             case 'q': // Quit
-                cleanup(0);
-                break;
+                quit = true;
+                continue;
 
             case 'a': // Next LED (circular)
                 current_led_index = (current_led_index + 1) % LED_COUNT;
@@ -267,62 +243,13 @@ int main() {
                 current_color = 0x8F8F8F;
                 break;
 
-            case 'd': // Increase Intensity (scale all RGB components)
-            {
-                uint8_t max_val = r > g ? (r > b ? r : b) : (g > b ? g : b);
-
-                // Handle the "black" edge case (R=G=B=0)
-                if (max_val == 0) {
-                    r = INTENSITY_STEP;
-                    g = INTENSITY_STEP;
-                    b = INTENSITY_STEP;
-                } else {
-                    // Calculate the new target maximum value (clamped at 255)
-                    uint8_t new_max_val = (uint8_t)clamp(max_val + INTENSITY_STEP);
-
-                    // If the color is already saturated (max_val == 255) or the increase was 0,
-                    // and new_max_val == max_val, no further change is needed.
-                    if (new_max_val == max_val) {
-                        break;
-                    }
-
-                    // Calculate the scaling factor (always > 1.0)
-                    // floating-point for precise ratio preservation.
-                    double scale_factor = (double)new_max_val / max_val;
-
-                    // Apply the scaling and update the components, rounding the result
-                    r = (uint8_t)round((double)r * scale_factor);
-                    g = (uint8_t)round((double)g * scale_factor);
-                    b = (uint8_t)round((double)b * scale_factor);
-                }
-                
-                current_color = (r << 16) | (g << 8) | b;
-                break;
-            }
-                
-            case 'f': // Decrease Intensity (scale all RGB components)
-            {
-                uint8_t max_val = r > g ? (r > b ? r : b) : (g > b ? g : b);
-                if (max_val == 0) {
-                    // Already black, no change
-                    break;
-                }
-            
-                // Clamp at 0. If the decrease amount is larger than max_val, it becomes black.
-                uint8_t new_max_val = (uint8_t)clamp(max_val - INTENSITY_STEP);
-
-                // Calculate the scaling factor (always < 1.0)
-                // floating-point for precise ratio preservation.
-                double scale_factor = (double)new_max_val / max_val;
-
-                // Apply the scaling and update the components, rounding the result
-                r = (uint8_t)round((double)r * scale_factor);
-                g = (uint8_t)round((double)g * scale_factor);
-                b = (uint8_t)round((double)b * scale_factor);
-                
-                current_color = (r << 16) | (g << 8) | b;
+            case 'd': // Increase brightness
+            case 'f': // Decrease brightness
+                brightness = clamp(brightness + (command == 'd' ? INTENSITY_STEP : -INTENSITY_STEP));
+                // The tables change, not the colors: every pixel has to be encoded again
+                ws2812_set_brightness(&strip.enc, (uint8_t)brightness);
+                fb_invalidate(&strip.fb);
                 break;
-            }
 
             default:
                 // Ignore other keys
@@ -332,5 +259,6 @@ int main() {
         // Print status after every command
         print_status();
     }
+    cleanup();
     return 0;
 }
\ No newline at end of file
@@ -0,0 +1,364 @@
+#define _GNU_SOURCE // recvmmsg
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <poll.h>
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include "net_ingest.h"
+#include "../common/arena.h"
+
+// --- DDP ---
+// 10 byte header (14 with a timecode), all fields big endian
+#define DDP_HEADER_LEN     10
+#define DDP_FLAG_VER_MASK  0xC0
+#define DDP_FLAG_VER1      0x40
+#define DDP_FLAG_TIMECODE  0x10
+#define DDP_FLAG_QUERY     0x02
+#define DDP_FLAG_PUSH      0x01
+#define DDP_TYPE_RGBW      3        // Data type bits 5-3; anything else is read as RGB
+#define DDP_ID_DISPLAY     1
+#define DDP_ID_ALL         255
+
+// --- E1.31 (sACN) ---
+// Data packet: priority at 108, sync address 109-110, sequence 111, options 112,
+// universe 113-114, property value count 123-124, start code 125.
+// Sync packet: sequence 44, sync address 45-46.
+#define E131_DATA_OFFSET   126      // First DMX channel (after the start code)
+#define E131_SYNC_LEN      49
+#define E131_VECTOR_ROOT_DATA     0x00000004
+#define E131_VECTOR_ROOT_EXTENDED 0x00000008
+#define E131_VECTOR_FRAME_DATA    0x00000002
+#define E131_VECTOR_FRAME_SYNC    0x00000001
+#define E131_OPT_PREVIEW   0x80
+#define E131_OPT_TERMINATE 0x40
+static const uint8_t e131_acn_id[12] = { 'A', 'S', 'C', '-', 'E', '1', '.', '1', '7', 0, 0, 0 };
+
+// Network channel order R, G, B, W -> encoder (wire order) channel G, R, B, W
+static const uint8_t wire_channel[4] = { 1, 0, 2, 3 };
+
+static uint16_t be16(const uint8_t *p) {
+    return (uint16_t)(p[0] << 8 | p[1]);
+}
+
+static uint32_t be32(const uint8_t *p) {
+    return (uint32_t)p[0] << 24 | (uint32_t)p[1] << 16 | (uint32_t)p[2] << 8 | p[3];
+}
+
+// --- FRAME ASSEMBLY ---
+
+// First write of a frame into segment 's'
+static void touch_segment(net_ingest_t *ni, int s) {
+    net_segment_state_t *st = &ni->seg[s];
+    strip_segment_t *seg = &ni->sm->segments[s];
+
+    if (st->ready) {
+        // The previous frame never got out: the new data replaces it
+        st->ready = 0;
+        if (!ni->replaced) ni->frames_dropped++;
+        ni->replaced = 1;
+    }
+    if (st->stale) {
+        // After a swap the back buffer holds the frame before last. Start from the
+        // one just sent, so LEDs this frame doesn't cover keep their current color.
+        memcpy(spi_tx_back(&seg->tx), spi_tx_front(&seg->tx), seg->tx.len);
+        st->stale = 0;
+    }
+    st->dirty = 1;
+}
+
+// Encodes 'len' network color bytes ('colors' per pixel, RGB order) starting at byte
+// 'offset' of the logical stream, straight into the segments' back buffers
+static void write_pixels(net_ingest_t *ni, size_t offset, const uint8_t *data, size_t len, int colors) {
+    strip_manager_t *sm = ni->sm;
+    const ws2812_encoder_t *enc = &sm->enc;
+    size_t bpc = enc->bytes_per_color, bpl = enc->bytes_per_led;
+    int wire_colors = enc->profile->colors;
+    size_t p = offset / colors;
+    int c = offset % colors;
+    int s = 0;
+
+    while (s < sm->num_segments && p >= sm->segments[s].first + sm->segments[s].count) s++;
+    if (s == sm->num_segments) return;
+    if (!ni->seg[s].dirty) touch_segment(ni, s);
+    uint8_t *base = spi_tx_back(&sm->segments[s].tx);
+
+    for (size_t i = 0; i < len; i++) {
+        if (c < wire_colors) {
+            int w = wire_channel[c];
+            memcpy(base + (p - sm->segments[s].first) * bpl + w * bpc, enc->lut[w][data[i]], bpc);
+        }
+        if (++c < colors) continue;
+
+        // Next pixel, maybe on the next strip
+        c = 0;
+        if (++p < sm->segments[s].first + sm->segments[s].count) continue;
+        if (++s == sm->num_segments) return;
+        if (!ni->seg[s].dirty) touch_segment(ni, s);
+        base = spi_tx_back(&sm->segments[s].tx);
+    }
+    ni->frame_open = 1;
+}
+
+// Hands every ready segment whose strip is free to its transmit thread
+static void present_ready(net_ingest_t *ni) {
+    int waiting = 0, sent = 0;
+    for (int s = 0; s < ni->sm->num_segments; s++) {
+        net_segment_state_t *st = &ni->seg[s];
+        if (!st->ready) continue;
+        if (spi_tx_try_swap(&ni->sm->segments[s].tx) == 0) {
+            st->ready = 0;
+            st->stale = 1;
+            sent = 1;
+        } else {
+            waiting = 1;
+        }
+    }
+    if (sent && !waiting) ni->frames_shown++;
+}
+
+// Push / sync / last universe: the frame in the back buffers is complete
+static void frame_complete(net_ingest_t *ni) {
+    ni->frames++;
+    for (int s = 0; s < ni->sm->num_segments; s++) {
+        if (ni->seg[s].dirty) {
+            ni->seg[s].dirty = 0;
+            ni->seg[s].ready = 1;
+        }
+    }
+    ni->frame_open = 0;
+    ni->replaced = 0;
+    present_ready(ni);
+}
+
+static int any_ready(const net_ingest_t *ni) {
+    for (int s = 0; s < ni->sm->num_segments; s++) {
+        if (ni->seg[s].ready) return 1;
+    }
+    return 0;
+}
+
+// --- PROTOCOLS ---
+
+static void handle_ddp(net_ingest_t *ni, const uint8_t *pkt, size_t len) {
+    if (len < DDP_HEADER_LEN || (pkt[0] & DDP_FLAG_VER_MASK) != DDP_FLAG_VER1) {
+        ni->bad_packets++;
+        return;
+    }
+    uint8_t flags = pkt[0], seq = pkt[1] & 0x0F, id = pkt[3];
+    if ((flags & DDP_FLAG_QUERY) || (id != DDP_ID_DISPLAY && id != DDP_ID_ALL)) return;
+
+    // Sequence 1-15 (0 = not used): up to 7 behind the last one is a late packet
+    if (seq && ni->ddp_seq) {
+        int behind = (ni->ddp_seq - seq + 15) % 15;
+        if (behind >= 1 && behind <= 7) {
+            ni->late_packets++;
+            return;
+        }
+    }
+    if (seq) ni->ddp_seq = seq;
+
+    size_t header = DDP_HEADER_LEN + ((flags & DDP_FLAG_TIMECODE) ? 4 : 0);
+    size_t data_len = be16(pkt + 8);
+    if (len < header + data_len) {
+        ni->bad_packets++;
+        return;
+    }
+    int colors = ((pkt[2] >> 3) & 7) == DDP_TYPE_RGBW ? 4 : 3;
+    if (data_len) write_pixels(ni, be32(pkt + 4), pkt + header, data_len, colors);
+
+    // A PUSH with no data is a sync for data sent before it
+    if (flags & DDP_FLAG_PUSH) frame_complete(ni);
+}
+
+static void handle_e131(net_ingest_t *ni, const uint8_t *pkt, size_t len) {
+    if (len < E131_SYNC_LEN || be16(pkt) != 0x0010 || memcmp(pkt + 4, e131_acn_id, 12) != 0) {
+        ni->bad_packets++;
+        return;
+    }
+
+    uint32_t root = be32(pkt + 18), frame = be32(pkt + 40);
+    if (root == E131_VECTOR_ROOT_EXTENDED && frame == E131_VECTOR_FRAME_SYNC) {
+        // Universe sync: show what the data packets with this sync address carried
+        if (ni->frame_open && be16(pkt + 45) == ni->e131_sync) frame_complete(ni);
+        return;
+    }
+    if (root != E131_VECTOR_ROOT_DATA || frame != E131_VECTOR_FRAME_DATA || len < E131_DATA_OFFSET) {
+        ni->bad_packets++;
+        return;
+    }
+
+    uint8_t options = pkt[112];
+    int u = be16(pkt + 113) - ni->e131_universe;
+    if ((options & (E131_OPT_PREVIEW | E131_OPT_TERMINATE)) || u < 0 || u >= ni->e131_universes) return;
+    if (pkt[125] != 0) return; // Not DMX512 level data (e.g. 0xDD per-channel priority)
+
+    // Per universe: a sequence number up to 20 behind the last one is a late packet
+    int8_t diff = (int8_t)(pkt[111] - ni->e131_seq[u]);
+    if (ni->e131_have_seq[u] && diff <= 0 && diff > -20) {
+        ni->late_packets++;
+        return;
+    }
+    ni->e131_seq[u] = pkt[111];
+    ni->e131_have_seq[u] = 1;
+
+    size_t channels = be16(pkt + 123);
+    channels = channels ? channels - 1 : 0;
+    if (channels > len - E131_DATA_OFFSET) channels = len - E131_DATA_OFFSET;
+    if (channels > NET_E131_PIXELS * 3) channels = NET_E131_PIXELS * 3;
+    write_pixels(ni, (size_t)u * NET_E131_PIXELS * 3, pkt + E131_DATA_OFFSET, channels, 3);
+
+    // Synchronized senders name a sync address; the others are done at the last universe
+    ni->e131_sync = be16(pkt + 109);
+    if (!ni->e131_sync && u == ni->e131_universes - 1) frame_complete(ni);
+}
+
+// --- SOCKETS ---
+
+static int open_udp(int port) {
+    int fd = socket(AF_INET, SOCK_DGRAM | SOCK_CLOEXEC | SOCK_NONBLOCK, 0);
+    if (fd < 0) {
+        perror("UDP socket");
+        return -1;
+    }
+    int one = 1, rcvbuf = NET_RCVBUF;
+    setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+    // Capped by net.core.rmem_max; raise that for long bursts
+    setsockopt(fd, SOL_SOCKET, SO_RCVBUF, &rcvbuf, sizeof(rcvbuf));
+
+    struct sockaddr_in addr = { .sin_family = AF_INET, .sin_port = htons(port),
+                                .sin_addr.s_addr = htonl(INADDR_ANY) };
+    if (bind(fd, (struct sockaddr *)&addr, sizeof(addr)) < 0) {
+        fprintf(stderr, "Can't bind UDP port %d: %s\n", port, strerror(errno));
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+// Reads and handles every queued datagram, NET_BATCH per syscall. Returns the count or -1.
+static int drain_socket(net_ingest_t *ni, int fd, int e131) {
+    int total = 0;
+    while (1) {
+        int n = recvmmsg(fd, ni->msgs, NET_BATCH, MSG_DONTWAIT, NULL);
+        if (n < 0) {
+            if (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR) return total;
+            perror("recvmmsg");
+            return -1;
+        }
+        if (n == 0) return total;
+        ni->syscalls++;
+
+        for (int i = 0; i < n; i++) {
+            size_t len = ni->msgs[i].msg_len;
+            ni->packets++;
+            ni->bytes += len;
+            if (ni->msgs[i].msg_hdr.msg_flags & MSG_TRUNC) {
+                ni->bad_packets++;
+                continue;
+            }
+            if (e131) handle_e131(ni, ni->bufs[i], len);
+            else handle_ddp(ni, ni->bufs[i], len);
+        }
+        total += n;
+        if (n < NET_BATCH) return total;
+    }
+}
+
+int net_ingest_open(net_ingest_t *ni, strip_manager_t *sm, int ddp_port, int e131_universe) {
+    memset(ni, 0, sizeof(*ni));
+    ni->sm = sm;
+    ni->ddp_fd = ni->e131_fd = -1;
+    ni->seg = arena_calloc(sm->num_segments, sizeof(net_segment_state_t));
+    ni->bufs = arena_calloc(NET_BATCH, sizeof(*ni->bufs));
+    if (!ni->seg || !ni->bufs) {
+        net_ingest_close(ni);
+        return -1;
+    }
+
+    // Every datagram of a batch into its own buffer
+    for (int i = 0; i < NET_BATCH; i++) {
+        ni->iov[i] = (struct iovec){ ni->bufs[i], NET_PACKET_MAX };
+        ni->msgs[i].msg_hdr = (struct msghdr){ .msg_iov = &ni->iov[i], .msg_iovlen = 1 };
+    }
+
+    // Both buffers of every strip start as encoded black, so partial frames are well defined
+    for (int s = 0; s < sm->num_segments; s++) {
+        strip_segment_t *seg = &sm->segments[s];
+        for (size_t i = 0; i < seg->count; i++) {
+            ws2812_encode_pixel(&sm->enc, seg->tx.buf[0] + i * sm->enc.bytes_per_led, 0);
+        }
+        memcpy(seg->tx.buf[1], seg->tx.buf[0], seg->tx.len);
+    }
+
+    if (ddp_port > 0 && (ni->ddp_fd = open_udp(ddp_port)) < 0) {
+        net_ingest_close(ni);
+        return -1;
+    }
+    if (e131_universe > 0) {
+        if ((ni->e131_fd = open_udp(NET_E131_PORT)) < 0) {
+            net_ingest_close(ni);
+            return -1;
+        }
+        ni->e131_universe = (uint16_t)e131_universe;
+        ni->e131_universes = (int)((sm->total + NET_E131_PIXELS - 1) / NET_E131_PIXELS);
+        if (ni->e131_universes > NET_E131_MAX_UNIVERSES) ni->e131_universes = NET_E131_MAX_UNIVERSES;
+
+        // Multicast sources send universe U to 239.255.U_hi.U_lo; unicast works regardless
+        for (int u = 0; u < ni->e131_universes; u++) {
+            struct ip_mreq mreq = {
+                .imr_multiaddr.s_addr = htonl(0xEFFF0000u | (uint16_t)(e131_universe + u)),
+                .imr_interface.s_addr = htonl(INADDR_ANY),
+            };
+            if (setsockopt(ni->e131_fd, IPPROTO_IP, IP_ADD_MEMBERSHIP, &mreq, sizeof(mreq)) < 0) {
+                fprintf(stderr, "E1.31: no multicast (%s), unicast only\n", strerror(errno));
+                break;
+            }
+        }
+    }
+    return 0;
+}
+
+void net_ingest_close(net_ingest_t *ni) {
+    if (ni->ddp_fd >= 0) close(ni->ddp_fd);
+    if (ni->e131_fd >= 0) close(ni->e131_fd);
+    arena_free(ni->seg);
+    arena_free(ni->bufs);
+    ni->ddp_fd = ni->e131_fd = -1;
+    ni->seg = NULL;
+    ni->bufs = NULL;
+}
+
+int net_ingest_poll(net_ingest_t *ni, int timeout_ms) {
+    struct pollfd fds[2] = {
+        { .fd = ni->ddp_fd, .events = POLLIN },
+        { .fd = ni->e131_fd, .events = POLLIN },
+    };
+
+    // A finished frame waiting for a busy strip is retried soon, not on the next packet
+    if (any_ready(ni) && (timeout_ms < 0 || timeout_ms > NET_RETRY_MS)) timeout_ms = NET_RETRY_MS;
+    int ret = poll(fds, 2, timeout_ms);
+    if (ret < 0) return errno == EINTR ? 0 : -1;
+
+    int handled = 0;
+    for (int k = 0; k < 2; k++) {
+        if (!(fds[k].revents & POLLIN)) continue;
+        int n = drain_socket(ni, fds[k].fd, k == 1);
+        if (n < 0) return -1;
+        handled += n;
+    }
+    present_ready(ni);
+    return handled;
+}
+
+void net_ingest_print_stats(const net_ingest_t *ni, FILE *f) {
+    fprintf(f, "Ingest: %llu packets (%.1f per recvmmsg), %llu bad, %llu late; "
+               "%llu frames, %llu shown, %llu dropped\n",
+            (unsigned long long)ni->packets, ni->syscalls ? (double)ni->packets / ni->syscalls : 0.0,
+            (unsigned long long)ni->bad_packets, (unsigned long long)ni->late_packets,
+            (unsigned long long)ni->frames, (unsigned long long)ni->frames_shown,
+            (unsigned long long)ni->frames_dropped);
+}
@@ -0,0 +1,96 @@
+#ifndef NET_INGEST_H
+#define NET_INGEST_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stddef.h>
+#include <sys/socket.h>     // struct mmsghdr: build with _GNU_SOURCE
+#include <sys/uio.h>
+#include "strip_manager.h"
+
+// --- NETWORK FRAME INGEST ---
+// Pixel frames from a show controller over UDP, in either of the two protocols
+// xLights, Falcon Player, WLED and most controllers speak:
+//
+//   DDP   (port 4048)  header + RGB(W) bytes at a byte offset; the PUSH flag marks
+//                      the last packet of a frame (a 0 length PUSH is a pure sync)
+//   E1.31 (port 5568)  sACN: one 510 channel (170 RGB pixel) universe per packet, from
+//                      the base universe upwards; shown when the last universe arrives,
+//                      or on the sync packet when the sender uses a sync address
+//
+// Both land in one logical RGB byte stream over the strip_manager's segments.
+// Each datagram batch is read with one recvmmsg(), and every color byte is passed
+// through the encoder's lookup table straight into the segment's spi_tx back
+// buffer: no pixel array, no packed frame, no second encode. A complete frame is
+// handed to the transmit threads with spi_tx_try_swap(), which never blocks: if a
+// strip is still sending the previous frame, the new one waits in the back buffer
+// and is retried on the next wakeup (~1 ms), and a newer frame arriving meanwhile
+// simply overwrites it (counted as dropped). Packets older than the current frame
+// (the DDP / E1.31 sequence number went backwards) are discarded as late.
+//
+// The strip_manager's power limiter works on its packed frame and is bypassed here;
+// limit the brightness in the controller.
+
+#define NET_DDP_PORT      4048
+#define NET_E131_PORT     5568
+#define NET_BATCH         32        // Datagrams per recvmmsg()
+#define NET_PACKET_MAX    1500      // Ethernet MTU: larger datagrams are truncated and dropped
+#define NET_RCVBUF        (1 << 20) // Socket buffer, absorbs a burst of a few frames
+#define NET_RETRY_MS      1         // Poll interval while a finished frame waits for a strip
+#define NET_E131_PIXELS   170       // RGB pixels per universe (510 channels)
+#define NET_E131_MAX_UNIVERSES 64
+
+typedef struct {
+    uint8_t dirty;      // Written since its last swap
+    uint8_t stale;      // Back buffer holds an old frame: copy the front one in before writing
+    uint8_t ready;      // Frame complete, swap refused because the strip was busy
+} net_segment_state_t;
+
+typedef struct {
+    strip_manager_t *sm;
+    net_segment_state_t *seg;
+    int ddp_fd;                 // -1 = off
+    int e131_fd;                // -1 = off
+    uint16_t e131_universe;     // First universe
+    int e131_universes;         // Universes needed for all LEDs
+    int frame_open;             // Data written that hasn't been presented yet
+    int replaced;               // This frame overwrote a finished one (counted once)
+    uint16_t e131_sync;         // Sync address of the last data packet (0 = unsynchronized)
+
+    // Last sequence number per source, kept across frames for the late packet check
+    uint8_t ddp_seq;                                // 0 = none yet
+    uint8_t e131_seq[NET_E131_MAX_UNIVERSES];
+    uint8_t e131_have_seq[NET_E131_MAX_UNIVERSES];  // e131_seq[u] is valid
+
+    // Receive batch, set up once
+    struct mmsghdr msgs[NET_BATCH];
+    struct iovec iov[NET_BATCH];
+    uint8_t (*bufs)[NET_PACKET_MAX];
+
+    // Stats
+    uint64_t packets;
+    uint64_t bytes;
+    uint64_t syscalls;          // recvmmsg() calls that returned data
+    uint64_t bad_packets;       // Not DDP / E1.31, wrong destination, truncated
+    uint64_t late_packets;      // Older than the frame being received
+    uint64_t frames;            // Frames completed (push / sync / last universe)
+    uint64_t frames_shown;      // Handed to the transmit threads
+    uint64_t frames_dropped;    // Completed but replaced before a strip was free
+} net_ingest_t;
+
+// Binds the DDP port ('ddp_port', 0 = off) and/or the E1.31 port ('e131_universe' =
+// first universe, 0 = off; joins the universes' multicast groups too) and fills every
+// strip's buffers with encoded black. 'sm' must be open. Returns 0, or -1 with the reason printed.
+int net_ingest_open(net_ingest_t *ni, strip_manager_t *sm, int ddp_port, int e131_universe);
+
+// Closes the sockets. The strips are left showing the last frame.
+void net_ingest_close(net_ingest_t *ni);
+
+// Waits up to 'timeout_ms' for datagrams, decodes everything queued and hands
+// complete frames over. Returns the number of packets handled, or -1 on error.
+int net_ingest_poll(net_ingest_t *ni, int timeout_ms);
+
+// Totals since open.
+void net_ingest_print_stats(const net_ingest_t *ni, FILE *f);
+
+#endif
@@ -0,0 +1,365 @@
+#define _GNU_SOURCE // memfd_create()
+
+#include <stdio.h>
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <time.h>
+#include <fcntl.h>
+#include <sys/ioctl.h>
+#include <sys/mman.h>
+#include <linux/types.h>
+#include <linux/spi/spidev.h>
+#include "spi_tx.h"
+#include "../common/arena.h"
+
+static uint64_t now_ns(void) {
+    struct timespec te;
+    clock_gettime(CLOCK_MONOTONIC, &te);
+    return (uint64_t)te.tv_sec * 1000000000ULL + (uint64_t)te.tv_nsec;
+}
+
+int spi_open(const char *device, uint32_t speed_hz) {
+    uint8_t mode = SPI_MODE_0;
+    uint8_t bits = 8;
+    uint32_t speed = speed_hz;
+
+    int fd = open(device, O_RDWR);
+    if (fd < 0) {
+        fprintf(stderr, "Failed to open SPI device %s: %s\n", device, strerror(errno));
+        return -1;
+    }
+
+    if (ioctl(fd, SPI_IOC_WR_MODE, &mode) < 0 ||
+        ioctl(fd, SPI_IOC_WR_BITS_PER_WORD, &bits) < 0 ||
+        ioctl(fd, SPI_IOC_WR_MAX_SPEED_HZ, &speed) < 0) {
+        fprintf(stderr, "Failed to configure SPI device %s: %s\n", device, strerror(errno));
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+// --- MOCK SINK ---
+#define SPI_MOCK_MAX 8
+
+typedef struct {
+    int fd;
+    int wire_time;
+} spi_mock_t;
+
+// Registered before any transmit thread starts, only read afterwards
+static spi_mock_t mocks[SPI_MOCK_MAX];
+static int num_mocks = 0;
+
+int spi_mock_open(int wire_time) {
+    if (num_mocks == SPI_MOCK_MAX) {
+        fprintf(stderr, "Too many mock SPI sinks\n");
+        return -1;
+    }
+    int fd = memfd_create("spi_mock", 0);
+    if (fd < 0) fd = open("/dev/null", O_WRONLY);
+    if (fd < 0) {
+        fprintf(stderr, "Failed to open mock SPI sink: %s\n", strerror(errno));
+        return -1;
+    }
+    mocks[num_mocks].fd = fd;
+    mocks[num_mocks].wire_time = wire_time;
+    num_mocks++;
+    return fd;
+}
+
+void spi_mock_close(int fd) {
+    for (int i = 0; i < num_mocks; i++) {
+        if (mocks[i].fd == fd) {
+            mocks[i] = mocks[--num_mocks];
+            break;
+        }
+    }
+    close(fd);
+}
+
+static const spi_mock_t *find_mock(int fd) {
+    for (int i = 0; i < num_mocks; i++) {
+        if (mocks[i].fd == fd) return &mocks[i];
+    }
+    return NULL;
+}
+
+// Stands in for one SPI_IOC_MESSAGE: one pwrite() of the message bytes (at their frame
+// offset), then, if enabled, waits until the message would have left the wire.
+static int mock_message(const spi_mock_t *mock, const struct spi_ioc_transfer *xfer, int n) {
+    uint64_t start = now_ns();
+    uint64_t wire_ns = 0;
+    const uint8_t *first = NULL;
+    size_t bytes = 0;
+
+    for (int i = 0; i < n; i++) {
+        if (xfer[i].len && !first) first = (const uint8_t *)(unsigned long)xfer[i].tx_buf;
+        bytes += xfer[i].len;
+        wire_ns += (uint64_t)xfer[i].len * 8ULL * 1000000000ULL / xfer[i].speed_hz;
+        wire_ns += (uint64_t)xfer[i].delay_usecs * 1000ULL;
+    }
+    // The chunks of one message are consecutive in the frame
+    if (bytes && pwrite(mock->fd, first, bytes, 0) < 0) return -1;
+
+    if (mock->wire_time) {
+        uint64_t end = start + wire_ns;
+        struct timespec ts = { (time_t)(end / 1000000000ULL), (long)(end % 1000000000ULL) };
+        while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL) == EINTR);
+    }
+    return 0;
+}
+
+// --- FRAME TRANSFER ---
+#define SPIDEV_BUFSIZ_PATH "/sys/module/spidev/parameters/bufsiz"
+#define SPIDEV_DEFAULT_BUFSIZ 4096
+#define SPI_MAX_TRANSFER 65532 // Per-transfer cap, a multiple of 3 so chunks end between WS bits
+#define SPI_MAX_XFERS 16       // Transfers per SPI_IOC_MESSAGE
+
+// spidev rejects messages whose total tx length exceeds bufsiz
+static size_t spidev_bufsiz(void) {
+    static size_t bufsiz = 0;
+    if (bufsiz) return bufsiz;
+
+    bufsiz = SPIDEV_DEFAULT_BUFSIZ;
+    FILE *f = fopen(SPIDEV_BUFSIZ_PATH, "r");
+    if (f) {
+        unsigned long val;
+        if (fscanf(f, "%lu", &val) == 1 && val >= 3) bufsiz = val;
+        fclose(f);
+    }
+    return bufsiz;
+}
+
+size_t spi_max_frame_bytes(void) {
+    // Split only between WS bits (3 SPI bytes per color byte), in the low phase
+    size_t bufsiz = spidev_bufsiz();
+    size_t cap = bufsiz - bufsiz % 3;
+    // One transfer slot goes to the leading delay
+    if (cap > (SPI_MAX_XFERS - 1) * (size_t)SPI_MAX_TRANSFER) cap = (SPI_MAX_XFERS - 1) * (size_t)SPI_MAX_TRANSFER;
+    return cap;
+}
+
+int spi_check_frame_len(size_t len) {
+    size_t cap = spi_max_frame_bytes();
+    if (len <= cap) return 0;
+    fprintf(stderr, "SPI frame (%zu bytes) exceeds spidev bufsiz (%zu): it would be sent in pieces, and the "
+                    "strip can latch between them. Add spidev.bufsiz=%zu to /boot/firmware/cmdline.txt.\n",
+            len, spidev_bufsiz(), len);
+    return -1;
+}
+
+// 'lead_us' delays the first bit (leading zero-length transfer), 'tail_us' follows the last one.
+// The whole frame goes out as one SPI_IOC_MESSAGE, so the line never idles long enough
+// to latch in the middle of it.
+static int spi_transfer(int fd, const uint8_t *data, size_t len, uint32_t speed_hz,
+                        uint16_t lead_us, uint16_t tail_us) {
+    static int warned = 0;
+    struct spi_ioc_transfer xfer[SPI_MAX_XFERS];
+    int n = 0;
+    const spi_mock_t *mock = num_mocks ? find_mock(fd) : NULL;
+
+    if (len > spi_max_frame_bytes()) {
+        // Normally refused at setup (spi_tx_start(), led_strip_init()); don't send a torn frame
+        if (!warned) spi_check_frame_len(len);
+        warned = 1;
+        errno = EMSGSIZE;
+        return -1;
+    }
+    memset(xfer, 0, sizeof(xfer));
+
+    // Bufferless transfer: the controller sends nothing, the core just waits
+    if (lead_us) {
+        xfer[n].speed_hz = speed_hz;
+        xfer[n].bits_per_word = 8;
+        xfer[n].delay_usecs = lead_us;
+        n++;
+    }
+
+    for (size_t off = 0; off < len; ) {
+        size_t chunk = len - off;
+        if (chunk > SPI_MAX_TRANSFER) chunk = SPI_MAX_TRANSFER;
+
+        xfer[n].tx_buf = (unsigned long)(data + off);
+        xfer[n].len = chunk;
+        xfer[n].speed_hz = speed_hz;
+        xfer[n].bits_per_word = 8;
+        off += chunk;
+        n++;
+    }
+    if (n == 0) {
+        // Empty frame: just the delay
+        xfer[0].speed_hz = speed_hz;
+        xfer[0].bits_per_word = 8;
+        n = 1;
+    }
+
+    // The tail delay follows the last bit of the frame
+    if (tail_us) xfer[n - 1].delay_usecs = tail_us;
+
+    if (mock) {
+        if (mock_message(mock, xfer, n) < 0) {
+            perror("Mock SPI transfer failed");
+            return -1;
+        }
+    } else if (ioctl(fd, SPI_IOC_MESSAGE(n), xfer) < 0) {
+        perror("SPI transfer failed");
+        return -1;
+    }
+    return 1;
+}
+
+int spi_send_frame(int fd, const uint8_t *data, size_t len, uint32_t speed_hz, uint16_t latch_us) {
+    return spi_transfer(fd, data, len, speed_hz, 0, latch_us);
+}
+
+// --- FRAME SCHEDULER ---
+
+void spi_sched_init(spi_frame_sched_t *sched, int fd, uint32_t speed_hz, uint32_t latch_us) {
+    memset(sched, 0, sizeof(*sched));
+    sched->fd = fd;
+    sched->speed_hz = speed_hz;
+    sched->latch_us = latch_us;
+}
+
+int spi_sched_send(spi_frame_sched_t *sched, const uint8_t *data, size_t len) {
+    uint16_t lead_us = 0;
+
+    // last_end_ns is taken after the ioctl returned, i.e. no earlier than the real
+    // end of the frame, so the remaining time computed here errs on the long side.
+    if (sched->last_end_ns) {
+        uint64_t ready = sched->last_end_ns + (uint64_t)sched->latch_us * 1000ULL;
+        uint64_t now = now_ns();
+        if (now < ready) {
+            uint64_t wait_us = (ready - now + 999) / 1000;
+            lead_us = wait_us > 0xFFFF ? 0xFFFF : (uint16_t)wait_us;
+            sched->latch_waits++;
+            sched->latch_wait_us += lead_us;
+        }
+    }
+
+    int ret = spi_transfer(sched->fd, data, len, sched->speed_hz, lead_us, 0);
+    sched->last_end_ns = now_ns();
+    if (ret > 0) {
+        sched->frames++;
+        sched->ioctls += ret;
+    }
+    return ret;
+}
+
+// --- TRANSMIT THREAD ---
+static void *tx_thread(void *arg) {
+    spi_tx_t *tx = arg;
+
+    pthread_mutex_lock(&tx->lock);
+    while (1) {
+        while (!tx->pending && tx->running) pthread_cond_wait(&tx->cond, &tx->lock);
+        if (!tx->pending) break; // Stopped and nothing left to send
+
+        // The front buffer is the one the app isn't using
+        const uint8_t *front = tx->buf[tx->back ^ 1];
+        tx->pending = 0;
+        tx->busy = 1;
+        pthread_mutex_unlock(&tx->lock);
+
+        uint64_t start = now_ns();
+        int ret = spi_sched_send(&tx->sched, front, tx->len);
+        uint64_t elapsed = now_ns() - start;
+
+        pthread_mutex_lock(&tx->lock);
+        tx->busy = 0;
+        tx->last_wire_ns = elapsed;
+        if (ret < 0) {
+            tx->write_errors++;
+        } else {
+            tx->frames_sent++;
+        }
+        pthread_cond_broadcast(&tx->cond);
+    }
+    pthread_mutex_unlock(&tx->lock);
+    return NULL;
+}
+
+int spi_tx_start(spi_tx_t *tx, int fd, size_t len, uint32_t speed_hz, uint32_t latch_us) {
+    memset(tx, 0, sizeof(*tx));
+    if (spi_check_frame_len(len) < 0) return -1;
+    tx->fd = fd;
+    tx->len = len;
+    spi_sched_init(&tx->sched, fd, speed_hz, latch_us);
+    tx->buf[0] = arena_calloc(1, len);
+    tx->buf[1] = arena_calloc(1, len);
+    if (!tx->buf[0] || !tx->buf[1]) {
+        arena_free(tx->buf[0]);
+        arena_free(tx->buf[1]);
+        fprintf(stderr, "Failed to allocate SPI frame buffers\n");
+        return -1;
+    }
+
+    pthread_mutex_init(&tx->lock, NULL);
+    pthread_cond_init(&tx->cond, NULL);
+    tx->running = 1;
+    if (pthread_create(&tx->thread, NULL, tx_thread, tx) != 0) {
+        fprintf(stderr, "Failed to start SPI transmit thread\n");
+        tx->running = 0;
+        arena_free(tx->buf[0]);
+        arena_free(tx->buf[1]);
+        return -1;
+    }
+    return 0;
+}
+
+void spi_tx_stop(spi_tx_t *tx) {
+    pthread_mutex_lock(&tx->lock);
+    tx->running = 0;
+    pthread_cond_broadcast(&tx->cond);
+    pthread_mutex_unlock(&tx->lock);
+    pthread_join(tx->thread, NULL);
+
+    pthread_cond_destroy(&tx->cond);
+    pthread_mutex_destroy(&tx->lock);
+    arena_free(tx->buf[0]);
+    arena_free(tx->buf[1]);
+    tx->buf[0] = tx->buf[1] = NULL;
+}
+
+// Caller holds the lock and has checked the thread is free
+static void hand_off(spi_tx_t *tx) {
+    tx->back ^= 1;
+    tx->pending = 1;
+    pthread_cond_broadcast(&tx->cond);
+}
+
+int spi_tx_swap(spi_tx_t *tx) {
+    pthread_mutex_lock(&tx->lock);
+    while ((tx->busy || tx->pending) && tx->running) pthread_cond_wait(&tx->cond, &tx->lock);
+    if (!tx->running) {
+        pthread_mutex_unlock(&tx->lock);
+        return -1;
+    }
+    hand_off(tx);
+    pthread_mutex_unlock(&tx->lock);
+    return 0;
+}
+
+int spi_tx_try_swap(spi_tx_t *tx) {
+    int ret = 0;
+    pthread_mutex_lock(&tx->lock);
+    if (!tx->running) {
+        ret = -1;
+    } else if (tx->busy || tx->pending) {
+        tx->frames_refused++;
+        ret = 1;
+    } else {
+        hand_off(tx);
+    }
+    pthread_mutex_unlock(&tx->lock);
+    return ret;
+}
+
+void spi_tx_flush(spi_tx_t *tx) {
+    pthread_mutex_lock(&tx->lock);
+    while (tx->busy || tx->pending) pthread_cond_wait(&tx->cond, &tx->lock);
+    pthread_mutex_unlock(&tx->lock);
+}
@@ -0,0 +1,127 @@
+#ifndef SPI_TX_H
+#define SPI_TX_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <pthread.h>
+
+// --- FRAME SCHEDULER ---
+// WS2812 latches after the line has been low for WS2812_LATCH_US. Instead of paying
+// that delay after every frame, the scheduler remembers when the previous frame
+// finished and, only if the next one comes too early, delays its first bit by the
+// remaining low time (a zero-length leading transfer with delay_usecs, inside the
+// same ioctl). Frames that arrive late enough cost no latch time at all.
+typedef struct {
+    int fd;
+    uint32_t speed_hz;
+    uint32_t latch_us;
+    uint64_t last_end_ns;      // CLOCK_MONOTONIC time the previous frame's ioctl returned (0 = none)
+
+    // Stats
+    uint64_t frames;
+    uint64_t ioctls;           // SPI_IOC_MESSAGE calls issued
+    uint64_t latch_waits;      // Frames that had to wait for the latch
+    uint64_t latch_wait_us;    // Total time spent waiting for it
+} spi_frame_sched_t;
+
+void spi_sched_init(spi_frame_sched_t *sched, int fd, uint32_t speed_hz, uint32_t latch_us);
+
+// Sends one encoded frame, inserting only the part of the latch time that hasn't
+// already elapsed since the previous frame. Returns the number of ioctls, or -1.
+int spi_sched_send(spi_frame_sched_t *sched, const uint8_t *data, size_t len);
+
+// --- DOUBLE-BUFFERED ASYNC TRANSMIT ---
+// Two encoded frame buffers: the app fills the back buffer while a dedicated
+// thread sends the front buffer to spidev. A swap hands the back buffer to the
+// thread without waiting for the wire time (~6 ms for 186 LEDs at 2.4MHz).
+//
+// Usage:
+//   uint8_t *buf = spi_tx_back(&tx);   // encode the next frame here
+//   ...
+//   spi_tx_swap(&tx);                  // or spi_tx_try_swap() to never block
+//   buf = spi_tx_back(&tx);            // new back buffer (holds an older frame)
+//
+// After a swap the back buffer contains the frame sent two swaps ago, so the
+// next frame has to be encoded in full (encode_frame()/encode_grb()).
+typedef struct {
+    int fd;                 // spidev fd, opened and configured by the caller
+    uint8_t *buf[2];        // Encoded frames, each 'len' bytes (no reset padding)
+    size_t len;
+    spi_frame_sched_t sched; // Used only by the thread once started
+    int back;               // Index of the buffer owned by the app
+
+    pthread_t thread;
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+    int pending;            // Front buffer handed off, not yet picked up
+    int busy;               // Thread is writing the front buffer
+    int running;
+
+    // Stats (read under lock, or approximately without)
+    uint64_t frames_sent;
+    uint64_t frames_refused;   // spi_tx_try_swap() calls that found the thread busy
+    uint64_t write_errors;
+    uint64_t last_wire_ns;     // Duration of the last frame transfer
+} spi_tx_t;
+
+// Opens and configures a spidev device (mode 0, 8 bits, 'speed_hz').
+// Returns the fd, or -1 with the reason printed.
+int spi_open(const char *device, uint32_t speed_hz);
+
+// --- MOCK SINK ---
+// Stand-in for spidev so the LED pipeline runs without the hardware or sudo
+// (bench_pipeline.c). The fd from spi_mock_open() can be passed anywhere a spidev
+// fd goes: every SPI_IOC_MESSAGE the frame would need becomes one pwrite() into a
+// memfd (/dev/null if memfd_create fails), so the message split and syscall count
+// match the real device. With 'wire_time' set, each message also blocks for as long
+// as it would take on the wire (len * 8 / speed_hz plus the transfer delays).
+// Open mock sinks before starting any transmit thread that uses them.
+int spi_mock_open(int wire_time);
+void spi_mock_close(int fd);
+
+// Sends one encoded frame as one SPI_IOC_MESSAGE ioctl at 'speed_hz', with a
+// 'latch_us' delay after the last bit instead of reset padding bytes.
+// spidev caps a message at its bufsiz (/sys/module/spidev/parameters/bufsiz, 4096 by
+// default = 455 LEDs at 9 bytes each). A longer frame would need several ioctls, and the
+// line idles between them long enough for the strip to latch half a frame, so it is
+// refused instead (-1, errno EMSGSIZE). Raise the limit with spidev.bufsiz=65536 on the
+// kernel command line for long chains.
+// Returns the number of ioctls issued (1), or -1 on error.
+int spi_send_frame(int fd, const uint8_t *data, size_t len, uint32_t speed_hz, uint16_t latch_us);
+
+// Largest frame spi_send_frame() / spi_sched_send() accept, in bytes.
+size_t spi_max_frame_bytes(void);
+
+// For setup code: 0 if a 'len' byte frame goes out in one ioctl, else -1 with the
+// spidev.bufsiz setting it needs printed.
+int spi_check_frame_len(size_t len);
+
+// Allocates both buffers ('len' bytes of encoded data each) and starts the transmit
+// thread, which sends frames at 'speed_hz' through a frame scheduler keeping them
+// 'latch_us' apart. Fails if 'len' is over spi_max_frame_bytes().
+int spi_tx_start(spi_tx_t *tx, int fd, size_t len, uint32_t speed_hz, uint32_t latch_us);
+
+// Waits for the frame in flight, stops the thread, frees the buffers. Does not close fd.
+void spi_tx_stop(spi_tx_t *tx);
+
+static inline uint8_t *spi_tx_back(spi_tx_t *tx) {
+    return tx->buf[tx->back];
+}
+
+// The frame handed off last. Read only: the thread may be sending it.
+static inline const uint8_t *spi_tx_front(const spi_tx_t *tx) {
+    return tx->buf[tx->back ^ 1];
+}
+
+// Hands the back buffer to the thread. Waits only if the previous frame is still
+// on the wire. Returns 0 on success, -1 if the thread is stopped.
+int spi_tx_swap(spi_tx_t *tx);
+
+// Same, but never blocks: returns 1 (frame not taken, back buffer unchanged) if the
+// thread is still busy. Lets a render loop drop or coalesce frames instead.
+int spi_tx_try_swap(spi_tx_t *tx);
+
+// Blocks until every handed-off frame has been written.
+void spi_tx_flush(spi_tx_t *tx);
+
+#endif
@@ -0,0 +1,98 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "strip_manager.h"
+#include "../common/arena.h"
+
+static int is_mock(const strip_segment_t *seg) {
+    return strcmp(seg->device, STRIP_MOCK_DEVICE) == 0;
+}
+
+static void close_device(strip_segment_t *seg) {
+    if (is_mock(seg)) spi_mock_close(seg->fd);
+    else close(seg->fd);
+}
+
+int strip_manager_open(strip_manager_t *sm, const strip_segment_cfg_t *cfg, int num_segments,
+                       const ws2812_profile_t *profile) {
+    memset(sm, 0, sizeof(*sm));
+    if (ws2812_encoder_init(&sm->enc, profile) < 0) return -1;
+    sm->segments = arena_calloc(num_segments, sizeof(strip_segment_t));
+    if (!sm->segments) return -1;
+
+    for (int i = 0; i < num_segments; i++) {
+        sm->total += cfg[i].count;
+    }
+    sm->grb = arena_calloc(sm->total, profile->colors);
+    if (!sm->grb) {
+        arena_free(sm->segments);
+        return -1;
+    }
+
+    size_t first = 0;
+    for (int i = 0; i < num_segments; i++) {
+        strip_segment_t *seg = &sm->segments[i];
+        seg->device = cfg[i].device;
+        seg->first = first;
+        seg->count = cfg[i].count;
+        first += seg->count;
+
+        seg->fd = is_mock(seg) ? spi_mock_open(1) : spi_open(seg->device, profile->spi_hz);
+        if (seg->fd < 0) goto fail;
+
+        size_t len = ws2812_frame_bytes(&sm->enc, seg->count);
+        if (spi_tx_start(&seg->tx, seg->fd, len, profile->spi_hz, profile->latch_us) < 0) {
+            close_device(seg);
+            goto fail;
+        }
+        sm->num_segments++;
+    }
+    return 0;
+
+fail:
+    // Only the segments counted in num_segments are fully set up
+    strip_manager_close(sm);
+    return -1;
+}
+
+void strip_manager_close(strip_manager_t *sm) {
+    if (sm->grb) {
+        memset(sm->grb, 0, sm->total * sm->enc.profile->colors);
+        strip_manager_show(sm);
+        strip_manager_flush(sm);
+    }
+    for (int i = 0; i < sm->num_segments; i++) {
+        spi_tx_stop(&sm->segments[i].tx);
+        close_device(&sm->segments[i]);
+    }
+    arena_free(sm->segments);
+    arena_free(sm->grb);
+    memset(sm, 0, sizeof(*sm));
+}
+
+int strip_manager_show(strip_manager_t *sm) {
+    int ret = 0;
+
+    // Whole logical frame at once, so every strip gets the same limiter scale
+    ws2812_limit_power(&sm->enc, sm->grb, sm->total * sm->enc.profile->colors);
+
+    // Encode everything first (the back buffers are ours even while the previous
+    // frames are on the wire), then hand off, so all strips start close together
+    for (int i = 0; i < sm->num_segments; i++) {
+        strip_segment_t *seg = &sm->segments[i];
+        size_t colors = sm->enc.profile->colors;
+        ws2812_encode_packed(&sm->enc, spi_tx_back(&seg->tx),
+                             sm->grb + seg->first * colors, seg->count * colors);
+    }
+    for (int i = 0; i < sm->num_segments; i++) {
+        if (spi_tx_swap(&sm->segments[i].tx) < 0) ret = -1;
+    }
+    return ret;
+}
+
+void strip_manager_flush(strip_manager_t *sm) {
+    for (int i = 0; i < sm->num_segments; i++) {
+        spi_tx_flush(&sm->segments[i].tx);
+    }
+}
@@ -0,0 +1,65 @@
+#ifndef STRIP_MANAGER_H
+#define STRIP_MANAGER_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "spi_tx.h"
+#include "ws2812_spi.h"
+
+// --- MULTI-STRIP OUTPUT ---
+// One logical framebuffer split across several physical strips, each on its own
+// spidev device (spidev0.0, spidev1.0, ... on the Pi 5). Logical LEDs are laid out
+// segment after segment in the order given. Every segment has its own transmit
+// thread (spi_tx.c), so strips on different buses are sent in parallel and the
+// refresh rate scales with the number of buses instead of the total chain length.
+//
+// Note: chip selects of the same bus (spidev0.0 / spidev0.1) share MOSI, so those
+// strips need external gating and are serialized by the kernel anyway.
+//
+// A segment on device STRIP_MOCK_DEVICE goes to a mock sink with wire timing
+// (spi_mock_open()) instead, for running without the strips.
+
+#define STRIP_MOCK_DEVICE "mock"
+
+typedef struct {
+    const char *device;     // e.g. "/dev/spidev0.0"
+    size_t count;           // LEDs on this strip
+} strip_segment_cfg_t;
+
+typedef struct {
+    const char *device;
+    int fd;
+    size_t first;           // First logical LED of this segment
+    size_t count;
+    spi_tx_t tx;
+} strip_segment_t;
+
+typedef struct {
+    strip_segment_t *segments;
+    int num_segments;
+    ws2812_encoder_t enc;   // Same encoding profile on every strip
+    uint8_t *grb;           // Logical packed framebuffer in wire order, enc.profile->colors bytes per LED
+    size_t total;           // Total LEDs across all segments
+} strip_manager_t;
+
+// Opens every device at the profile's SPI clock and starts one transmit thread per segment.
+int strip_manager_open(strip_manager_t *sm, const strip_segment_cfg_t *cfg, int num_segments,
+                       const ws2812_profile_t *profile);
+
+// Sends black to every strip, stops the threads and closes the devices.
+void strip_manager_close(strip_manager_t *sm);
+
+// Sets logical pixel 'index' (0xRRGGBB, or 0xWWRRGGBB for RGBW). Out-of-range indices are ignored.
+static inline void strip_set_pixel(strip_manager_t *sm, size_t index, uint32_t color) {
+    if (index >= sm->total) return;
+    ws2812_pack_pixel(&sm->enc, sm->grb + index * sm->enc.profile->colors, color);
+}
+
+// Applies the power limiter (if set on sm->enc) to the whole framebuffer, encodes
+// each segment's slice into its back buffer and hands all of them off. Waits only for segments whose previous frame is still on the wire.
+int strip_manager_show(strip_manager_t *sm);
+
+// Blocks until every strip has finished sending.
+void strip_manager_flush(strip_manager_t *sm);
+
+#endif
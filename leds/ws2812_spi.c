@@ -0,0 +1,373 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include "ws2812_spi.h"
+
+#if defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+#if defined(__ARM_NEON) && defined(__linux__)
+#include <sys/auxv.h>
+#include <asm/hwcap.h>
+#endif
+
+// --- LOOKUP TABLE ---
+// The 24-bit pattern for a color byte is the 8 WS bits expanded MSB first,
+// each one becoming 110 (for 1) or 100 (for 0).
+#define WS_BIT(v, b)   ((((v) >> (b)) & 1) ? 0x6u : 0x4u)
+#define WS_PATTERN(v)  ((WS_BIT(v, 7) << 21) | (WS_BIT(v, 6) << 18) | \
+                        (WS_BIT(v, 5) << 15) | (WS_BIT(v, 4) << 12) | \
+                        (WS_BIT(v, 3) << 9)  | (WS_BIT(v, 2) << 6)  | \
+                        (WS_BIT(v, 1) << 3)  |  WS_BIT(v, 0))
+#define WS_ENTRY(v)    { (uint8_t)(WS_PATTERN(v) >> 16), \
+                         (uint8_t)(WS_PATTERN(v) >> 8),  \
+                         (uint8_t)(WS_PATTERN(v)) }
+
+#define WS_ROW4(n)     WS_ENTRY(n), WS_ENTRY((n) + 1), WS_ENTRY((n) + 2), WS_ENTRY((n) + 3)
+#define WS_ROW16(n)    WS_ROW4(n), WS_ROW4((n) + 4), WS_ROW4((n) + 8), WS_ROW4((n) + 12)
+#define WS_ROW64(n)    WS_ROW16(n), WS_ROW16((n) + 16), WS_ROW16((n) + 32), WS_ROW16((n) + 48)
+
+const uint8_t ws2812_spi_lut[256][WS2812_SPI_BYTES_PER_COLOR] = {
+    WS_ROW64(0), WS_ROW64(64), WS_ROW64(128), WS_ROW64(192)
+};
+
+void encode_byte_bitwise(uint8_t val, uint8_t *ptr) {
+    uint32_t p = 0;
+    for (int b = 7; b >= 0; b--) {
+        // Shift existing pattern to make room
+        // OR in the new 3-bit pattern (110 or 100)
+        p = (p << 3) | (((val >> b) & 1) ? 0b110 : 0b100);
+    }
+
+    // Write 3 bytes to the buffer (MSB first)
+    ptr[0] = (p >> 16) & 0xFF;
+    ptr[1] = (p >> 8) & 0xFF;
+    ptr[2] = p & 0xFF;
+}
+
+void encode_frame(uint8_t *dst, const uint32_t *pixels, size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        uint32_t color = pixels[i];
+
+        // WS2812B expects GRB order
+        encode_byte((color >> 8) & 0xFF, dst);       // Green
+        encode_byte((color >> 16) & 0xFF, dst + 3);  // Red
+        encode_byte(color & 0xFF, dst + 6);          // Blue
+        dst += WS2812_SPI_BYTES_PER_LED;
+    }
+}
+
+// --- PACKED GRB ENCODING ---
+
+void encode_grb_scalar(uint8_t *dst, const uint8_t *grb, size_t len) {
+    for (size_t i = 0; i < len; i++) {
+        encode_byte(grb[i], dst);
+        dst += WS2812_SPI_BYTES_PER_COLOR;
+    }
+}
+
+#if defined(__ARM_NEON)
+// 16 color bytes per iteration. In the 24-bit pattern the fixed 1/0 bits are the
+// same for every value (0x92 0x49 0x24), so each output byte is that constant
+// ORed with the data bits shifted into their slots:
+//   byte 0: bit7 -> 6, bit6 -> 3, bit5 -> 0
+//   byte 1: bit4 -> 5, bit3 -> 2
+//   byte 2: bit2 -> 7, bit1 -> 4, bit0 -> 1
+// vst3q_u8 then interleaves the three planes into 48 consecutive SPI bytes.
+void encode_grb_neon(uint8_t *dst, const uint8_t *grb, size_t len) {
+    const uint8x16_t fixed0 = vdupq_n_u8(0x92);
+    const uint8x16_t fixed1 = vdupq_n_u8(0x49);
+    const uint8x16_t fixed2 = vdupq_n_u8(0x24);
+    const uint8x16_t m80 = vdupq_n_u8(0x80);
+    const uint8x16_t m40 = vdupq_n_u8(0x40);
+    const uint8x16_t m20 = vdupq_n_u8(0x20);
+    const uint8x16_t m10 = vdupq_n_u8(0x10);
+    const uint8x16_t m08 = vdupq_n_u8(0x08);
+    const uint8x16_t m04 = vdupq_n_u8(0x04);
+    const uint8x16_t m02 = vdupq_n_u8(0x02);
+    const uint8x16_t m01 = vdupq_n_u8(0x01);
+
+    size_t i = 0;
+    for (; i + 16 <= len; i += 16) {
+        uint8x16_t v = vld1q_u8(grb + i);
+        uint8x16x3_t out;
+
+        out.val[0] = vorrq_u8(fixed0,
+                     vorrq_u8(vandq_u8(vshrq_n_u8(v, 1), m40),
+                     vorrq_u8(vandq_u8(vshrq_n_u8(v, 3), m08),
+                              vandq_u8(vshrq_n_u8(v, 5), m01))));
+        out.val[1] = vorrq_u8(fixed1,
+                     vorrq_u8(vandq_u8(vshlq_n_u8(v, 1), m20),
+                              vandq_u8(vshrq_n_u8(v, 1), m04)));
+        out.val[2] = vorrq_u8(fixed2,
+                     vorrq_u8(vandq_u8(vshlq_n_u8(v, 5), m80),
+                     vorrq_u8(vandq_u8(vshlq_n_u8(v, 3), m10),
+                              vandq_u8(vshlq_n_u8(v, 1), m02))));
+
+        vst3q_u8(dst, out);
+        dst += 16 * WS2812_SPI_BYTES_PER_COLOR;
+    }
+
+    // Leftover bytes (less than 16) go through the table
+    encode_grb_scalar(dst, grb + i, len - i);
+}
+#endif
+
+#if defined(__ARM_NEON)
+static int cpu_has_neon(void) {
+#if defined(__linux__) && defined(__aarch64__)
+    return (getauxval(AT_HWCAP) & HWCAP_ASIMD) != 0;
+#elif defined(__linux__) && defined(__arm__)
+    return (getauxval(AT_HWCAP) & HWCAP_NEON) != 0;
+#else
+    return 1;
+#endif
+}
+#endif
+
+static void (*encode_grb_impl)(uint8_t *, const uint8_t *, size_t) = encode_grb_scalar;
+static const char *encode_grb_name = "scalar";
+static pthread_once_t encode_grb_once = PTHREAD_ONCE_INIT;
+
+// Runs once (pthread_once: encoder threads may get here at the same time)
+static void encode_grb_select(void) {
+    const char *force = getenv("WS2812_ENCODER");
+    int scalar = (force != NULL && strcmp(force, "scalar") == 0);
+
+#if defined(__ARM_NEON)
+    if (!scalar && cpu_has_neon()) {
+        encode_grb_impl = encode_grb_neon;
+        encode_grb_name = "neon";
+    }
+#else
+    (void)scalar;
+#endif
+}
+
+void encode_grb(uint8_t *dst, const uint8_t *grb, size_t len) {
+    pthread_once(&encode_grb_once, encode_grb_select);
+    encode_grb_impl(dst, grb, len);
+}
+
+const char *encode_grb_backend(void) {
+    pthread_once(&encode_grb_once, encode_grb_select);
+    return encode_grb_name;
+}
+
+// --- ENCODING PROFILES ---
+
+const ws2812_profile_t ws2812_profiles[] = {
+    // 417ns / 833ns high in a 1.25us bit. Smallest wire size.
+    { "ws2812-3bit", "WS2812B, 3 SPI bits per bit at 2.4MHz (9 bytes/LED)",
+      2400000, 3, 0x4 /* 100 */, 0x6 /* 110 */, 3, 300 },
+    // 313ns / 938ns high. More margin on both sides of the 0/1 threshold.
+    { "ws2812-4bit", "WS2812B, 4 SPI bits per bit at 3.2MHz (12 bytes/LED)",
+      3200000, 4, 0x8 /* 1000 */, 0xE /* 1110 */, 3, 300 },
+    // SK6812 wants ~300ns / ~600ns high, which 3 bits at 2.4MHz can't hit.
+    { "sk6812-rgbw", "SK6812 RGBW, 4 SPI bits per bit at 3.2MHz (16 bytes/LED)",
+      3200000, 4, 0x8 /* 1000 */, 0xC /* 1100 */, 4, 80 },
+    { "sk6812-rgb", "SK6812 RGB, 4 SPI bits per bit at 3.2MHz (12 bytes/LED)",
+      3200000, 4, 0x8 /* 1000 */, 0xC /* 1100 */, 3, 80 },
+};
+const int ws2812_num_profiles = sizeof(ws2812_profiles) / sizeof(ws2812_profiles[0]);
+
+const ws2812_profile_t *ws2812_profile_find(const char *name) {
+    if (name == NULL) return &ws2812_profiles[0];
+    for (int i = 0; i < ws2812_num_profiles; i++) {
+        if (strcmp(ws2812_profiles[i].name, name) == 0) return &ws2812_profiles[i];
+    }
+    return NULL;
+}
+
+void ws2812_print_profiles(void) {
+    fprintf(stderr, "Available encoding profiles:\n");
+    for (int i = 0; i < ws2812_num_profiles; i++) {
+        fprintf(stderr, "  %-12s %s\n", ws2812_profiles[i].name, ws2812_profiles[i].description);
+    }
+}
+
+const uint8_t ws2812_gamma8[256] = {
+      0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+      0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   1,   1,   1,   1,
+      1,   1,   1,   1,   1,   1,   1,   1,   1,   2,   2,   2,   2,   2,   2,   2,
+      2,   3,   3,   3,   3,   3,   3,   3,   4,   4,   4,   4,   4,   5,   5,   5,
+      5,   6,   6,   6,   6,   7,   7,   7,   7,   8,   8,   8,   9,   9,   9,  10,
+     10,  10,  11,  11,  11,  12,  12,  13,  13,  13,  14,  14,  15,  15,  16,  16,
+     17,  17,  18,  18,  19,  19,  20,  20,  21,  21,  22,  22,  23,  24,  24,  25,
+     25,  26,  27,  27,  28,  29,  29,  30,  31,  32,  32,  33,  34,  35,  35,  36,
+     37,  38,  39,  39,  40,  41,  42,  43,  44,  45,  46,  47,  48,  49,  50,  50,
+     51,  52,  54,  55,  56,  57,  58,  59,  60,  61,  62,  63,  64,  66,  67,  68,
+     69,  70,  72,  73,  74,  75,  77,  78,  79,  81,  82,  83,  85,  86,  87,  89,
+     90,  92,  93,  95,  96,  98,  99, 101, 102, 104, 105, 107, 109, 110, 112, 114,
+    115, 117, 119, 120, 122, 124, 126, 127, 129, 131, 133, 135, 137, 138, 140, 142,
+    144, 146, 148, 150, 152, 154, 156, 158, 160, 162, 164, 167, 169, 171, 173, 175,
+    177, 180, 182, 184, 186, 189, 191, 193, 196, 198, 200, 203, 205, 208, 210, 213,
+    215, 218, 220, 223, 225, 228, 231, 233, 236, 239, 241, 244, 247, 249, 252, 255,
+};
+
+// Fills enc->lut from enc->level and enc->limit: one copy per entry from enc->raw
+static void build_tables(ws2812_encoder_t *enc) {
+    const ws2812_profile_t *profile = enc->profile;
+
+    for (int c = 0; c < profile->colors; c++) {
+        for (int v = 0; v < 256; v++) {
+            unsigned out = (enc->level[c][v] * enc->limit) >> 8;
+            memcpy(enc->lut[c][v], enc->raw[out], WS2812_MAX_SPI_BITS);
+        }
+    }
+
+    int identity = (enc->limit == 256 && !enc->correction.gamma && enc->correction.brightness == 255);
+    for (int c = 0; c < profile->colors; c++) {
+        if (enc->correction.channel_scale[c] != 255) identity = 0;
+    }
+    enc->fast_grb = (identity && profile->spi_bits == 3 && profile->colors == 3 &&
+                     profile->pattern0 == 0x4 && profile->pattern1 == 0x6);
+}
+
+// Fills enc->level from enc->correction (integer math only)
+static void build_levels(ws2812_encoder_t *enc) {
+    const ws2812_correction_t *corr = &enc->correction;
+
+    for (int c = 0; c < enc->profile->colors; c++) {
+        unsigned scale = (corr->channel_scale[c] * corr->brightness + 127) / 255;
+        for (int v = 0; v < 256; v++) {
+            unsigned x = corr->gamma ? ws2812_gamma8[v] : (unsigned)v;
+            enc->level[c][v] = (uint8_t)((x * scale + 127) / 255);
+        }
+    }
+}
+
+int ws2812_encoder_init(ws2812_encoder_t *enc, const ws2812_profile_t *profile) {
+    unsigned bits = profile->spi_bits;
+    unsigned top = 1u << (bits - 1);
+
+    memset(enc, 0, sizeof(*enc));
+    if (bits < 2 || bits > WS2812_MAX_SPI_BITS ||
+        (profile->colors != 3 && profile->colors != 4)) {
+        return -1;
+    }
+    // Each pattern must start high and end low: the low tail keeps MOSI resting low
+    // between frames, which is what produces the latch.
+    if (!(profile->pattern0 & top) || !(profile->pattern1 & top) ||
+        (profile->pattern0 & 1) || (profile->pattern1 & 1)) {
+        return -1;
+    }
+
+    // Pick the encode_grb() kernel now, usually before any transmit thread exists
+    pthread_once(&encode_grb_once, encode_grb_select);
+
+    enc->profile = profile;
+    enc->bytes_per_color = bits; // 8 WS bits * 'bits' SPI bits / 8
+    enc->bytes_per_led = enc->bytes_per_color * profile->colors;
+    enc->limit = 256;
+    enc->ma_per_channel = WS2812_MA_PER_CHANNEL;
+
+    // Uncorrected pattern of every value
+    for (int v = 0; v < 256; v++) {
+        uint32_t p = 0;
+        for (int b = 7; b >= 0; b--) {
+            p = (p << bits) | (((v >> b) & 1) ? profile->pattern1 : profile->pattern0);
+        }
+        // MSB first
+        for (unsigned i = 0; i < enc->bytes_per_color; i++) {
+            enc->raw[v][i] = (p >> (8 * (enc->bytes_per_color - 1 - i))) & 0xFF;
+        }
+    }
+
+    ws2812_correction_t none = { 255, 0, { 255, 255, 255, 255 } };
+    ws2812_set_correction(enc, &none);
+    return 0;
+}
+
+void ws2812_set_correction(ws2812_encoder_t *enc, const ws2812_correction_t *corr) {
+    enc->correction = *corr;
+    build_levels(enc);
+    build_tables(enc);
+}
+
+void ws2812_set_brightness(ws2812_encoder_t *enc, uint8_t brightness) {
+    ws2812_correction_t corr = enc->correction;
+    corr.brightness = brightness;
+    ws2812_set_correction(enc, &corr);
+}
+
+void ws2812_set_power_budget(ws2812_encoder_t *enc, uint32_t budget_ma, uint32_t ma_per_channel) {
+    enc->budget_ma = budget_ma;
+    enc->ma_per_channel = ma_per_channel ? ma_per_channel : WS2812_MA_PER_CHANNEL;
+    if (budget_ma == 0 && enc->limit != 256) {
+        enc->limit = 256;
+        build_tables(enc);
+    }
+}
+
+uint32_t ws2812_limit_power(ws2812_encoder_t *enc, const uint8_t *src, size_t len) {
+    if (enc->budget_ma == 0) return 0;
+
+    int colors = enc->profile->colors;
+    uint64_t sum = 0;
+    for (size_t i = 0; i + colors <= len; i += colors) {
+        for (int c = 0; c < colors; c++) sum += enc->level[c][src[i + c]];
+    }
+
+    uint64_t idle_ma = (uint64_t)(len / colors) * WS2812_IDLE_MA_PER_LED;
+    uint64_t color_ma = (sum * enc->ma_per_channel + 254) / 255;
+    enc->last_estimate_ma = (uint32_t)(idle_ma + color_ma);
+
+    // Largest scale (in 1/256 steps) that keeps the color current within what's left of the budget
+    uint16_t limit = 256;
+    if (enc->last_estimate_ma > enc->budget_ma) {
+        uint64_t avail = enc->budget_ma > idle_ma ? enc->budget_ma - idle_ma : 0;
+        limit = color_ma ? (uint16_t)((avail * 256) / color_ma) : 0;
+        enc->frames_limited++;
+    }
+
+    // Dimming has to happen right away; brightening back up waits for a real step,
+    // so a frame hovering around the budget doesn't rebuild the tables every time
+    if (limit != enc->limit &&
+        (limit < enc->limit || limit >= enc->limit + WS2812_LIMIT_HYSTERESIS || limit == 256)) {
+        enc->limit = limit;
+        build_tables(enc);
+    }
+    return enc->last_estimate_ma;
+}
+
+void ws2812_encode_packed(const ws2812_encoder_t *enc, uint8_t *dst, const uint8_t *src, size_t len) {
+    if (enc->fast_grb) {
+        encode_grb(dst, src, len);
+        return;
+    }
+
+    // Constant-size copies so the compiler turns them into single loads/stores
+    if (enc->profile->colors == 4) {
+        for (size_t i = 0; i + 4 <= len; i += 4, dst += 4 * 4) {
+            memcpy(dst,      enc->lut[0][src[i]],     4);
+            memcpy(dst + 4,  enc->lut[1][src[i + 1]], 4);
+            memcpy(dst + 8,  enc->lut[2][src[i + 2]], 4);
+            memcpy(dst + 12, enc->lut[3][src[i + 3]], 4);
+        }
+    } else if (enc->bytes_per_color == 4) {
+        for (size_t i = 0; i + 3 <= len; i += 3, dst += 3 * 4) {
+            memcpy(dst,     enc->lut[0][src[i]],     4);
+            memcpy(dst + 4, enc->lut[1][src[i + 1]], 4);
+            memcpy(dst + 8, enc->lut[2][src[i + 2]], 4);
+        }
+    } else {
+        for (size_t i = 0; i + 3 <= len; i += 3, dst += 3 * 3) {
+            memcpy(dst,     enc->lut[0][src[i]],     3);
+            memcpy(dst + 3, enc->lut[1][src[i + 1]], 3);
+            memcpy(dst + 6, enc->lut[2][src[i + 2]], 3);
+        }
+    }
+}
+
+void ws2812_encode_pixel(const ws2812_encoder_t *enc, uint8_t *dst, uint32_t color) {
+    uint8_t packed[WS2812_MAX_COLORS];
+    ws2812_pack_pixel(enc, packed, color);
+
+    size_t n = enc->bytes_per_color;
+    for (int c = 0; c < enc->profile->colors; c++) {
+        memcpy(dst, enc->lut[c][packed[c]], n);
+        dst += n;
+    }
+}
@@ -0,0 +1,168 @@
+#ifndef WS2812_SPI_H
+#define WS2812_SPI_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+// --- SPI ENCODING ---
+// 1 WS2812 bit = 3 SPI bits at 2.4MHz.
+// Data 0 = 100 (binary), Data 1 = 110 (binary)
+// So one color byte becomes 3 SPI bytes and one LED (G, R, B) becomes 9.
+#define WS2812_SPI_BYTES_PER_COLOR 3
+#define WS2812_SPI_BYTES_PER_LED   9
+
+// Low time after the data that makes the LEDs latch (>280us for WS2812B).
+// Produced by a transfer delay (see spi_send_frame()), not by padding bytes.
+// The last SPI bit of every encoded byte is 0, so MOSI rests low during it.
+#define WS2812_LATCH_US 300
+
+// Precomputed SPI patterns: ws2812_spi_lut[val] holds the 3 SPI bytes (MSB first)
+// for color value 'val'. Generated at compile time, no init call needed.
+extern const uint8_t ws2812_spi_lut[256][WS2812_SPI_BYTES_PER_COLOR];
+
+// Encodes a single color byte (8 bits) into 3 SPI bytes (24 bits) via the table.
+static inline void encode_byte(uint8_t val, uint8_t *ptr) {
+    const uint8_t *p = ws2812_spi_lut[val];
+    ptr[0] = p[0];
+    ptr[1] = p[1];
+    ptr[2] = p[2];
+}
+
+// Reference encoder: the original 8-step shift/OR loop.
+// Kept so benchmarks and self-checks can compare against the table output.
+void encode_byte_bitwise(uint8_t val, uint8_t *ptr);
+
+// Converts a whole framebuffer of 0xRRGGBB pixels into the SPI layout in one pass.
+// 'dst' must hold count * WS2812_SPI_BYTES_PER_LED bytes. Output is in GRB order.
+void encode_frame(uint8_t *dst, const uint32_t *pixels, size_t count);
+
+// --- PACKED GRB ENCODING ---
+// Encodes 'len' bytes of a packed GRB framebuffer (3 bytes per LED, already in wire
+// order) into 'dst', which must hold len * WS2812_SPI_BYTES_PER_COLOR bytes.
+// The implementation is picked at runtime, once (pthread_once, so it is safe from any
+// thread), by ws2812_encoder_init() or the first call: the NEON kernel when the CPU
+// supports it, otherwise the lookup table. Set WS2812_ENCODER=scalar to force the
+// table path.
+void encode_grb(uint8_t *dst, const uint8_t *grb, size_t len);
+
+// Name of the implementation encode_grb() uses ("neon" or "scalar").
+const char *encode_grb_backend(void);
+
+// Individual implementations, exposed for benchmarks and self-checks.
+void encode_grb_scalar(uint8_t *dst, const uint8_t *grb, size_t len);
+#if defined(__ARM_NEON)
+#define WS2812_HAVE_NEON 1
+void encode_grb_neon(uint8_t *dst, const uint8_t *grb, size_t len);
+#endif
+
+// --- ENCODING PROFILES ---
+// Runtime-selectable SPI clock and density. More SPI bits per WS bit give finer
+// control over the high time (tighter timing margins) at the cost of wire size.
+// Everything above is the fixed "ws2812-3bit" profile; the encoder below handles any.
+#define WS2812_MAX_SPI_BITS 4   // Longest pattern per WS bit = max SPI bytes per color byte
+#define WS2812_MAX_COLORS   4   // GRBW
+
+typedef struct {
+    const char *name;
+    const char *description;
+    uint32_t spi_hz;
+    uint8_t spi_bits;       // SPI bits per WS bit (3 or 4)
+    uint8_t pattern0;       // SPI bits sent for a WS 0, MSB first (e.g. 100)
+    uint8_t pattern1;       // SPI bits sent for a WS 1 (e.g. 110)
+    uint8_t colors;         // Color bytes per LED: 3 (GRB) or 4 (GRBW)
+    uint32_t latch_us;      // Low time that latches the data
+} ws2812_profile_t;
+
+extern const ws2812_profile_t ws2812_profiles[];
+extern const int ws2812_num_profiles;
+
+// Looks up a profile by name. NULL returns the default (ws2812-3bit).
+// Returns NULL if there is no profile with that name.
+const ws2812_profile_t *ws2812_profile_find(const char *name);
+
+// Prints the available profile names and descriptions to stderr.
+void ws2812_print_profiles(void);
+
+// --- COLOR CORRECTION ---
+// Applied through the lookup tables, so it costs nothing per frame: changing it
+// only rebuilds the 256-entry tables. Channels are in wire order (G, R, B, W).
+#define WS2812_MA_PER_CHANNEL  20   // Typical current of one color channel at 255
+#define WS2812_IDLE_MA_PER_LED 1    // Quiescent current of one LED
+#define WS2812_LIMIT_HYSTERESIS 4   // Limiter raises its scale only in steps of at least 4/256
+
+typedef struct {
+    uint8_t brightness;                     // Global, 255 = full
+    uint8_t gamma;                          // 1 = apply the 2.8 gamma curve (ws2812_gamma8)
+    uint8_t channel_scale[WS2812_MAX_COLORS]; // Per-channel white balance (G, R, B, W), 255 = full
+} ws2812_correction_t;
+
+// Gamma 2.8 curve: perceived brightness steps evenly across 0-255
+extern const uint8_t ws2812_gamma8[256];
+
+// Per-profile encoder: the lookup tables and the sizes derived from the profile.
+typedef struct {
+    const ws2812_profile_t *profile;
+    size_t bytes_per_color;     // SPI bytes per color byte (== spi_bits)
+    size_t bytes_per_led;       // bytes_per_color * colors
+    int fast_grb;               // 3-bit profile with no correction: use encode_grb()
+
+    ws2812_correction_t correction;
+    uint8_t level[WS2812_MAX_COLORS][256];  // Corrected value per channel (before the power limit)
+    uint16_t limit;                         // Power limiter scale, 256 = none
+
+    // Power limiter (budget_ma = 0: off)
+    uint32_t budget_ma;
+    uint32_t ma_per_channel;
+    uint32_t last_estimate_ma;  // Estimate for the last frame checked, before limiting
+    uint64_t frames_limited;
+
+    uint8_t raw[256][WS2812_MAX_SPI_BITS];  // Uncorrected SPI bytes per value
+
+    // SPI bytes for each (channel, value), correction and limit already applied
+    uint8_t lut[WS2812_MAX_COLORS][256][WS2812_MAX_SPI_BITS];
+} ws2812_encoder_t;
+
+// Builds the tables for 'profile' with no correction. Returns -1 if the profile is malformed.
+int ws2812_encoder_init(ws2812_encoder_t *enc, const ws2812_profile_t *profile);
+
+// Sets brightness, gamma and white balance, and rebuilds the tables.
+// Pixels that were already encoded have to be encoded again (e.g. fb_invalidate()).
+void ws2812_set_correction(ws2812_encoder_t *enc, const ws2812_correction_t *corr);
+
+// Shortcut: changes only the global brightness.
+void ws2812_set_brightness(ws2812_encoder_t *enc, uint8_t brightness);
+
+// Enables the power limiter: frames whose estimated draw exceeds 'budget_ma' are scaled
+// down as a whole. 'ma_per_channel' is the current of one channel at full (0 = default).
+// budget_ma = 0 turns it off.
+void ws2812_set_power_budget(ws2812_encoder_t *enc, uint32_t budget_ma, uint32_t ma_per_channel);
+
+// Estimates the current of a packed wire-order frame ('len' color bytes) after correction,
+// and adjusts the limiter so the next encode stays within budget. Call before encoding.
+// Returns the estimate in mA before limiting. No-op returning 0 if the limiter is off.
+uint32_t ws2812_limit_power(ws2812_encoder_t *enc, const uint8_t *src, size_t len);
+
+// SPI bytes needed for 'count' LEDs (no latch padding).
+static inline size_t ws2812_frame_bytes(const ws2812_encoder_t *enc, size_t count) {
+    return count * enc->bytes_per_led;
+}
+
+// Encodes 'len' packed color bytes already in wire order (GRB or GRBW, so 'len' is a
+// multiple of the color count). 'dst' must hold len * bytes_per_color bytes.
+void ws2812_encode_packed(const ws2812_encoder_t *enc, uint8_t *dst, const uint8_t *src, size_t len);
+
+// Encodes one pixel (0xWWRRGGBB; W is ignored for 3-color profiles) into 'dst'
+// in wire order. Writes bytes_per_led bytes.
+void ws2812_encode_pixel(const ws2812_encoder_t *enc, uint8_t *dst, uint32_t color);
+
+// Writes one pixel into a packed wire-order buffer (3 or 4 bytes per LED).
+static inline void ws2812_pack_pixel(const ws2812_encoder_t *enc, uint8_t *dst, uint32_t color) {
+    dst[0] = (color >> 8) & 0xFF;       // Green
+    dst[1] = (color >> 16) & 0xFF;      // Red
+    dst[2] = color & 0xFF;              // Blue
+    if (enc->profile->colors == 4) {
+        dst[3] = (color >> 24) & 0xFF;  // White
+    }
+}
+
+#endif
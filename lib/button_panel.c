@@ -0,0 +1,24 @@
+#include <sys/ioctl.h>
+#include <linux/i2c-dev.h>
+#include "button_panel.h"
+
+int button_panel_open(button_panel_t *bp, int i2c_fd, const uint8_t *addrs, int count) {
+    static const uint8_t default_addr[1] = { BUTTON_PANEL_ADDR };
+    if (!addrs || count <= 0) {
+        addrs = default_addr;
+        count = 1;
+    }
+    return button_matrix_open(&bp->matrix, i2c_fd, addrs, count);
+}
+
+int button_panel_read_split(button_panel_t *bp, uint64_t *pressed) {
+    button_matrix_t *bm = &bp->matrix;
+    for (int k = 0; k < bm->count; k++) {
+        if (ioctl(bm->fd, I2C_SLAVE, bm->addrs[k]) < 0 ||
+            pca9555_read_inputs_split(bm->fd, bm->inputs[k]) < 0) {
+            return -1;
+        }
+    }
+    button_matrix_pressed(bm, pressed);
+    return 0;
+}
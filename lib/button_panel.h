@@ -0,0 +1,43 @@
+#ifndef BUTTON_PANEL_H
+#define BUTTON_PANEL_H
+
+#include <stdint.h>
+#include "../buttons/button_matrix.h"
+
+// --- BUTTON PANEL ---
+// The PCA9555 expanders on the shared I2C fd, read as one matrix (see
+// buttons/button_matrix.h). All reads of the panel go through here, so the per-expander
+// repeated-start transaction is the only read path.
+
+// --- CONFIGURATION ---
+#define BUTTON_PANEL_INT_PIN 17     // Wire-ORed INT lines of all expanders
+#define BUTTON_PANEL_ADDR    0x23   // Default expander (check 'i2cdetect -y 1')
+
+typedef struct {
+    button_matrix_t matrix;
+} button_panel_t;
+
+// Configures the expanders at 'addrs' (NULL = just BUTTON_PANEL_ADDR) on 'i2c_fd'
+// (panel_hw_t.i2c_fd). Returns 0, or -1 with the address that didn't answer printed.
+int button_panel_open(button_panel_t *bp, int i2c_fd, const uint8_t *addrs, int count);
+
+// Reads every expander; 'pressed' holds BUTTON_MATRIX_WORDS words (bit i = input i
+// pressed). Returns 0, or -1 if none answered.
+static inline int button_panel_read(button_panel_t *bp, uint64_t *pressed) {
+    return button_matrix_read(&bp->matrix, pressed);
+}
+
+// Same result the old way: I2C_SLAVE plus write() + read() per expander.
+// Only for latency comparisons (--measure).
+int button_panel_read_split(button_panel_t *bp, uint64_t *pressed);
+
+// Raw Port 0 / Port 1 bytes of expander 'k' from the last read
+static inline const uint8_t *button_panel_ports(const button_panel_t *bp, int k) {
+    return bp->matrix.inputs[k];
+}
+
+static inline int button_panel_inputs(const button_panel_t *bp) {
+    return button_matrix_inputs(&bp->matrix);
+}
+
+#endif
@@ -0,0 +1,369 @@
+#define _GNU_SOURCE // eventfd/timerfd
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+#include <poll.h>
+#include <unistd.h>
+#include <sys/eventfd.h>
+#include <sys/timerfd.h>
+#include "effects.h"
+#include "../common/arena.h"
+
+static uint64_t now_ns(void) {
+    struct timespec te;
+    clock_gettime(CLOCK_MONOTONIC, &te);
+    return (uint64_t)te.tv_sec * 1000000000ULL + (uint64_t)te.tv_nsec;
+}
+
+static int clamp_fps(int fps) {
+    if (fps < EFFECTS_MIN_FPS) return EFFECTS_MIN_FPS;
+    if (fps > EFFECTS_MAX_FPS) return EFFECTS_MAX_FPS;
+    return fps;
+}
+
+// --- FIXED-POINT HELPERS ---
+
+uint32_t effect_scale_color(uint32_t color, uint8_t scale) {
+    uint32_t out = 0;
+    for (int shift = 0; shift < 32; shift += 8) {
+        out |= (uint32_t)effect_scale8((uint8_t)(color >> shift), scale) << shift;
+    }
+    return out;
+}
+
+uint8_t effect_sin8(uint8_t angle) {
+    // Bhaskara's approximation on the half turn x = 0..128 (error below 0.2%):
+    // sin = 4p / (20480 - p) with p = x * (128 - x)
+    uint32_t x = angle & 127;
+    uint32_t p = x * (128 - x);
+    uint32_t v = 127 * 4 * p / (20480 - p);
+    return angle < 128 ? (uint8_t)(128 + v) : (uint8_t)(127 - v);
+}
+
+uint32_t effect_hue(uint8_t hue) {
+    // Six 43-step segments, one channel ramping in each
+    uint32_t region = hue / 43;
+    uint32_t up = (hue - region * 43) * 6;  // 0-252
+    uint32_t down = 255 - up;
+    switch (region) {
+        case 0:  return 0xFF0000 | (up << 8);       // Red -> yellow
+        case 1:  return (down << 16) | 0x00FF00;    // Yellow -> green
+        case 2:  return 0x00FF00 | up;              // Green -> cyan
+        case 3:  return (down << 8) | 0x0000FF;     // Cyan -> blue
+        case 4:  return (up << 16) | 0x0000FF;      // Blue -> magenta
+        default: return 0xFF0000 | down;            // Magenta -> red
+    }
+}
+
+// dst + (src - dst) * a / 256 on all four channels, two at a time (a = 0-256)
+static inline uint32_t blend_over(uint32_t dst, uint32_t src, uint32_t a) {
+    uint32_t rb = (((dst & 0x00FF00FF) * (256 - a) + (src & 0x00FF00FF) * a) >> 8) & 0x00FF00FF;
+    uint32_t ga = ((((dst >> 8) & 0x00FF00FF) * (256 - a) + ((src >> 8) & 0x00FF00FF) * a) >> 8) & 0x00FF00FF;
+    return rb | (ga << 8);
+}
+
+// dst + src * a / 256 per channel, saturating at 255
+static inline uint32_t blend_add(uint32_t dst, uint32_t src, uint32_t a) {
+    uint32_t out = 0;
+    for (int shift = 0; shift < 32; shift += 8) {
+        uint32_t c = ((dst >> shift) & 0xFF) + ((((src >> shift) & 0xFF) * a) >> 8);
+        out |= (c > 255 ? 255 : c) << shift;
+    }
+    return out;
+}
+
+// --- EFFECTS ---
+
+static void render_chase(const effect_layer_t *l, uint32_t t_ms, uint32_t *color, uint8_t *alpha, size_t n) {
+    // Head position in 16.16 LEDs, wrapped around the zone
+    int64_t span = (int64_t)n << 16;
+    int64_t head = ((int64_t)l->speed * t_ms * 65536 / 1000) % span;
+    if (head < 0) head += span;
+    uint64_t tail = (uint64_t)(l->width ? l->width : 8) << 16;
+
+    for (size_t i = 0; i < n; i++) {
+        // Distance behind the head in the direction of travel, sub-LED precise
+        int64_t d = l->speed >= 0 ? head - ((int64_t)i << 16) : ((int64_t)i << 16) - head;
+        if (d < 0) d += span;
+        color[i] = l->color;
+        alpha[i] = (uint64_t)d < tail ? (uint8_t)(255 - (uint64_t)d * 255 / tail) : 0;
+    }
+}
+
+static void render_breathe(const effect_layer_t *l, uint32_t t_ms, uint32_t *color, uint8_t *alpha, size_t n) {
+    uint32_t period = l->period_ms ? l->period_ms : 2000;
+    // Starts dark: a quarter turn back puts the sine at its minimum
+    uint8_t level = effect_sin8((uint8_t)((t_ms % period) * 256 / period - 64));
+    for (size_t i = 0; i < n; i++) {
+        color[i] = l->color;
+        alpha[i] = level;
+    }
+}
+
+static void render_rainbow(const effect_layer_t *l, uint32_t t_ms, uint32_t *color, uint8_t *alpha, size_t n) {
+    uint32_t shift = l->period_ms ? (t_ms % l->period_ms) * 256 / l->period_ms : 0;
+    for (size_t i = 0; i < n; i++) {
+        color[i] = effect_hue((uint8_t)(shift + i * 256 / n));
+        alpha[i] = 255;
+    }
+}
+
+static void render_bar(const effect_layer_t *l, uint32_t t_ms, uint32_t *color, uint8_t *alpha, size_t n) {
+    // Fill length in 8.8 LEDs: the LED at the edge is lit partly
+    uint32_t fill = (uint32_t)((uint64_t)l->level * n * 256 / 255);
+    for (size_t i = 0; i < n; i++) {
+        uint32_t lit = i * 256 >= fill ? 0 : fill - i * 256 >= 256 ? 256 : fill - i * 256;
+        if (l->color2) {
+            color[i] = blend_over(l->color2, l->color, lit);
+            alpha[i] = 255;
+        } else {
+            color[i] = l->color;
+            alpha[i] = lit >= 256 ? 255 : (uint8_t)lit;
+        }
+    }
+}
+
+// Draws one layer into the scratch buffers and blends it into the canvas. Under 'lock'.
+static void composite(effects_t *fx, const effect_layer_t *l, uint64_t now) {
+    if (l->start >= fx->count) return;
+    size_t n = fx->count - l->start;
+    if (l->len && l->len < n) n = l->len;
+    uint32_t t_ms = (uint32_t)((now - l->t0_ns) / 1000000ULL);
+
+    switch (l->type) {
+        case EFFECT_SOLID:
+            for (size_t i = 0; i < n; i++) {
+                fx->color[i] = l->color;
+                fx->alpha[i] = 255;
+            }
+            break;
+        case EFFECT_CHASE:   render_chase(l, t_ms, fx->color, fx->alpha, n); break;
+        case EFFECT_BREATHE: render_breathe(l, t_ms, fx->color, fx->alpha, n); break;
+        case EFFECT_RAINBOW: render_rainbow(l, t_ms, fx->color, fx->alpha, n); break;
+        case EFFECT_BAR:     render_bar(l, t_ms, fx->color, fx->alpha, n); break;
+        case EFFECT_CUSTOM:
+            if (!l->render) return;
+            l->render(l, t_ms, fx->color, fx->alpha, n);
+            break;
+        default:
+            return;
+    }
+
+    uint32_t opacity = l->opacity ? l->opacity : 255;
+    uint32_t *dst = fx->canvas + l->start;
+    for (size_t i = 0; i < n; i++) {
+        // Coverage times opacity, as 0-256
+        uint32_t a = fx->alpha[i] * opacity + 128;
+        a = (a + (a >> 8)) >> 8;
+        a += a >> 7;
+        if (a == 0) continue;
+        dst[i] = l->blend == EFFECT_BLEND_ADD ? blend_add(dst[i], fx->color[i], a)
+                                              : blend_over(dst[i], fx->color[i], a);
+    }
+}
+
+// --- ENGINE ---
+
+int effects_init(effects_t *fx, led_strip_t *strip, int fps) {
+    memset(fx, 0, sizeof(*fx));
+    fx->strip = strip;
+    fx->count = strip->count;
+    fx->fps = clamp_fps(fps);
+    fx->timer_fd = fx->wake_fd = -1;
+    pthread_mutex_init(&fx->lock, NULL);
+
+    fx->canvas = arena_calloc(fx->count, sizeof(uint32_t));
+    fx->color = arena_calloc(fx->count, sizeof(uint32_t));
+    fx->alpha = arena_calloc(fx->count, 1);
+    if (!fx->canvas || !fx->color || !fx->alpha) {
+        effects_free(fx);
+        return -1;
+    }
+    fx->start_ns = fx->window_ns = now_ns();
+    return 0;
+}
+
+void effects_free(effects_t *fx) {
+    if (!fx->strip) return;
+    effects_stop(fx);
+    pthread_mutex_destroy(&fx->lock);
+    arena_free(fx->canvas);
+    arena_free(fx->color);
+    arena_free(fx->alpha);
+    fx->canvas = NULL;
+    fx->color = NULL;
+    fx->alpha = NULL;
+    fx->strip = NULL;
+}
+
+int effects_set_layer(effects_t *fx, int index, const effect_layer_t *layer) {
+    if (index < 0 || index >= EFFECTS_MAX_LAYERS) return -1;
+    pthread_mutex_lock(&fx->lock);
+    if (layer) {
+        fx->layers[index] = *layer;
+        fx->layers[index].t0_ns = now_ns();
+    } else {
+        memset(&fx->layers[index], 0, sizeof(fx->layers[index]));
+    }
+    pthread_mutex_unlock(&fx->lock);
+    return 0;
+}
+
+void effects_set_level(effects_t *fx, int index, uint8_t level) {
+    if (index < 0 || index >= EFFECTS_MAX_LAYERS) return;
+    pthread_mutex_lock(&fx->lock);
+    fx->layers[index].level = level;
+    pthread_mutex_unlock(&fx->lock);
+}
+
+int effects_render(effects_t *fx, uint64_t now) {
+    pthread_mutex_lock(&fx->lock);
+    memset(fx->canvas, 0, fx->count * sizeof(uint32_t));
+    for (int k = 0; k < EFFECTS_MAX_LAYERS; k++) {
+        if (fx->layers[k].type != EFFECT_NONE) composite(fx, &fx->layers[k], now);
+    }
+    pthread_mutex_unlock(&fx->lock);
+
+    // The framebuffer drops unchanged pixels, so only what moved is re-encoded
+    for (size_t i = 0; i < fx->count; i++) led_strip_set(fx->strip, i, fx->canvas[i]);
+    uint64_t rendered = now_ns();
+    int ret = led_strip_show(fx->strip);
+    uint64_t done = now_ns();
+
+    pthread_mutex_lock(&fx->lock);
+    fx->frames++;
+    fx->window_frames++;
+    if (rendered - now > fx->render_ns_max) fx->render_ns_max = rendered - now;
+    if (done - now > fx->frame_ns_max) fx->frame_ns_max = done - now;
+    if (done - fx->window_ns >= EFFECTS_REPORT_MS * 1000000ULL) {
+        fx->last_fps = fx->window_frames * 1e9 / (done - fx->window_ns);
+        fx->window_ns = done;
+        fx->window_frames = 0;
+    }
+    pthread_mutex_unlock(&fx->lock);
+    return ret;
+}
+
+static void arm_timer(effects_t *fx, int fps) {
+    long period_ns = 1000000000L / fps;
+    struct itimerspec its = {
+        .it_interval = { period_ns / 1000000000L, period_ns % 1000000000L },
+        .it_value = { period_ns / 1000000000L, period_ns % 1000000000L },
+    };
+    timerfd_settime(fx->timer_fd, 0, &its, NULL);
+}
+
+static void *frame_thread(void *arg) {
+    effects_t *fx = (effects_t *)arg;
+
+    pthread_mutex_lock(&fx->lock);
+    int fps = fx->fps;
+    pthread_mutex_unlock(&fx->lock);
+    arm_timer(fx, fps);
+
+    while (1) {
+        struct pollfd fds[2] = {
+            { .fd = fx->timer_fd, .events = POLLIN },
+            { .fd = fx->wake_fd, .events = POLLIN },
+        };
+        if (poll(fds, 2, -1) < 0) continue;
+
+        uint64_t count = 0;
+        if (fds[1].revents & POLLIN) {
+            while (read(fx->wake_fd, &count, sizeof(count)) < 0 && errno == EINTR);
+            pthread_mutex_lock(&fx->lock);
+            int running = fx->running, new_fps = fx->fps;
+            pthread_mutex_unlock(&fx->lock);
+            if (!running) break;
+            if (new_fps != fps) {
+                fps = new_fps;
+                arm_timer(fx, fps);
+            }
+        }
+        if (!(fds[0].revents & POLLIN)) continue;
+        if (read(fx->timer_fd, &count, sizeof(count)) != sizeof(count) || count == 0) continue;
+
+        // Every tick missed while the last frame was on the wire collapses into this one
+        if (count > 1) {
+            pthread_mutex_lock(&fx->lock);
+            fx->dropped += count - 1;
+            pthread_mutex_unlock(&fx->lock);
+        }
+        effects_render(fx, now_ns());
+    }
+    return NULL;
+}
+
+static void wake(effects_t *fx) {
+    uint64_t one = 1;
+    if (write(fx->wake_fd, &one, sizeof(one)) < 0) {
+        // Counter overflow only: the thread is awake anyway
+    }
+}
+
+int effects_start(effects_t *fx) {
+    if (fx->running) return 0;
+    fx->timer_fd = timerfd_create(CLOCK_MONOTONIC, TFD_CLOEXEC);
+    fx->wake_fd = eventfd(0, EFD_CLOEXEC);
+    if (fx->timer_fd < 0 || fx->wake_fd < 0) {
+        perror("Effects: timerfd/eventfd");
+        if (fx->timer_fd >= 0) close(fx->timer_fd);
+        if (fx->wake_fd >= 0) close(fx->wake_fd);
+        fx->timer_fd = fx->wake_fd = -1;
+        return -1;
+    }
+
+    fx->running = 1;
+    fx->start_ns = fx->window_ns = now_ns();
+    int err = pthread_create(&fx->thread, NULL, frame_thread, fx);
+    if (err != 0) {
+        fprintf(stderr, "Effects: can't start thread: %s\n", strerror(err));
+        fx->running = 0;
+        close(fx->timer_fd);
+        close(fx->wake_fd);
+        fx->timer_fd = fx->wake_fd = -1;
+        return -1;
+    }
+    return 0;
+}
+
+void effects_stop(effects_t *fx) {
+    if (!fx->running) return;
+    pthread_mutex_lock(&fx->lock);
+    fx->running = 0;
+    pthread_mutex_unlock(&fx->lock);
+    wake(fx);
+    pthread_join(fx->thread, NULL);
+
+    close(fx->timer_fd);
+    close(fx->wake_fd);
+    fx->timer_fd = fx->wake_fd = -1;
+}
+
+void effects_set_fps(effects_t *fx, int fps) {
+    pthread_mutex_lock(&fx->lock);
+    fx->fps = clamp_fps(fps);
+    int running = fx->running;
+    pthread_mutex_unlock(&fx->lock);
+    if (running) wake(fx);
+}
+
+double effects_fps(effects_t *fx) {
+    pthread_mutex_lock(&fx->lock);
+    double fps = fx->last_fps;
+    pthread_mutex_unlock(&fx->lock);
+    return fps;
+}
+
+void effects_print_stats(effects_t *fx, FILE *f) {
+    pthread_mutex_lock(&fx->lock);
+    double elapsed = (now_ns() - fx->start_ns) / 1e9;
+    fprintf(f, "Effects: %llu frames (%.1f fps average, target %d), %llu ticks dropped, "
+               "worst render %.2f ms, worst frame %.2f ms\n",
+            (unsigned long long)fx->frames, elapsed > 0 ? fx->frames / elapsed : 0.0, fx->fps,
+            (unsigned long long)fx->dropped, fx->render_ns_max / 1e6, fx->frame_ns_max / 1e6);
+    pthread_mutex_unlock(&fx->lock);
+}
@@ -0,0 +1,153 @@
+#ifndef EFFECTS_H
+#define EFFECTS_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stddef.h>
+#include <pthread.h>
+#include "led_strip.h"
+
+// --- EFFECTS ENGINE ---
+// Layers of animated effects composited into one RGB canvas and handed to
+// led_strip_show() on a fixed-rate frame clock (a periodic timerfd on the engine's
+// own thread). All math is integer: colors are 8 bits per channel, brightness and
+// opacity are 0-255 fractions, positions are 16.16 fixed point, and time is the
+// layer's age in ms. Frame n shows the effects at the time it is rendered, not at
+// the time it was due: when a frame (the SPI transfer, ~5.6 ms for 186 LEDs) takes
+// longer than the frame period, the missed ticks are coalesced into one and counted
+// as dropped, so the strip never lags behind the clock.
+//
+// Layer 0 is drawn first; each layer is blended over the ones below it with its
+// opacity and the coverage its effect draws (a chase's tail, a bar's lit part).
+// Colors use the framebuffer format: 0xRRGGBB, or 0xWWRRGGBB on RGBW profiles.
+//
+// Usage:
+//   effects_init(&fx, &strip, 60);
+//   effects_set_layer(&fx, 0, &(effect_layer_t){ .type = EFFECT_RAINBOW, .opacity = 64, .period_ms = 5000 });
+//   effects_set_layer(&fx, 1, &(effect_layer_t){ .type = EFFECT_CHASE, .color = 0xFF4000, .width = 12, .speed = 90 });
+//   effects_start(&fx);             // or effects_render() from your own timer
+//   effects_set_level(&fx, 2, 128); // e.g. from a button handler
+
+#define EFFECTS_MAX_LAYERS 8
+#define EFFECTS_MIN_FPS    1
+#define EFFECTS_MAX_FPS    200
+#define EFFECTS_REPORT_MS  1000     // Window for effects_fps()
+
+typedef enum {
+    EFFECT_NONE,        // Layer off
+    EFFECT_SOLID,       // 'color' everywhere
+    EFFECT_CHASE,       // Head moving at 'speed' LEDs/s (negative = backwards), 'width' LED fading tail
+    EFFECT_BREATHE,     // 'color' fading in and out, one cycle per 'period_ms'
+    EFFECT_RAINBOW,     // Hue wheel across the zone, scrolling once per 'period_ms' (0 = still)
+    EFFECT_BAR,         // First 'level'/255 of the zone in 'color', the rest in 'color2' (0 = transparent)
+    EFFECT_CUSTOM       // 'render' callback
+} effect_type_t;
+
+typedef enum {
+    EFFECT_BLEND_OVER,  // Cover what is below
+    EFFECT_BLEND_ADD    // Add to it (saturating), for glows and sparks
+} effect_blend_t;
+
+typedef struct effect_layer effect_layer_t;
+
+// Draws 'len' pixels of a custom layer: 'color' and 'alpha' (coverage, 0-255) per pixel.
+// 't_ms' is the layer's age. Runs on the engine thread with the engine locked.
+typedef void (*effect_render_fn)(const effect_layer_t *layer, uint32_t t_ms,
+                                 uint32_t *color, uint8_t *alpha, size_t len);
+
+struct effect_layer {
+    effect_type_t type;
+    effect_blend_t blend;
+    uint8_t opacity;        // 0 is read as 255 (fully opaque), so a zeroed layer shows
+    uint16_t start;         // Zone: LEDs start..start+len-1 (len 0 = to the end of the strip)
+    uint16_t len;
+    uint32_t color;
+    uint32_t color2;
+    int16_t speed;          // EFFECT_CHASE: LEDs per second
+    uint16_t width;         // EFFECT_CHASE: tail length in LEDs (0 = 8)
+    uint16_t period_ms;     // EFFECT_BREATHE / EFFECT_RAINBOW (0 = 2000 for breathe)
+    uint8_t level;          // EFFECT_BAR fill, set with effects_set_level()
+    effect_render_fn render;    // EFFECT_CUSTOM
+    void *user;
+
+    uint64_t t0_ns;         // Set by effects_set_layer(): age 0
+};
+
+typedef struct {
+    led_strip_t *strip;
+    size_t count;
+    uint32_t *canvas;       // Composited frame
+    uint32_t *color;        // Scratch for one layer
+    uint8_t *alpha;
+    effect_layer_t layers[EFFECTS_MAX_LAYERS];
+
+    int fps;
+    pthread_t thread;
+    pthread_mutex_t lock;   // Layers, fps and the stats
+    int timer_fd;
+    int wake_fd;            // eventfd: fps change / stop
+    int running;
+
+    // Stats
+    uint64_t frames;        // Rendered and sent
+    uint64_t dropped;       // Ticks coalesced because a frame ran long
+    uint64_t render_ns_max; // Compositing (without the SPI transfer)
+    uint64_t frame_ns_max;  // Compositing + show()
+    uint64_t start_ns;
+    uint64_t window_ns;     // Start of the current fps window
+    uint64_t window_frames;
+    double last_fps;        // Achieved fps over the last complete window
+} effects_t;
+
+// Sets up the engine on an initialised strip at 'fps' frames per second (clamped to
+// EFFECTS_MIN_FPS - EFFECTS_MAX_FPS). All layers off. Returns 0 or -1.
+int effects_init(effects_t *fx, led_strip_t *strip, int fps);
+
+// Stops the thread if running and frees the buffers. The strip is left as it is.
+void effects_free(effects_t *fx);
+
+// Starts the frame clock thread, the only user of the strip until effects_stop().
+// Returns 0, or -1 with the error printed.
+int effects_start(effects_t *fx);
+
+// Stops and joins the frame clock thread.
+void effects_stop(effects_t *fx);
+
+// Changes the frame rate (clamped), also while running.
+void effects_set_fps(effects_t *fx, int fps);
+
+// Copies 'layer' into slot 'index' and restarts its animation. NULL turns the slot off.
+// Safe from any thread. Returns 0, or -1 for a bad index.
+int effects_set_layer(effects_t *fx, int index, const effect_layer_t *layer);
+
+// Updates only the fill of a bar (or any layer's level) without restarting it.
+void effects_set_level(effects_t *fx, int index, uint8_t level);
+
+// Composites the layers at 'now_ns' (CLOCK_MONOTONIC) and shows the frame. This is
+// what the thread runs on every tick; call it yourself instead of effects_start()
+// to drive the engine from an existing timer. Returns led_strip_show()'s result.
+int effects_render(effects_t *fx, uint64_t now_ns);
+
+// Achieved frames per second over the last EFFECTS_REPORT_MS window.
+double effects_fps(effects_t *fx);
+
+// Frames, dropped ticks, average fps and worst frame times.
+void effects_print_stats(effects_t *fx, FILE *f);
+
+// --- FIXED-POINT HELPERS ---
+
+// c * scale / 255, rounded, for one 8-bit value
+static inline uint8_t effect_scale8(uint8_t c, uint8_t scale) {
+    return (uint8_t)(((uint32_t)c * scale + 128 + (((uint32_t)c * scale + 128) >> 8)) >> 8);
+}
+
+// Every channel of a packed color scaled by 'scale' / 255
+uint32_t effect_scale_color(uint32_t color, uint8_t scale);
+
+// Sine of 'angle' (256 = full turn) mapped to 0-255, rational approximation (within 0.2%)
+uint8_t effect_sin8(uint8_t angle);
+
+// Fully saturated color for 'hue' (0-255 around the wheel)
+uint32_t effect_hue(uint8_t hue);
+
+#endif
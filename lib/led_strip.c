@@ -0,0 +1,90 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/ioctl.h>
+#include <linux/spi/spidev.h>
+#include "led_strip.h"
+#include "../common/arena.h"
+
+int led_strip_init(led_strip_t *strip, int spi_fd, size_t count, const ws2812_profile_t *profile) {
+    memset(strip, 0, sizeof(*strip));
+    if (!profile) profile = ws2812_profile_find(NULL);
+    if (!profile || ws2812_encoder_init(&strip->enc, profile) < 0) return -1;
+
+    // The fd may have been opened for another profile's clock. Fails harmlessly on the mock sink.
+    uint32_t speed = profile->spi_hz;
+    ioctl(spi_fd, SPI_IOC_WR_MAX_SPEED_HZ, &speed);
+
+    strip->count = count;
+    strip->tx_len = ws2812_frame_bytes(&strip->enc, count);
+    if (spi_check_frame_len(strip->tx_len) < 0) return -1;
+    strip->tx_buffer = arena_calloc(1, strip->tx_len);
+    strip->packed = arena_calloc(1, count * profile->colors);
+
+    // All pixels start black and dirty, so the first show() encodes the whole strip
+    if (!strip->tx_buffer || !strip->packed || fb_init(&strip->fb, strip->tx_buffer, count, &strip->enc) < 0) {
+        arena_free(strip->tx_buffer);
+        arena_free(strip->packed);
+        strip->tx_buffer = NULL;
+        strip->packed = NULL;
+        return -1;
+    }
+    spi_sched_init(&strip->sched, spi_fd, profile->spi_hz, profile->latch_us);
+    return 0;
+}
+
+void led_strip_free(led_strip_t *strip) {
+    if (!strip->tx_buffer) return;
+    fb_free(&strip->fb);
+    arena_free(strip->tx_buffer);
+    arena_free(strip->packed);
+    strip->tx_buffer = NULL;
+    strip->packed = NULL;
+}
+
+int led_strip_set_power_budget(led_strip_t *strip, uint32_t budget_ma) {
+    ws2812_set_power_budget(&strip->enc, budget_ma, 0);
+    fb_invalidate(&strip->fb);
+    return 0;
+}
+
+// Copies the framebuffer into the wire-order packed frame
+static void pack_frame(led_strip_t *strip) {
+    int colors = strip->enc.profile->colors;
+    for (size_t i = 0; i < strip->count; i++) {
+        ws2812_pack_pixel(&strip->enc, strip->packed + i * colors, fb_get(&strip->fb, i));
+    }
+}
+
+int led_strip_show(led_strip_t *strip) {
+    size_t packed_len = strip->count * strip->enc.profile->colors;
+    int packed = 0;
+
+    if (strip->enc.budget_ma) {
+        // The limiter works on the wire-order frame. A new scale changes every
+        // table entry, so everything gets re-encoded.
+        pack_frame(strip);
+        packed = 1;
+        uint16_t limit = strip->enc.limit;
+        ws2812_limit_power(&strip->enc, strip->packed, packed_len);
+        if (strip->enc.limit != limit) fb_invalidate(&strip->fb);
+    }
+
+    if (strip->enc.fast_grb && fb_dirty_count(&strip->fb) * LED_STRIP_FULL_FRAME_DIV >= strip->count) {
+        // Most of the frame changed: one encode_grb() pass (NEON on the Pi 5) over
+        // the packed frame beats re-encoding pixel by pixel
+        if (!packed) pack_frame(strip);
+        ws2812_encode_packed(&strip->enc, strip->tx_buffer, strip->packed, packed_len);
+        fb_mark_clean(&strip->fb);
+        strip->full_frames++;
+    } else {
+        fb_flush(&strip->fb);
+    }
+    strip->frames++;
+    return spi_sched_send(&strip->sched, strip->tx_buffer, strip->tx_len);
+}
+
+int led_strip_clear(led_strip_t *strip) {
+    fb_fill(&strip->fb, 0x000000);
+    return led_strip_show(strip);
+}
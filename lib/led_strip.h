@@ -0,0 +1,61 @@
+#ifndef LED_STRIP_H
+#define LED_STRIP_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "../leds/ws2812_spi.h"
+#include "../leds/led_framebuffer.h"
+#include "../leds/spi_tx.h"
+
+// --- LED STRIP ---
+// One WS2812 strip on the shared SPI fd: the encoder tables, the dirty-tracking
+// framebuffer, the encoded tx buffer and the frame scheduler, behind
+// set_pixel / fill / show. show() re-encodes only the pixels that changed and
+// sends the frame as one SPI_IOC_MESSAGE, adding latch time only if needed.
+// When at least 1/LED_STRIP_FULL_FRAME_DIV of the strip changed and the encoder
+// allows it (enc.fast_grb: ws2812-3bit, no correction or limiting), the whole
+// frame is encoded at once from a packed copy with encode_grb() instead (NEON on
+// the Pi 5, WS2812_ENCODER=scalar forces the table).
+//
+// The framebuffer points at the strip's own encoder: don't copy or move an
+// initialised led_strip_t.
+
+#define LED_STRIP_FULL_FRAME_DIV 2  // Full-frame encode from half the strip changed
+
+typedef struct {
+    ws2812_encoder_t enc;
+    framebuffer_t fb;
+    spi_frame_sched_t sched;
+    uint8_t *tx_buffer;
+    size_t tx_len;
+    size_t count;
+    uint8_t *packed;        // Wire-order copy for the power limiter and full-frame encodes
+    uint64_t frames;
+    uint64_t full_frames;   // Frames encoded in one encode_grb() pass
+} led_strip_t;
+
+// Sets up 'count' LEDs with 'profile' (NULL = default) on 'spi_fd' (from panel_hw_t).
+// All LEDs start black. Returns 0 or -1.
+int led_strip_init(led_strip_t *strip, int spi_fd, size_t count, const ws2812_profile_t *profile);
+
+// Frees the buffers. Doesn't close the fd (panel_hw_close() does).
+void led_strip_free(led_strip_t *strip);
+
+// Frames estimated above 'budget_ma' are dimmed as a whole (0 = no limit). Returns 0 or -1.
+int led_strip_set_power_budget(led_strip_t *strip, uint32_t budget_ma);
+
+static inline void led_strip_set(led_strip_t *strip, size_t index, uint32_t color) {
+    if (index < strip->count) fb_set(&strip->fb, index, color);
+}
+
+static inline void led_strip_fill(led_strip_t *strip, uint32_t color) {
+    fb_fill(&strip->fb, color);
+}
+
+// Encodes the changes and sends the frame. Returns the number of ioctls, or -1.
+int led_strip_show(led_strip_t *strip);
+
+// All black, sent right away.
+int led_strip_clear(led_strip_t *strip);
+
+#endif
@@ -0,0 +1,68 @@
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <lgpio.h>
+#include "panel_hw.h"
+#include "../buttons/gpio_cdev.h"
+#include "../leds/spi_tx.h"
+
+static int open_gpio(panel_hw_t *hw) {
+    char path[32];
+
+    // The chip number changed between kernels: ask by label, fall back to the usual one
+    int chip = gpio_cdev_find_chip(PANEL_GPIO_LABEL);
+    hw->gpio_chip = chip >= 0 ? chip : PANEL_GPIO_CHIP;
+
+    hw->gpio = lgGpiochipOpen(hw->gpio_chip);
+    if (hw->gpio < 0) {
+        fprintf(stderr, "Failed to open GPIO chip %d: %s\n", hw->gpio_chip, lguErrorText(hw->gpio));
+        return -1;
+    }
+    snprintf(path, sizeof(path), "/dev/gpiochip%d", hw->gpio_chip);
+    hw->gpio_fd = open(path, O_RDWR | O_CLOEXEC);
+    if (hw->gpio_fd < 0) {
+        fprintf(stderr, "Failed to open %s: %s\n", path, strerror(errno));
+        lgGpiochipClose(hw->gpio);
+        hw->gpio = -1;
+        return -1;
+    }
+    return 0;
+}
+
+int panel_hw_open(panel_hw_t *hw, int want, uint32_t spi_hz) {
+    int opened = 0;
+    hw->gpio_chip = -1;
+    hw->gpio = hw->gpio_fd = hw->spi_fd = hw->i2c_fd = -1;
+    hw->spi_is_mock = 0;
+
+    if ((want & PANEL_HW_GPIO) && open_gpio(hw) == 0) opened |= PANEL_HW_GPIO;
+
+    if (want & PANEL_HW_SPI_MOCK) {
+        hw->spi_fd = spi_mock_open(1);
+        hw->spi_is_mock = 1;
+        if (hw->spi_fd >= 0) opened |= PANEL_HW_SPI_MOCK;
+    } else if (want & PANEL_HW_SPI) {
+        hw->spi_fd = spi_open(PANEL_SPI_DEVICE, spi_hz); // Prints the reason itself
+        if (hw->spi_fd >= 0) opened |= PANEL_HW_SPI;
+    }
+
+    if (want & PANEL_HW_I2C) {
+        hw->i2c_fd = open(PANEL_I2C_DEVICE, O_RDWR | O_CLOEXEC);
+        if (hw->i2c_fd >= 0) opened |= PANEL_HW_I2C;
+        else fprintf(stderr, "Failed to open I2C bus %s: %s\n", PANEL_I2C_DEVICE, strerror(errno));
+    }
+    return opened;
+}
+
+void panel_hw_close(panel_hw_t *hw) {
+    if (hw->gpio >= 0) lgGpiochipClose(hw->gpio);
+    if (hw->gpio_fd >= 0) close(hw->gpio_fd);
+    if (hw->spi_fd >= 0) {
+        if (hw->spi_is_mock) spi_mock_close(hw->spi_fd);
+        else close(hw->spi_fd);
+    }
+    if (hw->i2c_fd >= 0) close(hw->i2c_fd);
+    hw->gpio = hw->gpio_fd = hw->spi_fd = hw->i2c_fd = -1;
+}
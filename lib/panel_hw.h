@@ -0,0 +1,45 @@
+#ifndef PANEL_HW_H
+#define PANEL_HW_H
+
+#include <stdint.h>
+
+// --- SHARED HARDWARE HANDLES ---
+// The one place that opens the panel's devices. A program calls panel_hw_open() once at
+// startup with the parts it needs and hands the result to led_strip, tone and
+// button_panel. Each handle is opened once and shared, never reopened per module.
+//
+//   gpio     lgpio handle of the header GPIO chip (tone pins, lgpio alerts)
+//   gpio_fd  GPIO v2 chardev of the same chip (edge requests, see buttons/gpio_cdev.h)
+//   spi_fd   spidev for the LED strip (or the mock sink, see leds/spi_tx.h)
+//   i2c_fd   i2c-dev bus of the PCA9555 expanders
+
+// --- CONFIGURATION ---
+#define PANEL_GPIO_LABEL "pinctrl-rp1"  // Header GPIOs on the Pi 5, found by label...
+#define PANEL_GPIO_CHIP  4              // ...or this chip if no chip has that label
+#define PANEL_SPI_DEVICE "/dev/spidev0.0"
+#define PANEL_I2C_DEVICE "/dev/i2c-1"
+
+// What to open
+#define PANEL_HW_GPIO     0x1
+#define PANEL_HW_SPI      0x2
+#define PANEL_HW_SPI_MOCK 0x4   // Mock SPI sink instead of the device (with the wire time)
+#define PANEL_HW_I2C      0x8
+
+typedef struct {
+    int gpio_chip;  // /dev/gpiochipN number
+    int gpio;       // lgpio handle, -1 = not open
+    int gpio_fd;    // chardev fd, -1 = not open
+    int spi_fd;     // -1 = not open
+    int spi_is_mock;
+    int i2c_fd;     // -1 = not open
+} panel_hw_t;
+
+// Opens every part in 'want'. 'spi_hz' is the SPI clock (the encoding profile's spi_hz).
+// Parts that can't be opened are printed and left at -1. Returns the PANEL_HW_* bits
+// that did open, so a program can go on without an optional part.
+int panel_hw_open(panel_hw_t *hw, int want, uint32_t spi_hz);
+
+// Closes whatever is open. Modules using the handles must be closed first.
+void panel_hw_close(panel_hw_t *hw);
+
+#endif
@@ -0,0 +1,47 @@
+#include <stdio.h>
+#include <lgpio.h>
+#include "tone.h"
+
+static const int vol_pins[4] = { TONE_PIN_VOL_0, TONE_PIN_VOL_1, TONE_PIN_VOL_2, TONE_PIN_VOL_3 };
+static const int vol_levels_low[4] = { 0, 0, 0, 0 };
+
+int tone_init(tone_t *tone, int gpio) {
+    tone->gpio = -1;
+    tone->clock_claimed = 0;
+    if (gpio < 0) return -1;
+
+    buzzer_output_init(&tone->out, gpio, TONE_PIN_CLOCK, TONE_PIN_VOL_0, 0xF);
+
+    // Claiming GPIO 18 through lgpio would take it away from the PWM function
+    if (buzzer_output_open_hw_pwm(&tone->out, BUZZER_PWM_CHIP, BUZZER_PWM_CHANNEL) != 0) {
+        int err = lgGpioClaimOutput(gpio, 0, TONE_PIN_CLOCK, 0);
+        if (err < 0) {
+            fprintf(stderr, "Failed to claim buzzer clock GPIO %d: %s\n", TONE_PIN_CLOCK, lguErrorText(err));
+            return -1;
+        }
+        tone->clock_claimed = 1;
+    }
+
+    int err = lgGroupClaimOutput(gpio, 0, 4, vol_pins, vol_levels_low);
+    if (err < 0) {
+        fprintf(stderr, "Failed to claim buzzer volume GPIOs: %s\n", lguErrorText(err));
+        buzzer_output_close(&tone->out);
+        if (tone->clock_claimed) lgGpioFree(gpio, TONE_PIN_CLOCK);
+        return -1;
+    }
+
+    tone->gpio = gpio;
+    tone_set_volume(tone, 0);
+    tone_stop(tone);
+    return 0;
+}
+
+void tone_close(tone_t *tone) {
+    if (tone->gpio < 0) return;
+    tone_stop(tone);
+    tone_set_volume(tone, 0);
+    buzzer_output_close(&tone->out);
+    if (tone->clock_claimed) lgGpioFree(tone->gpio, TONE_PIN_CLOCK);
+    lgGroupFree(tone->gpio, TONE_PIN_VOL_0);
+    tone->gpio = -1;
+}
@@ -0,0 +1,53 @@
+#ifndef TONE_H
+#define TONE_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include "../buzzer/buzzer_output.h"
+
+// --- TONE (7-wire buzzer module) ---
+// Claims the buzzer pins on the shared lgpio handle and drives them through the
+// buzzer_output cache: the clock from RP1 hardware PWM when GPIO 18 is routed to
+// it, lgTxPwm otherwise, and the four volume pins as one lgpio group.
+
+// --- CONFIGURATION ---
+#define TONE_PIN_CLOCK 18   // PWM pin
+#define TONE_PIN_VOL_0 23
+#define TONE_PIN_VOL_1 24
+#define TONE_PIN_VOL_2 25
+#define TONE_PIN_VOL_3 22
+#define TONE_DUTY_PERCENT 50.0
+
+typedef struct {
+    int gpio;               // lgpio handle (from panel_hw_t), -1 = not set up
+    buzzer_output_t out;    // Also what a tone_seq_t is started on
+    int clock_claimed;      // Clock pin claimed through lgpio (lgTxPwm backend)
+} tone_t;
+
+// Claims the pins on 'gpio' (panel_hw_t.gpio) and starts silent at volume 0.
+// Returns 0, or -1 with the reason printed.
+int tone_init(tone_t *tone, int gpio);
+
+// Silences the buzzer and releases the pins. Doesn't close the chip handle.
+void tone_close(tone_t *tone);
+
+// Plays 'frequency_hz' (0 or less = stop). Only touches the hardware on a change.
+static inline int tone_start(tone_t *tone, int frequency_hz) {
+    return buzzer_output_tone(&tone->out, frequency_hz, TONE_DUTY_PERCENT);
+}
+
+static inline int tone_stop(tone_t *tone) {
+    return buzzer_output_tone(&tone->out, 0, 0);
+}
+
+// Volume 0 - BUZZER_MAX_VOLUME (clamped)
+static inline int tone_set_volume(tone_t *tone, int level) {
+    return buzzer_output_level(&tone->out, level);
+}
+
+// Raw volume pin bits: bit n = TONE_PIN_VOL_n
+static inline int tone_set_volume_bits(tone_t *tone, uint64_t bits) {
+    return buzzer_output_volume(&tone->out, bits);
+}
+
+#endif
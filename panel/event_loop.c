@@ -0,0 +1,145 @@
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <sys/timerfd.h>
+#include "event_loop.h"
+
+int event_loop_init(event_loop_t *loop) {
+    memset(loop, 0, sizeof(*loop));
+    loop->epfd = epoll_create1(EPOLL_CLOEXEC);
+    if (loop->epfd < 0) {
+        perror("epoll_create1");
+        return -1;
+    }
+    return 0;
+}
+
+void event_loop_close(event_loop_t *loop) {
+    if (loop->epfd >= 0) close(loop->epfd);
+    loop->epfd = -1;
+}
+
+int event_loop_add_fd(event_loop_t *loop, event_handler_t *h, int fd, uint32_t events,
+                      event_fd_cb cb, void *arg) {
+    h->fd = fd;
+    h->cb = cb;
+    h->arg = arg;
+
+    struct epoll_event ev = { .events = events, .data.ptr = h };
+    if (epoll_ctl(loop->epfd, EPOLL_CTL_ADD, fd, &ev) < 0) {
+        fprintf(stderr, "epoll_ctl(ADD, fd %d): %s\n", fd, strerror(errno));
+        h->fd = -1;
+        return -1;
+    }
+    return 0;
+}
+
+int event_loop_mod_fd(event_loop_t *loop, event_handler_t *h, uint32_t events) {
+    struct epoll_event ev = { .events = events, .data.ptr = h };
+    return epoll_ctl(loop->epfd, EPOLL_CTL_MOD, h->fd, &ev);
+}
+
+void event_loop_del_fd(event_loop_t *loop, event_handler_t *h) {
+    if (h->fd < 0) return;
+    epoll_ctl(loop->epfd, EPOLL_CTL_DEL, h->fd, NULL);
+    // Events for it that are already in the current batch are skipped (see run)
+    h->fd = -1;
+}
+
+int event_loop_run(event_loop_t *loop) {
+    struct epoll_event events[EVENT_LOOP_MAX_EVENTS];
+
+    loop->running = 1;
+    while (loop->running) {
+        // No timeout: timers are fds too, so there is nothing to wake up for
+        int n = epoll_wait(loop->epfd, events, EVENT_LOOP_MAX_EVENTS, -1);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            perror("epoll_wait");
+            return -1;
+        }
+        loop->wakeups++;
+
+        for (int i = 0; i < n && loop->running; i++) {
+            event_handler_t *h = events[i].data.ptr;
+            if (h->fd < 0) continue; // Removed by an earlier callback of this batch
+            loop->dispatched++;
+            h->cb(loop, h->fd, events[i].events, h->arg);
+        }
+    }
+    return 0;
+}
+
+// --- TIMERS ---
+
+// Reads the expiration count, then runs the timer's callback
+static void timer_ready(event_loop_t *loop, int fd, uint32_t events, void *arg) {
+    event_timer_t *t = arg;
+    uint64_t expirations;
+
+    // Non-blocking: a timer stopped or re-armed after it fired has nothing to read
+    if (read(fd, &expirations, sizeof(expirations)) != sizeof(expirations)) return;
+    if (!t->period_ns) t->armed = 0;
+    t->cb(loop, t, expirations, t->arg);
+}
+
+int event_timer_init(event_loop_t *loop, event_timer_t *t, event_timer_cb cb, void *arg) {
+    memset(t, 0, sizeof(*t));
+    t->cb = cb;
+    t->arg = arg;
+
+    int fd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+    if (fd < 0) {
+        perror("timerfd_create");
+        return -1;
+    }
+    if (event_loop_add_fd(loop, &t->h, fd, EPOLLIN, timer_ready, t) < 0) {
+        close(fd);
+        return -1;
+    }
+    return 0;
+}
+
+void event_timer_close(event_loop_t *loop, event_timer_t *t) {
+    int fd = t->h.fd;
+    if (fd < 0) return;
+    event_loop_del_fd(loop, &t->h);
+    close(fd);
+}
+
+static inline struct timespec ns_to_timespec(uint64_t ns) {
+    struct timespec ts = { (time_t)(ns / 1000000000ULL), (long)(ns % 1000000000ULL) };
+    return ts;
+}
+
+int event_timer_start(event_timer_t *t, uint64_t delay_ns, uint64_t period_ns) {
+    struct itimerspec its;
+
+    // An all-zero it_value would disarm the timer instead of firing now
+    its.it_value = ns_to_timespec(delay_ns ? delay_ns : 1);
+    its.it_interval = ns_to_timespec(period_ns);
+    t->period_ns = period_ns;
+    t->armed = 1;
+    return timerfd_settime(t->h.fd, 0, &its, NULL);
+}
+
+int event_timer_start_at(event_timer_t *t, uint64_t deadline_ns) {
+    if (deadline_ns == UINT64_MAX) return event_timer_stop(t);
+
+    struct itimerspec its;
+    its.it_value = ns_to_timespec(deadline_ns ? deadline_ns : 1);
+    its.it_interval = ns_to_timespec(0);
+    t->period_ns = 0;
+    t->armed = 1;
+    // TFD_TIMER_ABSTIME with a time in the past expires immediately
+    return timerfd_settime(t->h.fd, TFD_TIMER_ABSTIME, &its, NULL);
+}
+
+int event_timer_stop(event_timer_t *t) {
+    struct itimerspec its;
+    memset(&its, 0, sizeof(its));
+    t->armed = 0;
+    t->period_ns = 0;
+    return timerfd_settime(t->h.fd, 0, &its, NULL);
+}
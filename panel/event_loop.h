@@ -0,0 +1,102 @@
+#ifndef EVENT_LOOP_H
+#define EVENT_LOOP_H
+
+#include <stdint.h>
+#include <sys/epoll.h>
+
+// --- EVENT LOOP ---
+// One thread, one epoll: every input (GPIO edge fd, stdin, sockets) and every
+// timer (timerfd: LED frames, tone steps, debounce deadlines) is a file descriptor
+// in the same epoll set. The loop sleeps in epoll_wait() until one of them is ready
+// and runs its callback, so a button press can update the LEDs and start a tone in
+// the same wakeup, and an idle panel costs no CPU at all.
+//
+// Handlers and timers are owned by the caller (usually static or inside an app
+// struct) and must stay valid while registered. Callbacks run on the loop thread
+// and must not block: anything slow belongs in its own fd or timer.
+
+#define EVENT_LOOP_MAX_EVENTS 16    // Ready fds handled per epoll_wait()
+
+struct event_loop;
+struct event_handler;
+
+// 'events' is the EPOLLIN / EPOLLOUT / EPOLLERR / EPOLLHUP mask epoll reported
+typedef void (*event_fd_cb)(struct event_loop *loop, int fd, uint32_t events, void *arg);
+
+typedef struct event_handler {
+    int fd;
+    event_fd_cb cb;
+    void *arg;
+} event_handler_t;
+
+typedef struct event_loop {
+    int epfd;
+    int running;
+
+    // Stats
+    uint64_t wakeups;       // epoll_wait() returns with at least one fd ready
+    uint64_t dispatched;    // Callbacks run
+} event_loop_t;
+
+// Creates the epoll instance. Returns 0, or -1 with the reason printed.
+int event_loop_init(event_loop_t *loop);
+
+// Closes the epoll fd. Registered fds are left open (they belong to the caller).
+void event_loop_close(event_loop_t *loop);
+
+// Watches 'fd' for 'events' (EPOLLIN, ...) and calls 'cb' when it's ready.
+// 'h' holds the registration and must outlive it. Returns 0 or -1.
+int event_loop_add_fd(event_loop_t *loop, event_handler_t *h, int fd, uint32_t events,
+                      event_fd_cb cb, void *arg);
+
+// Changes the events watched for an fd registered with 'h'.
+int event_loop_mod_fd(event_loop_t *loop, event_handler_t *h, uint32_t events);
+
+// Stops watching the fd (does not close it).
+void event_loop_del_fd(event_loop_t *loop, event_handler_t *h);
+
+// Runs until event_loop_stop() is called from a callback. Returns 0, or -1 if
+// epoll_wait() failed (EINTR is retried).
+int event_loop_run(event_loop_t *loop);
+
+// Makes event_loop_run() return after the current batch of callbacks.
+static inline void event_loop_stop(event_loop_t *loop) {
+    loop->running = 0;
+}
+
+// --- TIMERS ---
+// A timerfd on CLOCK_MONOTONIC (the same clock as the GPIO event timestamps), read
+// by the loop before the callback. 'expirations' is how many periods elapsed since
+// the last callback: more than 1 means the loop was late, e.g. frames to drop.
+
+struct event_timer;
+
+typedef void (*event_timer_cb)(struct event_loop *loop, struct event_timer *t,
+                               uint64_t expirations, void *arg);
+
+typedef struct event_timer {
+    event_handler_t h;
+    event_timer_cb cb;
+    void *arg;
+    uint64_t period_ns;     // 0 = one shot
+    int armed;
+} event_timer_t;
+
+// Creates the timerfd (disarmed) and adds it to the loop. Returns 0 or -1.
+int event_timer_init(event_loop_t *loop, event_timer_t *t, event_timer_cb cb, void *arg);
+
+// Closes the timerfd and removes it from the loop.
+void event_timer_close(event_loop_t *loop, event_timer_t *t);
+
+// Fires in 'delay_ns' (at least 1 ns), then every 'period_ns' (0 = once).
+int event_timer_start(event_timer_t *t, uint64_t delay_ns, uint64_t period_ns);
+
+// Fires once at absolute CLOCK_MONOTONIC time 'deadline_ns'. A deadline already
+// in the past fires on the next loop iteration. UINT64_MAX disarms the timer
+// (so debounce_next_deadline() can be passed straight in).
+int event_timer_start_at(event_timer_t *t, uint64_t deadline_ns);
+
+// Disarms the timer. An expiration already queued is discarded.
+int event_timer_stop(event_timer_t *t);
+
+#endif
@@ -0,0 +1,132 @@
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include "latency_trace.h"
+
+static const char *stage_names[TRACE_NUM_STAGES] = {
+    "callback", "i2c_read", "dispatch", "led_show", "tone"
+};
+
+// Prometheus bucket bounds in ns. Each log-linear bucket is counted under the first
+// bound at or above its upper edge, so a count can lag by one bucket (~6%).
+static const uint64_t prom_bounds_ns[] = {
+    50000, 100000, 250000, 500000, 1000000, 2500000, 5000000, 10000000,
+    25000000, 50000000, 100000000, 1000000000
+};
+#define NUM_PROM_BOUNDS (int)(sizeof(prom_bounds_ns) / sizeof(prom_bounds_ns[0]))
+
+uint64_t latency_bucket_lower(int index) {
+    if (index < LATENCY_SUB_BUCKETS) return (uint64_t)index;
+    int shift = index / LATENCY_SUB_BUCKETS - 1;
+    return (uint64_t)(LATENCY_SUB_BUCKETS + index % LATENCY_SUB_BUCKETS) << shift;
+}
+
+// Largest value that maps to bucket 'index'
+static uint64_t bucket_upper(int index) {
+    return latency_bucket_lower(index + 1) - 1;
+}
+
+uint64_t latency_hist_quantile(const latency_hist_t *h, double q) {
+    uint64_t total = atomic_load_explicit(&h->total, memory_order_relaxed);
+    if (total == 0) return 0;
+
+    uint64_t rank = (uint64_t)(q * total + 0.5);
+    if (rank < 1) rank = 1;
+    uint64_t seen = 0;
+    for (int i = 0; i < LATENCY_BUCKETS; i++) {
+        seen += atomic_load_explicit(&h->counts[i], memory_order_relaxed);
+        if (seen >= rank) {
+            // Never report more than the largest value actually seen
+            uint64_t max = atomic_load_explicit(&h->max_ns, memory_order_relaxed);
+            uint64_t upper = bucket_upper(i);
+            return upper < max ? upper : max;
+        }
+    }
+    return atomic_load_explicit(&h->max_ns, memory_order_relaxed);
+}
+
+void latency_trace_init(latency_trace_t *tr, uint64_t budget_ns) {
+    memset(tr, 0, sizeof(*tr));
+    tr->budget_ns = budget_ns ? budget_ns : TRACE_DEFAULT_BUDGET_NS;
+}
+
+void latency_trace_mark(latency_trace_t *tr, trace_stage_t stage, uint64_t edge_ns) {
+    if (!edge_ns) return;
+
+    struct timespec te;
+    clock_gettime(CLOCK_MONOTONIC, &te);
+    uint64_t now = (uint64_t)te.tv_sec * 1000000000ULL + (uint64_t)te.tv_nsec;
+    latency_trace_add(tr, stage, now > edge_ns ? now - edge_ns : 0);
+}
+
+const char *latency_trace_stage_name(trace_stage_t stage) {
+    return stage < TRACE_NUM_STAGES ? stage_names[stage] : "?";
+}
+
+void latency_trace_dump(const latency_trace_t *tr, FILE *out) {
+    fprintf(out, "%-10s %8s %9s %9s %9s %9s %9s %8s\n",
+            "stage", "count", "p50 us", "p90 us", "p99 us", "p99.9 us", "max us", "> budget");
+    for (int s = 0; s < TRACE_NUM_STAGES; s++) {
+        const latency_hist_t *h = &tr->stages[s];
+        uint64_t total = atomic_load_explicit(&h->total, memory_order_relaxed);
+        if (total == 0) continue;
+        fprintf(out, "%-10s %8llu %9.1f %9.1f %9.1f %9.1f %9.1f %8llu\n",
+                stage_names[s], (unsigned long long)total,
+                latency_hist_quantile(h, 0.50) / 1000.0, latency_hist_quantile(h, 0.90) / 1000.0,
+                latency_hist_quantile(h, 0.99) / 1000.0, latency_hist_quantile(h, 0.999) / 1000.0,
+                atomic_load_explicit(&h->max_ns, memory_order_relaxed) / 1000.0,
+                (unsigned long long)atomic_load_explicit(&h->over_budget, memory_order_relaxed));
+    }
+    fprintf(out, "(budget %.1f ms from the GPIO edge)\n", tr->budget_ns / 1e6);
+}
+
+int latency_trace_write_prometheus(const latency_trace_t *tr, const char *path) {
+    char tmp[512];
+    snprintf(tmp, sizeof(tmp), "%s.tmp", path);
+    FILE *f = fopen(tmp, "w");
+    if (!f) {
+        perror("Failed to write metrics");
+        return -1;
+    }
+
+    fprintf(f, "# HELP panel_latency_seconds Time from the GPIO edge to the end of each stage.\n");
+    fprintf(f, "# TYPE panel_latency_seconds histogram\n");
+    for (int s = 0; s < TRACE_NUM_STAGES; s++) {
+        const latency_hist_t *h = &tr->stages[s];
+        uint64_t cumulative = 0;
+        int i = 0;
+
+        for (int b = 0; b < NUM_PROM_BOUNDS; b++) {
+            while (i < LATENCY_BUCKETS && bucket_upper(i) <= prom_bounds_ns[b]) {
+                cumulative += atomic_load_explicit(&h->counts[i], memory_order_relaxed);
+                i++;
+            }
+            fprintf(f, "panel_latency_seconds_bucket{stage=\"%s\",le=\"%g\"} %llu\n",
+                    stage_names[s], prom_bounds_ns[b] / 1e9, (unsigned long long)cumulative);
+        }
+        // Counters are read one by one: use the bucket sum as the count so +Inf stays consistent
+        while (i < LATENCY_BUCKETS) cumulative += atomic_load_explicit(&h->counts[i++], memory_order_relaxed);
+        fprintf(f, "panel_latency_seconds_bucket{stage=\"%s\",le=\"+Inf\"} %llu\n",
+                stage_names[s], (unsigned long long)cumulative);
+        fprintf(f, "panel_latency_seconds_sum{stage=\"%s\"} %.9f\n", stage_names[s],
+                atomic_load_explicit(&h->sum_ns, memory_order_relaxed) / 1e9);
+        fprintf(f, "panel_latency_seconds_count{stage=\"%s\"} %llu\n",
+                stage_names[s], (unsigned long long)cumulative);
+    }
+
+    fprintf(f, "# HELP panel_latency_over_budget_total Events slower than the response budget.\n");
+    fprintf(f, "# TYPE panel_latency_over_budget_total counter\n");
+    for (int s = 0; s < TRACE_NUM_STAGES; s++) {
+        fprintf(f, "panel_latency_over_budget_total{stage=\"%s\"} %llu\n", stage_names[s],
+                (unsigned long long)atomic_load_explicit(&tr->stages[s].over_budget, memory_order_relaxed));
+    }
+    fprintf(f, "# HELP panel_latency_budget_seconds Response budget.\n");
+    fprintf(f, "# TYPE panel_latency_budget_seconds gauge\n");
+    fprintf(f, "panel_latency_budget_seconds %g\n", tr->budget_ns / 1e9);
+
+    if (fclose(f) != 0 || rename(tmp, path) != 0) {
+        perror("Failed to write metrics");
+        return -1;
+    }
+    return 0;
+}
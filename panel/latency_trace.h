@@ -0,0 +1,91 @@
+#ifndef LATENCY_TRACE_H
+#define LATENCY_TRACE_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdatomic.h>
+
+// --- LATENCY HISTOGRAMS ---
+// HDR-style log-linear histogram: every power of two is split into 16 equal buckets,
+// so any recorded value lands in a bucket at most 1/16 (~6%) wider than itself, from
+// 1 ns up to ~68 s, in 528 counters. Recording is one relaxed atomic add per counter
+// (no locks, no allocation), so it is safe from any thread, including the GPIO alert
+// thread, and cheap enough to leave on in production.
+
+#define LATENCY_SUB_BUCKETS 16
+#define LATENCY_MAX_SHIFT   31      // Values are clamped to 2^36 ns (~68 s)
+#define LATENCY_BUCKETS     ((LATENCY_MAX_SHIFT + 2) * LATENCY_SUB_BUCKETS)
+
+typedef struct {
+    _Atomic uint64_t counts[LATENCY_BUCKETS];
+    _Atomic uint64_t total;
+    _Atomic uint64_t sum_ns;
+    _Atomic uint64_t max_ns;
+    _Atomic uint64_t over_budget;   // Values above the trace's budget
+} latency_hist_t;
+
+// Bucket index of a value in ns
+static inline int latency_bucket(uint64_t ns) {
+    if (ns < LATENCY_SUB_BUCKETS) return (int)ns;
+    if (ns >> (LATENCY_MAX_SHIFT + 5)) ns = (1ULL << (LATENCY_MAX_SHIFT + 5)) - 1;
+    int shift = 63 - __builtin_clzll(ns) - 4;
+    return (shift + 1) * LATENCY_SUB_BUCKETS + (int)((ns >> shift) - LATENCY_SUB_BUCKETS);
+}
+
+// Smallest value that maps to bucket 'index'
+uint64_t latency_bucket_lower(int index);
+
+// Value at quantile 'q' (0..1), as the upper edge of its bucket. 0 if empty.
+uint64_t latency_hist_quantile(const latency_hist_t *h, double q);
+
+// --- PIPELINE TRACE ---
+// One histogram per stage of the button -> feedback path, each measured from the
+// kernel timestamp of the GPIO edge (CLOCK_MONOTONIC) to the moment the stage is done.
+typedef enum {
+    TRACE_CALLBACK,     // Edge callback entered (wakeup latency)
+    TRACE_I2C_READ,     // Expander inputs in hand
+    TRACE_DISPATCH,     // Debounced event handed to the application
+    TRACE_LED_SHOW,     // LED frame sent (show() returned)
+    TRACE_TONE,         // Tone started (lgTxPwm() returned)
+    TRACE_NUM_STAGES
+} trace_stage_t;
+
+typedef struct {
+    uint64_t budget_ns;     // Response budget, counted per stage in over_budget
+    latency_hist_t stages[TRACE_NUM_STAGES];
+} latency_trace_t;
+
+#define TRACE_DEFAULT_BUDGET_NS 10000000ULL // 10 ms from the edge to the feedback
+
+// Clears all stages. 'budget_ns' 0 = TRACE_DEFAULT_BUDGET_NS.
+void latency_trace_init(latency_trace_t *tr, uint64_t budget_ns);
+
+// Records 'ns' for a stage.
+static inline void latency_trace_add(latency_trace_t *tr, trace_stage_t stage, uint64_t ns) {
+    latency_hist_t *h = &tr->stages[stage];
+
+    atomic_fetch_add_explicit(&h->counts[latency_bucket(ns)], 1, memory_order_relaxed);
+    atomic_fetch_add_explicit(&h->total, 1, memory_order_relaxed);
+    atomic_fetch_add_explicit(&h->sum_ns, ns, memory_order_relaxed);
+    if (ns > tr->budget_ns) atomic_fetch_add_explicit(&h->over_budget, 1, memory_order_relaxed);
+
+    uint64_t max = atomic_load_explicit(&h->max_ns, memory_order_relaxed);
+    while (ns > max && !atomic_compare_exchange_weak_explicit(&h->max_ns, &max, ns,
+                                                              memory_order_relaxed, memory_order_relaxed));
+}
+
+// Records "now - edge_ns" for a stage (CLOCK_MONOTONIC). Ignored if edge_ns is 0.
+void latency_trace_mark(latency_trace_t *tr, trace_stage_t stage, uint64_t edge_ns);
+
+// "callback", "i2c_read", "dispatch", "led_show", "tone"
+const char *latency_trace_stage_name(trace_stage_t stage);
+
+// Human-readable table: count, p50/p90/p99/p99.9, max, over budget, per stage.
+void latency_trace_dump(const latency_trace_t *tr, FILE *out);
+
+// Prometheus text exposition format (histogram 'panel_latency_seconds' with a
+// 'stage' label), e.g. for node_exporter's textfile collector. Written to
+// 'path'.tmp and renamed, so a scrape never sees half a file. Returns 0 or -1.
+int latency_trace_write_prometheus(const latency_trace_t *tr, const char *path);
+
+#endif
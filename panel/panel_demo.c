@@ -0,0 +1,410 @@
+#include <stdint.h>
+#include <unistd.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <signal.h>
+#include <termios.h>
+#include <time.h>
+#include <sys/signalfd.h>
+#include "event_loop.h"
+#include "latency_trace.h"
+#include "../common/rt_sched.h"
+#include "../common/arena.h"
+#include "../buttons/gpio_cdev.h"
+#include "../buttons/debounce.h"
+#include "../lib/panel_hw.h"
+#include "../lib/led_strip.h"
+#include "../lib/tone.h"
+#include "../lib/button_panel.h"
+
+// --- CONFIGURATION ---
+// Devices and pins: lib/panel_hw.h, lib/button_panel.h, lib/tone.h
+// Buttons
+static const uint8_t EXPANDERS[] = { 0x27 };
+#define NUM_EXPANDERS (int)(sizeof(EXPANDERS) / sizeof(EXPANDERS[0]))
+#define GPIO_INT_PIN BUTTON_PANEL_INT_PIN
+
+// LEDs
+#define LED_COUNT 186
+#define FRAME_MS 20             // 50 fps while something is fading, no frames when dark
+#define FADE_SHIFT 3            // Each frame keeps 7/8 of the brightness
+
+// Buzzer
+#define BEEP_MS     80
+#define LONG_BEEP_MS 250
+
+// Latency trace (see latency_trace.h): dumped with 't', SIGUSR1 and on exit
+#define RESPONSE_BUDGET_MS 10
+#define METRICS_PERIOD_S   10   // --metrics FILE: Prometheus text rewritten this often
+#define ARENA_SIZE (64 * 1024)  // LED buffers (PANEL_ARENA overrides)
+
+// Everything runs on the one event loop thread: no locks anywhere below.
+//   GPIO 17 edge fd -> read expanders -> debounce -> LEDs + tone, in the same callback
+//   debounce timer  -> releases, long presses, repeats
+//   frame timer     -> fade animation, only armed while an LED is lit
+//   tone timer      -> ends the beep
+//   stdin           -> keys (1-9, 0 simulate buttons 0-9 without the panel)
+//   signalfd        -> Ctrl+C / SIGTERM, handled like any other event; SIGUSR1 dumps the trace
+//   metrics timer   -> Prometheus text file (only with --metrics)
+
+event_loop_t loop;
+panel_hw_t hw;  // GPIO chip, SPI and I2C, each opened once
+
+// Buttons (skipped if the GPIO/I2C isn't there)
+int gpio_fd = -1;   // Edge request on GPIO_INT_PIN
+button_panel_t panel;
+debouncer_t debouncer;
+event_handler_t gpio_handler;
+event_timer_t debounce_timer;
+uint32_t last_seqno = 0;
+
+// LEDs (skipped if the SPI device isn't there, unless --mock)
+int leds_on = 0;
+led_strip_t strip;
+uint8_t zone_level[DEBOUNCE_MAX_PINS];  // Brightness of each button's LED zone, fades to 0
+int num_zones = 16;
+event_timer_t frame_timer;
+
+// Buzzer (skipped if lgpio can't open the chip)
+tone_t tone = { .gpio = -1 };
+int volume = 2;
+event_timer_t tone_timer;
+
+// Latency, from the GPIO edge that woke us (0 while not handling an edge)
+latency_trace_t trace;
+uint64_t trace_edge_ns = 0;
+const char *metrics_path = NULL;
+event_timer_t metrics_timer;
+
+// Keyboard + shutdown
+struct termios saved_terminal_settings;
+int terminal_raw = 0;
+event_handler_t stdin_handler;
+event_handler_t signal_handler;
+
+// Helper: Current time in ns (same clock as the GPIO event timestamps and the timers)
+uint64_t current_timestamp_ns() {
+    struct timespec te;
+    clock_gettime(CLOCK_MONOTONIC, &te);
+    return (uint64_t)te.tv_sec * 1000000000ULL + (uint64_t)te.tv_nsec;
+}
+
+// --- TERMINAL ---
+
+void restore_terminal_settings() {
+    if (terminal_raw) tcsetattr(STDIN_FILENO, TCSANOW, &saved_terminal_settings);
+    terminal_raw = 0;
+}
+
+void set_terminal_raw_mode() {
+    if (tcgetattr(STDIN_FILENO, &saved_terminal_settings) < 0) return;
+    struct termios tattr = saved_terminal_settings;
+    tattr.c_lflag &= ~(ICANON | ECHO);
+    tattr.c_cc[VMIN] = 1;
+    tattr.c_cc[VTIME] = 0;
+    tcsetattr(STDIN_FILENO, TCSAFLUSH, &tattr);
+    terminal_raw = 1;
+}
+
+// --- BUZZER ---
+
+// Starts a tone and arms the tone timer to end it; a new beep replaces the old one
+void beep(int frequency_hz, int ms) {
+    if (tone.gpio < 0) return;
+    tone_start(&tone, frequency_hz);
+    event_timer_start(&tone_timer, (uint64_t)ms * 1000000ULL, 0);
+}
+
+void on_tone_timer(event_loop_t *l, event_timer_t *t, uint64_t expirations, void *arg) {
+    tone_stop(&tone);
+}
+
+int buzzer_init() {
+    if (tone_init(&tone, hw.gpio) < 0) return -1;
+    tone_set_volume(&tone, volume);
+    return 0;
+}
+
+// --- LEDS ---
+
+// One color per zone, cycling through the hues
+uint32_t zone_color(int zone, uint8_t level) {
+    static const uint32_t palette[6] = { 0xFF0000, 0xFF8000, 0xFFFF00, 0x00FF00, 0x0080FF, 0x8000FF };
+    uint32_t c = palette[zone % 6];
+    uint32_t r = ((c >> 16) & 0xFF) * level / 255;
+    uint32_t g = ((c >> 8) & 0xFF) * level / 255;
+    uint32_t b = (c & 0xFF) * level / 255;
+    return (r << 16) | (g << 8) | b;
+}
+
+// Draws the zones, sends the frame and fades them. Returns 1 while anything is still lit.
+int render_frame() {
+    int lit = 0;
+    size_t per_zone = LED_COUNT / num_zones;
+
+    for (int z = 0; z < num_zones; z++) {
+        uint32_t color = zone_color(z, zone_level[z]);
+        for (size_t i = 0; i < per_zone; i++) led_strip_set(&strip, z * per_zone + i, color);
+        zone_level[z] -= zone_level[z] >> FADE_SHIFT;
+        if (zone_level[z] < 8) zone_level[z] = 0;
+        lit |= zone_level[z] != 0;
+    }
+
+    // Only the fading pixels are re-encoded. The ioctl blocks for the wire time
+    // (~5.6 ms for 186 LEDs), which is why FRAME_MS leaves room for input in between.
+    led_strip_show(&strip);
+    return lit;
+}
+
+void on_frame_timer(event_loop_t *l, event_timer_t *t, uint64_t expirations, void *arg) {
+    // Late frames are simply skipped: the fade continues from where it is
+    if (!render_frame()) {
+        render_frame(); // Last frame: everything black
+        event_timer_stop(&frame_timer);
+    }
+}
+
+void light_zone(int zone) {
+    if (!leds_on || zone >= num_zones) return;
+    zone_level[zone] = 255;
+    // Draw right away, in the same wakeup as the press; the timer only does the fade
+    render_frame();
+    if (!frame_timer.armed) {
+        event_timer_start(&frame_timer, FRAME_MS * 1000000ULL, FRAME_MS * 1000000ULL);
+    }
+}
+
+int leds_init() {
+    if (hw.spi_fd < 0) return -1;
+    // All black, whole buffer encoded once
+    if (led_strip_init(&strip, hw.spi_fd, LED_COUNT, NULL) < 0 || led_strip_show(&strip) < 0) return -1;
+    leds_on = 1;
+    return 0;
+}
+
+// --- BUTTONS ---
+
+void handle_button(const button_event_t *ev) {
+    switch (ev->type) {
+        case BUTTON_PRESS:
+            latency_trace_mark(&trace, TRACE_DISPATCH, trace_edge_ns);
+            light_zone(ev->pin);
+            if (leds_on) latency_trace_mark(&trace, TRACE_LED_SHOW, trace_edge_ns);
+            beep(440 + 55 * (ev->pin % 16), BEEP_MS);
+            if (tone.gpio >= 0) latency_trace_mark(&trace, TRACE_TONE, trace_edge_ns);
+            printf("Button %d: press (%llu us after the edge)\n", ev->pin,
+                   (unsigned long long)((current_timestamp_ns() - ev->timestamp_ns) / 1000));
+            break;
+        case BUTTON_LONG_PRESS:
+            beep(220, LONG_BEEP_MS);
+            printf("Button %d: long press\n", ev->pin);
+            break;
+        case BUTTON_REPEAT:
+            light_zone(ev->pin);
+            break;
+        case BUTTON_RELEASE:
+            printf("Button %d: release\n", ev->pin);
+            break;
+    }
+}
+
+void run_debouncer(const uint64_t *pressed, uint64_t ts_ns) {
+    button_event_t events[2 * DEBOUNCE_MAX_PINS];
+    int n = pressed ? debounce_update(&debouncer, pressed, ts_ns, events, 2 * DEBOUNCE_MAX_PINS)
+                    : debounce_tick(&debouncer, ts_ns, events, 2 * DEBOUNCE_MAX_PINS);
+    for (int i = 0; i < n; i++) handle_button(&events[i]);
+
+    // Wake up again only when the debouncer has something due
+    event_timer_start_at(&debounce_timer, debounce_next_deadline(&debouncer));
+}
+
+void on_gpio_edge(event_loop_t *l, int fd, uint32_t events, void *arg) {
+    gpio_cdev_event_t ev[GPIO_CDEV_MAX_READ];
+
+    int n = gpio_cdev_read_events(fd, ev, GPIO_CDEV_MAX_READ);
+    if (n <= 0) return;
+    if (last_seqno && ev[0].seqno != last_seqno + 1) {
+        printf("(%u edges lost)\n", ev[0].seqno - last_seqno - 1);
+    }
+    last_seqno = ev[n - 1].seqno;
+
+    // Latency is counted from the oldest edge of the batch
+    trace_edge_ns = ev[0].timestamp_ns;
+    latency_trace_mark(&trace, TRACE_CALLBACK, trace_edge_ns);
+
+    // One read of every expander covers all queued edges
+    uint64_t pressed[BUTTON_MATRIX_WORDS];
+    if (button_panel_read(&panel, pressed) < 0) {
+        perror("Failed to read I2C");
+        trace_edge_ns = 0;
+        return;
+    }
+    latency_trace_mark(&trace, TRACE_I2C_READ, trace_edge_ns);
+    run_debouncer(pressed, ev[n - 1].timestamp_ns);
+    trace_edge_ns = 0;
+}
+
+void on_debounce_timer(event_loop_t *l, event_timer_t *t, uint64_t expirations, void *arg) {
+    run_debouncer(NULL, current_timestamp_ns());
+}
+
+int buttons_init() {
+    if (hw.i2c_fd < 0 || hw.gpio_fd < 0) return -1;
+    if (button_panel_open(&panel, hw.i2c_fd, EXPANDERS, NUM_EXPANDERS) < 0) return -1;
+
+    unsigned int pin = GPIO_INT_PIN;
+    gpio_fd = gpio_cdev_request_edges(hw.gpio_fd, &pin, 1,
+                                      GPIO_V2_LINE_FLAG_EDGE_FALLING | GPIO_V2_LINE_FLAG_BIAS_PULL_UP,
+                                      "panel_demo");
+    if (gpio_fd < 0) return -1;
+
+    // Initial read clears any pending interrupt and seeds the debouncer
+    uint64_t pressed[BUTTON_MATRIX_WORDS] = {0};
+    debounce_cfg_t cfg = DEBOUNCE_DEFAULT_CFG;
+    button_panel_read(&panel, pressed);
+    debounce_init(&debouncer, &cfg, button_panel_inputs(&panel), pressed, current_timestamp_ns());
+    num_zones = button_panel_inputs(&panel);
+    return 0;
+}
+
+// --- KEYBOARD / SIGNALS ---
+
+void on_stdin(event_loop_t *l, int fd, uint32_t events, void *arg) {
+    char buf[16];
+    ssize_t n = read(fd, buf, sizeof(buf));
+    if (n <= 0) {
+        // EOF (stdin closed or redirected from a file): stop watching it
+        event_loop_del_fd(l, &stdin_handler);
+        return;
+    }
+
+    for (ssize_t i = 0; i < n; i++) {
+        char c = buf[i];
+        if (c == 'q') {
+            event_loop_stop(l);
+        } else if (c == 't') {
+            latency_trace_dump(&trace, stdout);
+        } else if (c >= '0' && c <= '9') {
+            // Same path as a real press, minus the debouncer
+            button_event_t ev = { c == '0' ? 9 : c - '1', BUTTON_PRESS, current_timestamp_ns() };
+            handle_button(&ev);
+        } else if (c == '+' || c == '-') {
+            volume += (c == '+') ? 1 : -1;
+            if (volume > BUZZER_MAX_VOLUME) volume = BUZZER_MAX_VOLUME;
+            if (volume < 0) volume = 0;
+            if (tone.gpio >= 0) tone_set_volume(&tone, volume);
+            printf("Volume: %d\n", volume);
+        }
+    }
+}
+
+void write_metrics() {
+    if (metrics_path) latency_trace_write_prometheus(&trace, metrics_path);
+}
+
+void on_metrics_timer(event_loop_t *l, event_timer_t *t, uint64_t expirations, void *arg) {
+    write_metrics();
+}
+
+void on_signal(event_loop_t *l, int fd, uint32_t events, void *arg) {
+    struct signalfd_siginfo si;
+    if (read(fd, &si, sizeof(si)) != sizeof(si)) return;
+
+    if (si.ssi_signo == SIGUSR1) {
+        latency_trace_dump(&trace, stdout);
+        write_metrics();
+    } else {
+        event_loop_stop(l);
+    }
+}
+
+int main(int argc, char **argv) {
+    int mock = 0;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--mock") == 0) {
+            mock = 1;
+        } else if (strcmp(argv[i], "--metrics") == 0 && i + 1 < argc) {
+            metrics_path = argv[++i];
+        } else {
+            fprintf(stderr, "Usage: %s [--mock] [--metrics FILE]\n", argv[0]);
+            return 1;
+        }
+    }
+    latency_trace_init(&trace, RESPONSE_BUDGET_MS * 1000000ULL);
+
+    // One thread does input, LEDs and tones: it takes the "input" role from PANEL_RT
+    rt_cfg_t rt;
+    if (rt_config_load(&rt) < 0) return 1;
+    rt_apply_self(&rt, RT_ROLE_INPUT, "event loop");
+
+    // Ctrl+C arrives as an fd event instead of interrupting whatever is running
+    sigset_t mask;
+    sigemptyset(&mask);
+    sigaddset(&mask, SIGINT);
+    sigaddset(&mask, SIGTERM);
+    sigaddset(&mask, SIGUSR1);
+    sigprocmask(SIG_BLOCK, &mask, NULL);
+    int sig_fd = signalfd(-1, &mask, SFD_CLOEXEC);
+
+    // The LED buffers come from one locked block: nothing is allocated once running
+    if (arena_setup(ARENA_SIZE) < 0 || event_loop_init(&loop) < 0) return 1;
+    event_loop_add_fd(&loop, &signal_handler, sig_fd, EPOLLIN, on_signal, NULL);
+
+    // Each subsystem is optional, so the demo runs with whatever is connected
+    const ws2812_profile_t *profile = ws2812_profile_find(NULL);
+    panel_hw_open(&hw, PANEL_HW_GPIO | PANEL_HW_I2C | (mock ? PANEL_HW_SPI_MOCK : PANEL_HW_SPI),
+                  profile->spi_hz);
+    if (buttons_init() == 0) {
+        event_loop_add_fd(&loop, &gpio_handler, gpio_fd, EPOLLIN, on_gpio_edge, NULL);
+        event_timer_init(&loop, &debounce_timer, on_debounce_timer, NULL);
+        printf("Buttons: %d PCA9555 on GPIO %d\n", NUM_EXPANDERS, GPIO_INT_PIN);
+    } else {
+        printf("Buttons: not available (keys 1-9, 0 still work)\n");
+    }
+    if (leds_init() == 0) {
+        event_timer_init(&loop, &frame_timer, on_frame_timer, NULL);
+        printf("LEDs: %d on %s\n", LED_COUNT, hw.spi_is_mock ? "mock sink" : PANEL_SPI_DEVICE);
+    } else {
+        printf("LEDs: not available\n");
+    }
+    if (buzzer_init() == 0) {
+        event_timer_init(&loop, &tone_timer, on_tone_timer, NULL);
+        printf("Buzzer: on GPIO %d (%s)\n", TONE_PIN_CLOCK, buzzer_output_backend_name(&tone.out));
+    } else {
+        printf("Buzzer: not available\n");
+    }
+
+    if (metrics_path) {
+        event_timer_init(&loop, &metrics_timer, on_metrics_timer, NULL);
+        event_timer_start(&metrics_timer, METRICS_PERIOD_S * 1000000000ULL, METRICS_PERIOD_S * 1000000000ULL);
+        printf("Metrics: %s every %d s\n", metrics_path, METRICS_PERIOD_S);
+    }
+
+    set_terminal_raw_mode();
+    event_loop_add_fd(&loop, &stdin_handler, STDIN_FILENO, EPOLLIN, on_stdin, NULL);
+    printf("Keys: 1-9, 0 = buttons 0-9, +/- = volume, t = latency, q = quit\n");
+
+    event_loop_run(&loop);
+
+    // --- Cleanup ---
+    restore_terminal_settings();
+    printf("\n%llu wakeups, %llu callbacks, %llu LED frames\n",
+           (unsigned long long)loop.wakeups, (unsigned long long)loop.dispatched,
+           (unsigned long long)strip.frames);
+    arena_print_stats(stdout);
+    if (atomic_load(&trace.stages[TRACE_CALLBACK].total)) latency_trace_dump(&trace, stdout);
+    write_metrics();
+
+    tone_close(&tone);
+    if (leds_on) {
+        // Send "Black" to all LEDs to turn them off physically
+        led_strip_clear(&strip);
+        led_strip_free(&strip);
+    }
+    if (gpio_fd >= 0) close(gpio_fd);
+    panel_hw_close(&hw);
+    event_loop_close(&loop);
+    arena_teardown();
+    return 0;
+}
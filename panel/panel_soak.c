@@ -0,0 +1,543 @@
+#define _GNU_SOURCE // pthread_getcpuclockid
+
+#include <stdint.h>
+#include <unistd.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <time.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <sys/eventfd.h>
+#include <sys/utsname.h>
+#include <lgpio.h>
+#include "latency_trace.h"
+#include "../common/rt_sched.h"
+#include "../common/arena.h"
+#include "../common/shutdown.h"
+#include "../buttons/gpio_cdev.h"
+#include "../buzzer/tone_sequencer.h"
+#include "../leds/strip_manager.h"
+#include "../lib/panel_hw.h"
+#include "../lib/tone.h"
+#include "../lib/button_panel.h"
+
+// --- CONFIGURATION ---
+#define MAX_STRIPS 8
+#define MAX_EXPANDERS 8
+#define DEFAULT_DURATION_S 60
+#define DEFAULT_INTERVAL_S 10
+#define DEFAULT_PRESS_HZ 50         // Injected button edges per second
+#define LOOPBACK_PULSE_US 500       // Low time of a loopback press
+#define FLASH_LEDS 8                // LEDs lit at the start of every strip for a press
+#define RESPONSE_BUDGET_MS 10
+#define ARENA_SLACK (64 * 1024)     // Segment table, alignment
+
+// Scripted stress / soak run of all three subsystems at once, no one at the keyboard:
+//   injector   a press every 1/--press-hz s (with jitter): either a falling edge on
+//              the --loopback GPIO (wire it to GPIO 17, the expanders' INT line) or,
+//              without it, a timestamp through a pipe
+//   input      wakes on the edge, reads the expanders over I2C (if any answer) and
+//              hands the press to the LEDs and the buzzer
+//   leds       renders frames back to back, as fast as the strips take them, and
+//              flashes the start of every strip for a press
+//   tone       the sequencer loops a melody and interrupts it with a beep per press
+// Every press is timed from its edge through each stage (latency_trace.h). One JSON
+// object per --interval and a summary at the end go to stdout or --json FILE
+// (JSON Lines); a progress line goes to stderr.
+//
+// Usage: panel_soak [--duration S] [--interval S] [--json FILE] [--label NAME] [--mock]
+//                   [--strip DEV:COUNT]... [--expander ADDR]... [--press-hz N]
+//                   [--loopback GPIO] [--no-tone] [profile]
+//   --mock              LEDs on a mock sink (--strip mock:COUNT), no I2C / buzzer needed
+//   --duration 0        run until Ctrl+C (multi-hour soaks)
+
+typedef struct {
+    uint64_t led_frames;
+    uint64_t spi_errors;
+    uint64_t injected;
+    uint64_t handled;
+    uint64_t i2c_errors;
+    uint64_t cpu_ns[5];
+    uint64_t t_ns;
+} soak_snapshot_t;
+
+// CPU accounting groups
+enum { CPU_LED, CPU_SPI_TX, CPU_INPUT, CPU_INJECTOR, CPU_TONE };
+static const char *cpu_names[] = { "led_render", "spi_tx", "input", "injector", "tone" };
+
+panel_hw_t hw;
+strip_manager_t sm;
+button_panel_t panel;
+int have_panel = 0;
+tone_t tone = { .gpio = -1 };
+tone_seq_t seq;
+int have_tone = 0;
+int spi_mock = 0;
+latency_trace_t trace;
+FILE *json = NULL;
+
+int loopback_gpio = -1;
+int line_fd = -1;           // Edge request on BUTTON_PANEL_INT_PIN (loopback)
+int inject_pipe[2] = { -1, -1 };
+int stop_fd = -1;           // eventfd: wakes the input thread at the end
+int press_hz = DEFAULT_PRESS_HZ;
+atomic_int running = 1;
+
+pthread_t led_thread, input_thread, injector_thread;
+
+// Counters (written by one thread each, read by main)
+_Atomic uint64_t led_frames, show_errors;
+_Atomic uint64_t injected, inject_overflow, edges_received, edges_lost, handled;
+_Atomic uint64_t i2c_reads, i2c_errors, tone_plays, tone_queue_full;
+_Atomic uint64_t flash_edge_ns;     // Oldest press not drawn yet (0 = none)
+
+// Background melody, looped; every press beeps over it and restarts it
+static const tone_step_t MELODY[] = {
+    { 523, 2, 120 }, { 659, 2, 120 }, { 784, 2, 120 }, { 0, TONE_KEEP_VOLUME, 60 },
+};
+static const tone_step_t BEEP[] = { { 1760, 4, 30 } };
+
+// Helper: Current time in ns (same clock as the GPIO event timestamps)
+uint64_t current_timestamp_ns() {
+    struct timespec te;
+    clock_gettime(CLOCK_MONOTONIC, &te);
+    return (uint64_t)te.tv_sec * 1000000000ULL + (uint64_t)te.tv_nsec;
+}
+
+void sleep_until_ns(uint64_t t) {
+    struct timespec ts = { (time_t)(t / 1000000000ULL), (long)(t % 1000000000ULL) };
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL) == EINTR);
+}
+
+uint64_t thread_cpu_ns(pthread_t thread) {
+    clockid_t id;
+    struct timespec ts;
+    if (pthread_getcpuclockid(thread, &id) != 0 || clock_gettime(id, &ts) != 0) return 0;
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+// --- LEDS ---
+
+// Back to back frames: a dot chasing across all strips, plus a flash per press
+void *led_main(void *arg) {
+    size_t head = 0;
+    while (atomic_load(&running)) {
+        uint64_t edge = atomic_exchange(&flash_edge_ns, 0);
+        strip_set_pixel(&sm, head, 0x000000);
+        head = (head + 1) % sm.total;
+        strip_set_pixel(&sm, head, 0x202020);
+        for (int s = 0; s < sm.num_segments; s++) {
+            for (size_t i = 0; i < FLASH_LEDS && i < sm.segments[s].count; i++) {
+                strip_set_pixel(&sm, sm.segments[s].first + i, edge ? 0x400000 : 0x000000);
+            }
+        }
+
+        // Returns once every strip has taken the frame (waits for the previous one)
+        if (strip_manager_show(&sm) < 0) atomic_fetch_add(&show_errors, 1);
+        atomic_fetch_add(&led_frames, 1);
+        latency_trace_mark(&trace, TRACE_LED_SHOW, edge);
+    }
+    return NULL;
+}
+
+uint64_t spi_write_errors() {
+    uint64_t n = 0;
+    for (int s = 0; s < sm.num_segments; s++) n += sm.segments[s].tx.write_errors;
+    return n;
+}
+
+// --- INPUT ---
+
+void handle_press(uint64_t edge_ns) {
+    latency_trace_mark(&trace, TRACE_CALLBACK, edge_ns);
+
+    if (have_panel) {
+        uint64_t pressed[BUTTON_MATRIX_WORDS];
+        atomic_fetch_add(&i2c_reads, 1);
+        if (button_panel_read(&panel, pressed) < 0 || panel.matrix.failed) atomic_fetch_add(&i2c_errors, 1);
+        latency_trace_mark(&trace, TRACE_I2C_READ, edge_ns);
+    }
+    latency_trace_mark(&trace, TRACE_DISPATCH, edge_ns);
+
+    // The LED thread draws it on its next frame; keep the oldest undrawn press
+    uint64_t none = 0;
+    atomic_compare_exchange_strong(&flash_edge_ns, &none, edge_ns);
+
+    if (have_tone) {
+        if (tone_seq_play(&seq, BEEP, 1, TONE_SEQ_NOW) < 0 ||
+            tone_seq_play(&seq, MELODY, sizeof(MELODY) / sizeof(MELODY[0]), TONE_SEQ_LOOP) < 0) {
+            atomic_fetch_add(&tone_queue_full, 1);
+        }
+        atomic_fetch_add(&tone_plays, 1);
+        latency_trace_mark(&trace, TRACE_TONE, edge_ns);
+    }
+    atomic_fetch_add(&handled, 1);
+}
+
+void *input_main(void *arg) {
+    struct pollfd fds[2] = {
+        { .fd = stop_fd, .events = POLLIN },
+        { .fd = line_fd >= 0 ? line_fd : inject_pipe[0], .events = POLLIN },
+    };
+    uint32_t last_seqno = 0;
+
+    while (1) {
+        if (poll(fds, 2, -1) < 0) {
+            if (errno == EINTR) continue;
+            break;
+        }
+        if (fds[0].revents & POLLIN) break;
+        if (!(fds[1].revents & POLLIN)) continue;
+
+        if (line_fd >= 0) {
+            gpio_cdev_event_t ev[GPIO_CDEV_MAX_READ];
+            int n = gpio_cdev_read_events(line_fd, ev, GPIO_CDEV_MAX_READ);
+            if (n <= 0) continue;
+            if (last_seqno && ev[0].seqno != last_seqno + 1) {
+                atomic_fetch_add(&edges_lost, ev[0].seqno - last_seqno - 1);
+            }
+            last_seqno = ev[n - 1].seqno;
+            atomic_fetch_add(&edges_received, n);
+            for (int i = 0; i < n; i++) handle_press(ev[i].timestamp_ns);
+        } else {
+            uint64_t ts[GPIO_CDEV_MAX_READ];
+            ssize_t len = read(inject_pipe[0], ts, sizeof(ts));
+            if (len <= 0) continue;
+            int n = (int)(len / sizeof(ts[0]));
+            atomic_fetch_add(&edges_received, n);
+            for (int i = 0; i < n; i++) handle_press(ts[i]);
+        }
+    }
+    return NULL;
+}
+
+// --- INJECTOR ---
+
+void *injector_main(void *arg) {
+    uint64_t period = 1000000000ULL / press_hz;
+    uint64_t next = current_timestamp_ns() + period;
+    uint32_t rng = 0x2545F491;
+
+    while (atomic_load(&running)) {
+        // +-25% jitter, so presses don't line up with the LED frames
+        rng = rng * 1664525u + 1013904223u;
+        uint64_t at = next - period / 4 + (uint64_t)(rng >> 8) % (period / 2 + 1);
+        sleep_until_ns(at);
+        next += period;
+        if (!atomic_load(&running)) break;
+
+        if (loopback_gpio >= 0) {
+            lgGpioWrite(hw.gpio, loopback_gpio, 0);
+            atomic_fetch_add(&injected, 1);
+            sleep_until_ns(current_timestamp_ns() + LOOPBACK_PULSE_US * 1000ULL);
+            lgGpioWrite(hw.gpio, loopback_gpio, 1);
+        } else {
+            uint64_t ts = current_timestamp_ns();
+            if (write(inject_pipe[1], &ts, sizeof(ts)) == (ssize_t)sizeof(ts)) {
+                atomic_fetch_add(&injected, 1);
+            } else {
+                atomic_fetch_add(&inject_overflow, 1);
+            }
+        }
+    }
+    return NULL;
+}
+
+// --- REPORT ---
+
+// String value with quotes, backslashes and control characters escaped
+void json_string(const char *s) {
+    fputc('"', json);
+    for (; *s; s++) {
+        if (*s == '"' || *s == '\\') fprintf(json, "\\%c", *s);
+        else if ((unsigned char)*s < 0x20) fprintf(json, "\\u%04x", *s);
+        else fputc(*s, json);
+    }
+    fputc('"', json);
+}
+
+void take_snapshot(soak_snapshot_t *s) {
+    s->t_ns = current_timestamp_ns();
+    s->led_frames = atomic_load(&led_frames);
+    s->spi_errors = spi_write_errors() + atomic_load(&show_errors);
+    s->injected = atomic_load(&injected);
+    s->handled = atomic_load(&handled);
+    s->i2c_errors = atomic_load(&i2c_errors);
+    s->cpu_ns[CPU_LED] = thread_cpu_ns(led_thread);
+    s->cpu_ns[CPU_SPI_TX] = 0;
+    for (int i = 0; i < sm.num_segments; i++) s->cpu_ns[CPU_SPI_TX] += thread_cpu_ns(sm.segments[i].tx.thread);
+    s->cpu_ns[CPU_INPUT] = thread_cpu_ns(input_thread);
+    s->cpu_ns[CPU_INJECTOR] = thread_cpu_ns(injector_thread);
+    s->cpu_ns[CPU_TONE] = have_tone ? thread_cpu_ns(seq.thread) : 0;
+}
+
+// CPU use of each group between two snapshots, in % of one core
+void json_cpu(const soak_snapshot_t *a, const soak_snapshot_t *b) {
+    double wall = (double)(b->t_ns - a->t_ns);
+    fprintf(json, "\"cpu_percent\":{");
+    for (int k = 0; k < 5; k++) {
+        fprintf(json, "%s\"%s\":%.2f", k ? "," : "", cpu_names[k],
+                wall > 0 ? 100.0 * (double)(b->cpu_ns[k] - a->cpu_ns[k]) / wall : 0.0);
+    }
+    fprintf(json, "}");
+}
+
+double json_interval(const soak_snapshot_t *a, const soak_snapshot_t *b, const soak_snapshot_t *start) {
+    double s = (b->t_ns - a->t_ns) / 1e9;
+    double fps = s > 0 ? (b->led_frames - a->led_frames) / s : 0;
+    fprintf(json, "{\"type\":\"interval\",\"t_s\":%.1f,\"fps\":%.1f,\"presses\":%llu,\"handled\":%llu,"
+                  "\"spi_errors\":%llu,\"i2c_errors\":%llu,",
+            (b->t_ns - start->t_ns) / 1e9, fps,
+            (unsigned long long)(b->injected - a->injected), (unsigned long long)(b->handled - a->handled),
+            (unsigned long long)(b->spi_errors - a->spi_errors), (unsigned long long)(b->i2c_errors - a->i2c_errors));
+    json_cpu(a, b);
+    fprintf(json, "}\n");
+    fflush(json);
+    return fps;
+}
+
+void json_latency() {
+    fprintf(json, "\"latency_us\":{");
+    for (int k = 0; k < TRACE_NUM_STAGES; k++) {
+        const latency_hist_t *h = &trace.stages[k];
+        fprintf(json, "%s\"%s\":{\"count\":%llu,\"p50\":%.1f,\"p90\":%.1f,\"p99\":%.1f,\"p999\":%.1f,"
+                      "\"max\":%.1f,\"over_budget\":%llu}",
+                k ? "," : "", latency_trace_stage_name(k), (unsigned long long)atomic_load(&h->total),
+                latency_hist_quantile(h, 0.5) / 1e3, latency_hist_quantile(h, 0.9) / 1e3,
+                latency_hist_quantile(h, 0.99) / 1e3, latency_hist_quantile(h, 0.999) / 1e3,
+                atomic_load(&h->max_ns) / 1e3, (unsigned long long)atomic_load(&h->over_budget));
+    }
+    fprintf(json, "},");
+}
+
+void json_summary(const soak_snapshot_t *start, const soak_snapshot_t *end, double min_fps,
+                  const char *label, const uint8_t *expanders, int num_expanders, time_t started) {
+    struct utsname un;
+    if (uname(&un) < 0) memset(&un, 0, sizeof(un));
+    double s = (end->t_ns - start->t_ns) / 1e9;
+    uint64_t inj = atomic_load(&injected), hnd = atomic_load(&handled);
+
+    fprintf(json, "{\"type\":\"summary\",\"label\":");
+    json_string(label);
+    fprintf(json, ",\"host\":");
+    json_string(un.nodename);
+    fprintf(json, ",\"kernel\":");
+    json_string(un.release);
+    fprintf(json, ",\"start_unix\":%lld,\"duration_s\":%.1f,", (long long)started, s);
+
+    fprintf(json, "\"config\":{\"profile\":\"%s\",\"leds_total\":%zu,\"press_hz\":%d,\"loopback_gpio\":%d,"
+                  "\"spi_mock\":%s,\"tone\":%s,\"expanders\":[",
+            sm.enc.profile->name, sm.total, press_hz, loopback_gpio, spi_mock ? "true" : "false",
+            have_tone ? "true" : "false");
+    for (int i = 0; i < num_expanders; i++) fprintf(json, "%s\"0x%02x\"", i ? "," : "", expanders[i]);
+    fprintf(json, "],\"expanders_found\":%s},", have_panel ? "true" : "false");
+
+    fprintf(json, "\"led\":{\"frames\":%llu,\"fps\":%.1f,\"fps_min_interval\":%.1f,\"show_errors\":%llu,"
+                  "\"spi_write_errors\":%llu,\"strips\":[",
+            (unsigned long long)(end->led_frames - start->led_frames),
+            s > 0 ? (end->led_frames - start->led_frames) / s : 0.0, min_fps,
+            (unsigned long long)atomic_load(&show_errors), (unsigned long long)spi_write_errors());
+    for (int i = 0; i < sm.num_segments; i++) {
+        const spi_tx_t *tx = &sm.segments[i].tx;
+        fprintf(json, "%s{\"device\":", i ? "," : "");
+        json_string(sm.segments[i].device);
+        fprintf(json, ",\"leds\":%zu,\"frames_sent\":%llu,\"write_errors\":%llu,\"wire_ms\":%.2f}",
+                sm.segments[i].count,
+                (unsigned long long)tx->frames_sent, (unsigned long long)tx->write_errors, tx->last_wire_ns / 1e6);
+    }
+    fprintf(json, "]},");
+
+    fprintf(json, "\"input\":{\"injected\":%llu,\"inject_overflow\":%llu,\"received\":%llu,\"handled\":%llu,"
+                  "\"dropped\":%llu,\"edges_lost\":%llu,\"i2c_reads\":%llu,\"i2c_errors\":%llu},",
+            (unsigned long long)inj, (unsigned long long)atomic_load(&inject_overflow),
+            (unsigned long long)atomic_load(&edges_received), (unsigned long long)hnd,
+            (unsigned long long)(inj > hnd ? inj - hnd : 0) + atomic_load(&inject_overflow),
+            (unsigned long long)atomic_load(&edges_lost), (unsigned long long)atomic_load(&i2c_reads),
+            (unsigned long long)atomic_load(&i2c_errors));
+
+    fprintf(json, "\"tone\":{\"plays\":%llu,\"queue_full\":%llu,\"steps\":%llu,\"max_late_us\":%.1f},",
+            (unsigned long long)atomic_load(&tone_plays), (unsigned long long)atomic_load(&tone_queue_full),
+            (unsigned long long)(have_tone ? seq.steps_played : 0), have_tone ? seq.max_late_ns / 1e3 : 0.0);
+
+    json_latency();
+    json_cpu(start, end);
+    fprintf(json, "}\n");
+    fflush(json);
+}
+
+// --- MAIN ---
+
+int main(int argc, char **argv) {
+    strip_segment_cfg_t strips[MAX_STRIPS];
+    uint8_t expanders[MAX_EXPANDERS];
+    int num_strips = 0, num_expanders = 0, mock = 0, no_tone = 0;
+    int duration_s = DEFAULT_DURATION_S, interval_s = DEFAULT_INTERVAL_S;
+    const char *json_path = NULL, *label = "", *profile_name = NULL;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--strip") == 0 && i + 1 < argc) {
+            char *spec = argv[++i], *colon = strrchr(spec, ':');
+            if (!colon || num_strips == MAX_STRIPS || atoi(colon + 1) <= 0) {
+                fprintf(stderr, "Bad --strip '%s' (DEV:COUNT, at most %d)\n", spec, MAX_STRIPS);
+                return 1;
+            }
+            *colon = '\0';
+            strips[num_strips++] = (strip_segment_cfg_t){ spec, (size_t)atoi(colon + 1) };
+        } else if (strcmp(argv[i], "--expander") == 0 && i + 1 < argc && num_expanders < MAX_EXPANDERS) {
+            expanders[num_expanders++] = (uint8_t)strtol(argv[++i], NULL, 0);
+        } else if (strcmp(argv[i], "--duration") == 0 && i + 1 < argc) {
+            duration_s = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--interval") == 0 && i + 1 < argc) {
+            interval_s = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--press-hz") == 0 && i + 1 < argc) {
+            press_hz = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--loopback") == 0 && i + 1 < argc) {
+            loopback_gpio = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--json") == 0 && i + 1 < argc) {
+            json_path = argv[++i];
+        } else if (strcmp(argv[i], "--label") == 0 && i + 1 < argc) {
+            label = argv[++i];
+        } else if (strcmp(argv[i], "--mock") == 0) {
+            mock = 1;
+        } else if (strcmp(argv[i], "--no-tone") == 0) {
+            no_tone = 1;
+        } else if (argv[i][0] == '-') {
+            fprintf(stderr, "Unknown option '%s' (see the top of panel_soak.c)\n", argv[i]);
+            return 1;
+        } else {
+            profile_name = argv[i];
+        }
+    }
+    if (num_strips == 0) strips[num_strips++] = (strip_segment_cfg_t){ mock ? STRIP_MOCK_DEVICE : PANEL_SPI_DEVICE, 186 };
+    if (num_expanders == 0) expanders[num_expanders++] = BUTTON_PANEL_ADDR;
+    if (interval_s <= 0) interval_s = DEFAULT_INTERVAL_S;
+    if (press_hz <= 0 || press_hz > 1000) {
+        fprintf(stderr, "--press-hz must be 1-1000\n");
+        return 1;
+    }
+    const ws2812_profile_t *profile = ws2812_profile_find(profile_name);
+    if (!profile) {
+        fprintf(stderr, "Unknown encoding profile '%s'\n", profile_name);
+        ws2812_print_profiles();
+        return 1;
+    }
+    json = json_path ? fopen(json_path, "w") : stdout;
+    if (!json) {
+        perror(json_path);
+        return 1;
+    }
+
+    // Roles from PANEL_RT, memory locked up front, Ctrl+C through a signalfd: all before any thread
+    rt_cfg_t rt;
+    if (rt_config_load(&rt) < 0) return 1;
+    size_t leds = 0;
+    for (int i = 0; i < num_strips; i++) leds += strips[i].count;
+    size_t bytes_per_led = (size_t)profile->spi_bits * profile->colors;
+    if (arena_setup(leds * (2 * bytes_per_led + profile->colors) + ARENA_SLACK) < 0) return 1;
+    int shutdown_fd = shutdown_fd_open();
+    if (shutdown_fd < 0) return 1;
+    latency_trace_init(&trace, RESPONSE_BUDGET_MS * 1000000ULL);
+
+    // LEDs are required; buttons and buzzer are used when they answer
+    int opened = panel_hw_open(&hw, PANEL_HW_GPIO | PANEL_HW_I2C, profile->spi_hz);
+    if (strip_manager_open(&sm, strips, num_strips, profile) < 0) {
+        fprintf(stderr, "Failed to open the LED strips (--mock runs without them)\n");
+        return 1;
+    }
+    spi_mock = strcmp(sm.segments[0].device, STRIP_MOCK_DEVICE) == 0;
+    if ((opened & PANEL_HW_I2C) && button_panel_open(&panel, hw.i2c_fd, expanders, num_expanders) == 0) {
+        have_panel = 1;
+    }
+    if (!no_tone && (opened & PANEL_HW_GPIO) && tone_init(&tone, hw.gpio) == 0 &&
+        tone_seq_start(&seq, &tone.out) == 0) {
+        have_tone = 1;
+        tone_seq_play(&seq, MELODY, sizeof(MELODY) / sizeof(MELODY[0]), TONE_SEQ_LOOP);
+    }
+
+    // Press path: loopback edge through the GPIO character device, or a pipe
+    if (loopback_gpio >= 0) {
+        unsigned int pin = BUTTON_PANEL_INT_PIN;
+        if (!(opened & PANEL_HW_GPIO) || lgGpioClaimOutput(hw.gpio, 0, loopback_gpio, 1) < 0 ||
+            (line_fd = gpio_cdev_request_edges(hw.gpio_fd, &pin, 1,
+                                               GPIO_V2_LINE_FLAG_EDGE_FALLING | GPIO_V2_LINE_FLAG_BIAS_PULL_UP,
+                                               "panel_soak")) < 0) {
+            fprintf(stderr, "Can't set up the loopback GPIO %d -> GPIO %d\n", loopback_gpio, pin);
+            return 1;
+        }
+    } else if (pipe2(inject_pipe, O_NONBLOCK | O_CLOEXEC) < 0) {
+        perror("pipe");
+        return 1;
+    }
+    stop_fd = eventfd(0, EFD_CLOEXEC);
+
+    pthread_create(&led_thread, NULL, led_main, NULL);
+    pthread_create(&input_thread, NULL, input_main, NULL);
+    pthread_create(&injector_thread, NULL, injector_main, NULL);
+    rt_apply(&rt, RT_ROLE_LED, led_thread, "LED render thread");
+    for (int i = 0; i < sm.num_segments; i++) rt_apply(&rt, RT_ROLE_LED, sm.segments[i].tx.thread, sm.segments[i].device);
+    rt_apply(&rt, RT_ROLE_INPUT, input_thread, "input thread");
+    if (have_tone) rt_apply(&rt, RT_ROLE_TONE, seq.thread, "tone sequencer");
+
+    fprintf(stderr, "Soak: %zu LEDs on %d strips (%s), %s, buzzer %s, %d presses/s via %s, %s\n",
+            sm.total, sm.num_segments, profile->name,
+            have_panel ? "expanders found" : "no expanders", have_tone ? "on" : "off", press_hz,
+            loopback_gpio >= 0 ? "loopback GPIO" : "pipe",
+            duration_s ? "running" : "until Ctrl+C");
+
+    time_t started = time(NULL);
+    soak_snapshot_t start, prev, now;
+    take_snapshot(&start);
+    prev = start;
+    double min_fps = -1;
+    uint64_t end_ns = duration_s > 0 ? start.t_ns + (uint64_t)duration_s * 1000000000ULL : 0;
+
+    while (1) {
+        uint64_t next = prev.t_ns + (uint64_t)interval_s * 1000000000ULL;
+        if (end_ns && next > end_ns) next = end_ns;
+        uint64_t t = current_timestamp_ns();
+        int wait_ms = next > t ? (int)((next - t + 999999) / 1000000) : 0;
+        int stop = shutdown_wait(shutdown_fd, -1, wait_ms) < 0;
+
+        take_snapshot(&now);
+        if (now.t_ns > prev.t_ns) {
+            double fps = json_interval(&prev, &now, &start);
+            if (min_fps < 0 || fps < min_fps) min_fps = fps;
+            fprintf(stderr, "\r%6.0f s  %6.1f fps  %llu presses  %llu dropped   ", (now.t_ns - start.t_ns) / 1e9, fps,
+                    (unsigned long long)now.injected, (unsigned long long)(now.injected - now.handled));
+        }
+        prev = now;
+        if (stop || (end_ns && now.t_ns >= end_ns)) break;
+    }
+
+    // --- Cleanup ---
+    atomic_store(&running, 0);
+    pthread_join(injector_thread, NULL);
+    usleep(50000); // Let the last presses through
+    uint64_t one = 1;
+    if (write(stop_fd, &one, sizeof(one)) < 0) perror("eventfd");
+    pthread_join(input_thread, NULL);
+    pthread_join(led_thread, NULL);
+    strip_manager_flush(&sm);
+
+    // Rates and CPU over the measured period ('prev', taken while every thread was
+    // still running); the event totals include the presses drained after it
+    fprintf(stderr, "\n");
+    json_summary(&start, &prev, min_fps < 0 ? 0 : min_fps, label, expanders, num_expanders, started);
+
+    if (have_tone) {
+        tone_seq_stop(&seq);
+        tone_close(&tone);
+    }
+    if (loopback_gpio >= 0) lgGpioFree(hw.gpio, loopback_gpio);
+    if (line_fd >= 0) close(line_fd);
+    strip_manager_close(&sm);
+    panel_hw_close(&hw);
+    arena_print_stats(stderr);
+    arena_teardown();
+    if (json != stdout) fclose(json);
+    return 0;
+}